@@ -33,6 +33,23 @@ Do not build.
 Force all build steps to be performed, even when determined not to be
 required.
 
+=item C<--enable-cache> (default on)
+
+Keep compiled client programs in a cache shared between working directories,
+keyed by a hash of the generated code and build options. When a client
+program with the same key has been built before, by any model in any
+directory, it is taken from the cache rather than built again.
+
+=item C<--cache-dir> (default C<$LIBBI_CACHE_DIR>, or C<~/.libbi/cache> if
+unset)
+
+Location of the cache.
+
+=item C<--cache-size> (default 64)
+
+Maximum number of client programs to keep in the cache. When exceeded, the
+least recently used are evicted.
+
 =item C<--enable-warnings> (default off)
 
 Enable compiler warnings.
@@ -59,6 +76,13 @@ Enable another type of diagnostic.
 
 Use single-precision floating point.
 
+=item C<--enable-mixed> (default off)
+
+Use single-precision floating point for the state and its dynamics, but
+double-precision floating point for particle weights, their normalising
+constants and log-likelihoods, where precision is most easily lost. Implies
+C<--enable-single>.
+
 =item C<--enable-openmp> (default on)
 
 Use OpenMP multithreading.
@@ -72,6 +96,12 @@ Enable CUDA code for graphics processing units (GPU).
 Enable fast-but-inaccurate instead of slow-but-accurate versions of functions
 sin and exp in CUDA.
 
+=item C<--enable-sse-fast-math> (default off)
+
+With C<--enable-sse> or C<--enable-avx>, use single-precision polynomials for
+the vectorised versions of functions log and exp in double precision, which
+are faster but accurate to only about seven significant figures.
+
 =item C<--enable-gpu-cache> (default off)
 
 For particle filters, enable ancestry caching in GPU memory. GPU memory is
@@ -123,6 +153,10 @@ use Getopt::Long qw(:config pass_through no_auto_abbrev no_ignore_case);
 use File::Spec;
 use File::Slurp;
 use File::Path;
+use File::Copy;
+use File::Find;
+use Digest::SHA;
+use POSIX qw(uname);
 
 =item B<new>(I<name>, I<verbose>)
 
@@ -153,6 +187,7 @@ sub new {
         _openmp => 1,
         _cuda => 0,
         _cuda_fast_math => 0,
+        _sse_fast_math => 0,
         _gpu_cache => 0,
         _cuda_arch => 'sm_30',
         _sse => 0,
@@ -160,10 +195,14 @@ sub new {
         _mpi => 0,
         _vampir => 0,
         _single => 0,
+        _mixed => 0,
         _extra_debug => 0,
         _diagnostics => 0,
         _diagnostics2 => 0,
         _gperftools => 0,
+        _cache => 1,
+        _cache_dir => _default_cache_dir(),
+        _cache_size => 64,
         _tstamps => {},
     };
     bless $self, $class;
@@ -188,12 +227,16 @@ sub new {
         'disable-sse' => sub { $self->{_sse} = 0 },
         'enable-avx' => sub { $self->{_avx} = 1 },
         'disable-avx' => sub { $self->{_avx} = 0 },
+        'enable-sse-fast-math' => sub { $self->{_sse_fast_math} = 1 },
+        'disable-sse-fast-math' => sub { $self->{_sse_fast_math} = 0 },
         'enable-mpi' => sub { $self->{_mpi} = 1 },
         'disable-mpi' => sub { $self->{_mpi} = 0 },
         'enable-vampir' => sub { $self->{_vampir} = 1 },
         'disable-vampir' => sub { $self->{_vampir} = 0 },
         'enable-single' => sub { $self->{_single} = 1 },
         'disable-single' => sub { $self->{_single} = 0 },
+        'enable-mixed' => sub { $self->{_mixed} = 1 },
+        'disable-mixed' => sub { $self->{_mixed} = 0 },
         'enable-extra-debug' => sub { $self->{_extra_debug} = 1 },
         'disable-extra-debug' => sub { $self->{_extra_debug} = 0 },
         'enable-diagnostics=i' => \$self->{_diagnostics},
@@ -201,6 +244,10 @@ sub new {
         'disable-diagnostics2' => sub { $self->{_diagnostics2} = 0 },
         'enable-gperftools' => sub { $self->{_gperftools} = 1 },
         'disable-gperftools' => sub { $self->{_gperftools} = 0 },
+        'enable-cache' => sub { $self->{_cache} = 1 },
+        'disable-cache' => sub { $self->{_cache} = 0 },
+        'cache-dir=s' => \$self->{_cache_dir},
+        'cache-size=i' => \$self->{_cache_size},
     );
     GetOptions(@args) || die("could not read command line arguments\n");
     
@@ -233,9 +280,11 @@ sub new {
     push(@builddir, 'gpucache') if $self->{_gpu_cache};
     push(@builddir, 'sse') if $self->{_sse};
     push(@builddir, 'avx') if $self->{_avx};
+    push(@builddir, 'ssefastmath') if $self->{_sse_fast_math};
     push(@builddir, 'mpi') if $self->{_mpi};
     push(@builddir, 'vampir') if $self->{_vampir};
     push(@builddir, 'single') if $self->{_single};
+    push(@builddir, 'mixed') if $self->{_mixed};
     push(@builddir, 'extradebug') if $self->{_extra_debug};
     push(@builddir, 'diagnostics' . $self->{_diagnostics}) if $self->{_diagnostics};
     push(@builddir, 'gperftools') if $self->{_gperftools};
@@ -274,9 +323,21 @@ sub build {
     my $self = shift;
     my $client = shift;
     
+    my $hash;
+    if ($self->{_cache}) {
+        $hash = $self->_hash($client);
+        if (!$self->{_force} && $self->_fetch($client, $hash)) {
+            return;
+        }
+    }
+    
     $self->_autogen;
     $self->_configure;
     $self->_make($client);
+    
+    if ($self->{_cache}) {
+        $self->_store($client, $hash);
+    }
 }
 
 =item B<get_dir>
@@ -356,9 +417,11 @@ sub _configure {
     $options .= $self->{_gpu_cache} ? ' --enable-gpucache' : ' --disable-gpucache';
     $options .= $self->{_sse} ? ' --enable-sse' : ' --disable-sse';
     $options .= $self->{_avx} ? ' --enable-avx' : ' --disable-avx';
+    $options .= $self->{_sse_fast_math} ? ' --enable-ssefastmath' : ' --disable-ssefastmath';
     $options .= $self->{_mpi} ? ' --enable-mpi' : ' --disable-mpi';
     $options .= $self->{_vampir} ? ' --enable-vampir' : ' --disable-vampir';
     $options .= $self->{_single} ? ' --enable-single' : ' --disable-single';
+    $options .= $self->{_mixed} ? ' --enable-mixed' : ' --disable-mixed';
     $options .= $self->{_extra_debug} ? ' --enable-extradebug' : ' --disable-extradebug';
     $options .= $self->{_diagnostics} ? ' --enable-diagnostics=' . $self->{_diagnostics} : ' --disable-diagnostics';
     $options .= $self->{_gperftools} ? ' --enable-gperftools' : ' --disable-gperftools';
@@ -417,9 +480,7 @@ sub _make {
     my $self = shift;
     my $client = shift;
     
-    my $exeext = ($^O eq 'cygwin' || $^O eq 'MSWin32') ? '.exe' : '';
-    my $target = $client . "_" . ($self->{_cuda} ? 'gpu' : 'cpu') . $exeext;
-    my $link = $client . $exeext;
+    my ($target, $link) = $self->_target($client);
     my $options = '';
     if ($self->{_force}) {
         $options .= ' --always-make';
@@ -449,6 +510,178 @@ sub _make {
     chdir($cwd);
 }
 
+=item B<_target>(I<client>)
+
+Get the file names of the target and link for the given client program.
+
+=cut
+sub _target {
+    my $self = shift;
+    my $client = shift;
+
+    my $exeext = ($^O eq 'cygwin' || $^O eq 'MSWin32') ? '.exe' : '';
+    my $target = $client . "_" . ($self->{_cuda} ? 'gpu' : 'cpu') . $exeext;
+    my $link = $client . $exeext;
+    
+    return ($target, $link);
+}
+
+=item B<_hash>(I<client>)
+
+Compute the key of the given client program in the cache. This is a hash
+of the contents of all generated source and build files, the build options,
+the machine architecture, and the toolchain: the C<CXX>, C<CXXFLAGS>,
+C<CPPFLAGS>, C<LDFLAGS> and C<LIBS> environment variables, which configure
+picks up, along with the version of the compiler that it will use.
+
+=cut
+sub _hash {
+    my $self = shift;
+    my $client = shift;
+    
+    my $builddir = $self->get_dir;
+    my ($target, $link) = $self->_target($client);
+    my $sha = new Digest::SHA(1);
+    my @files;
+    
+    # build options, of which the name of the build directory is a summary
+    $sha->add(join("\0", File::Spec->splitdir($builddir), $self->{_warnings},
+        $target, (uname())[4]));
+    
+    # toolchain, a change of which must not reuse a stale binary
+    foreach my $var ('CXX', 'CXXFLAGS', 'CPPFLAGS', 'LDFLAGS', 'LIBS') {
+        $sha->add($var, "\0", defined($ENV{$var}) ? $ENV{$var} : '', "\0");
+    }
+    foreach my $compiler ($self->_compiler, $self->{_cuda} ? 'nvcc' : ()) {
+        my $version = `$compiler --version 2>/dev/null`;
+        $sha->add($compiler, "\0", defined($version) ? $version : '', "\0");
+    }
+    
+    # generated files
+    foreach my $file ('autogen.sh', 'configure.ac', 'Makefile.am', 'bi.lpp',
+        'bi.ypp') {
+        push(@files, $file) if -e File::Spec->catfile($builddir, $file);
+    }
+    find({
+        no_chdir => 1,
+        wanted => sub {
+            if (-f $_ && /\.(?:cpp|hpp|cu|cuh|h)$/) {
+                push(@files, File::Spec->abs2rel($_, $builddir));
+            }
+        }
+    }, File::Spec->catdir($builddir, 'src'));
+    
+    foreach my $file (sort @files) {
+        $sha->add($file, "\0");
+        $sha->addfile(File::Spec->catfile($builddir, $file));
+    }
+    
+    return $sha->hexdigest;
+}
+
+=item B<_fetch>(I<client>, I<hash>)
+
+Retrieve the given client program from the cache, if it is there.
+
+Returns true if the client program was retrieved, false otherwise.
+
+=cut
+sub _fetch {
+    my $self = shift;
+    my $client = shift;
+    my $hash = shift;
+
+    my $builddir = $self->get_dir;
+    my ($target, $link) = $self->_target($client);
+    my $entry = File::Spec->catdir($self->{_cache_dir}, $hash);
+    my $from = File::Spec->catfile($entry, $target);
+    my $to = File::Spec->catfile($builddir, $target);
+    
+    if (-x $from) {
+        if ($self->{_verbose}) {
+            print "using cached $from\n";
+        }
+        if (!copy($from, "$to.$$") || !chmod(0755, "$to.$$") ||
+            !rename("$to.$$", $to)) {
+            unlink("$to.$$");
+            warn("could not retrieve $from from cache, building instead\n");
+            return 0;
+        }
+        utime(undef, undef, $entry);  # most recently used
+        
+        my $cwd = getcwd();
+        chdir($builddir);
+        symlink($target, $link);
+        chdir($cwd);
+        return 1;
+    } else {
+        return 0;
+    }
+}
+
+=item B<_store>(I<client>, I<hash>)
+
+Store the given client program in the cache, evicting the least recently
+used client programs if the cache is full.
+
+No return value.
+
+=cut
+sub _store {
+    my $self = shift;
+    my $client = shift;
+    my $hash = shift;
+    
+    my $builddir = $self->get_dir;
+    my ($target, $link) = $self->_target($client);
+    my $entry = File::Spec->catdir($self->{_cache_dir}, $hash);
+    my $from = File::Spec->catfile($builddir, $target);
+    my $to = File::Spec->catfile($entry, $target);
+    
+    # copy to temporary file then rename, so that concurrent builds never
+    # see a partial file
+    eval { mkpath($entry) };
+    if ($@ || !copy($from, "$to.$$") || !chmod(0755, "$to.$$") ||
+        !rename("$to.$$", $to)) {
+        unlink("$to.$$");
+        warn("could not store $target in cache " . $self->{_cache_dir} . "\n");
+        return;
+    }
+    utime(undef, undef, $entry);
+    
+    $self->_evict;
+}
+
+=item B<_evict>
+
+Evict least recently used client programs from the cache until it is no
+larger than the maximum size.
+
+No return value.
+
+=cut
+sub _evict {
+    my $self = shift;
+    
+    my $dir = $self->{_cache_dir};
+    my $dh;
+    if ($self->{_cache_size} > 0 && opendir($dh, $dir)) {
+        my @entries = grep { /^[0-9a-f]{40}$/ &&
+            -d File::Spec->catdir($dir, $_) } readdir($dh);
+        closedir($dh);
+        
+        if (@entries > $self->{_cache_size}) {
+            my %mtimes = map { $_ => (stat(File::Spec->catdir($dir, $_)))[9] }
+                @entries;
+            my @lru = sort { $mtimes{$a} <=> $mtimes{$b} } @entries;
+            splice(@lru, @lru - $self->{_cache_size});
+            foreach my $entry (@lru) {
+                rmtree(File::Spec->catdir($dir, $entry));
+            }
+        }
+    }
+}
+
 =item B<_stamp>(I<filename>)
 
 Update timestamp on file.
@@ -514,6 +747,47 @@ sub _last_modified {
     }
 }
 
+=item B<_compiler>
+
+Get the C++ compiler that configure will use: C<CXX> if set, otherwise the
+first of those that configure tries that is on the path.
+
+=cut
+sub _compiler {
+    my $self = shift;
+    
+    if (defined $ENV{CXX} && $ENV{CXX} ne '') {
+        return $ENV{CXX};
+    }
+    my @compilers = $self->{_cuda} ? ('icpc', 'clang++', 'g++') :
+        ('icpc', 'g++', 'clang++');
+    foreach my $compiler (@compilers) {
+        foreach my $dir (File::Spec->path) {
+            if (-x File::Spec->catfile($dir, $compiler)) {
+                return $compiler;
+            }
+        }
+    }
+    return 'g++';
+}
+
+=item B<_default_cache_dir>
+
+Get the default location of the cache, from the C<LIBBI_CACHE_DIR>
+environment variable if set, otherwise C<.libbi/cache> in the home
+directory.
+
+=cut
+sub _default_cache_dir {
+    if (defined $ENV{LIBBI_CACHE_DIR} && $ENV{LIBBI_CACHE_DIR} ne '') {
+        return $ENV{LIBBI_CACHE_DIR};
+    } else {
+        my $home = $ENV{HOME};
+        $home = getcwd() if !defined $home;
+        return File::Spec->catdir($home, '.libbi', 'cache');
+    }
+}
+
 =item B<_configure_whats_missing>(I<configure_log>)
 
 Try to work out what might be missing when configure fails. Return an
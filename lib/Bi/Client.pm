@@ -618,9 +618,10 @@ sub set_named_exec_arg {
     $self->get_exec_args->{$name} = $value;
 }
 
-=item B<process_args>
+=item B<process_args>(I<model>)
 
-Process command line arguments.
+Process command line arguments. If given, I<model> is used to check
+arguments that name its variables.
 
 =cut
 sub process_args {
@@ -0,0 +1,125 @@
+=head1 NAME
+
+embed - build a model and filter as a shared library, for embedding in
+other programs.
+
+=head1 SYNOPSIS
+
+    libbi embed ...
+
+=head1 INHERITS
+
+L<Bi::Client::filter>
+
+=cut
+
+package Bi::Client::embed;
+
+use parent 'Bi::Client::filter';
+use warnings;
+use strict;
+
+=head1 DESCRIPTION
+
+The C<embed> command builds the model and filter as a shared library with a
+C interface, rather than running it. A host program, such as an external
+inference framework, loads the library and evaluates the likelihood at
+parameter values of its choosing, as many times as it likes, without the
+cost of starting a new process and reading input and observation files for
+each evaluation. The interface is declared in C<src/bi/embed/embed.h> of the
+build directory:
+
+=over 4
+
+=item C<bi_context_create(argc, argv)>
+
+Create a context, taking arguments as for the L<filter> command. All input,
+observation and schedule set up, and all allocations of the filter, are done
+here once.
+
+=item C<bi_context_set_parameters(ctx, theta)>
+
+Set the parameters at which to filter.
+
+=item C<bi_context_filter(ctx)>
+
+Run the filter.
+
+=item C<bi_context_log_likelihood(ctx)>, C<bi_context_log_prior(ctx)>,
+C<bi_context_clock(ctx)>
+
+Summaries of the most recent run of the filter.
+
+=item C<bi_context_destroy(ctx)>
+
+Destroy the context.
+
+=back
+
+The options given to C<embed> select the types of filter, resampler and so
+forth compiled into the library, as well as which files are read. The values
+of the options may be changed with the arguments to
+C<bi_context_create()>. On completion, the command prints the path of the
+library, followed by the arguments, one per line, to pass to
+C<bi_context_create()> to reproduce the options given.
+
+=head1 OPTIONS
+
+The C<embed> command inherits all options from L<filter>.
+
+=head1 METHODS
+
+=over 4
+
+=cut
+
+sub init {
+    my $self = shift;
+
+    Bi::Client::filter::init($self);
+}
+
+sub process_args {
+    my $self = shift;
+
+    $self->Bi::Client::filter::process_args(@_);
+    $self->{_binary} = 'embed';
+}
+
+=item B<exec>
+
+Print the path of the library and the arguments with which to create a
+context.
+
+=cut
+sub exec {
+    my $self = shift;
+
+    my $builddir = $self->{_builddir};
+    my $library = File::Spec->catfile($builddir, $self->get_binary);
+
+    print "$library\n";
+    my $key;
+    foreach $key (sort keys %{$self->{_args}}) {
+        if (defined $self->{_args}->{$key}) {
+            if (length($key) == 1) {
+                print "-$key\n";
+                print $self->{_args}->{$key} . "\n";
+            } else {
+                print "--$key=" . $self->{_args}->{$key} . "\n";
+            }
+        }
+    }
+}
+
+1;
+
+=back
+
+=head1 AUTHOR
+
+Lawrence Murray <lawrence.murray@csiro.au>
+
+=head1 VERSION
+
+$Rev$ $Date$
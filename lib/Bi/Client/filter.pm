@@ -88,6 +88,21 @@ in these cases.
 Setting C<--filter kalman> automatically enables the 
 C<--with-transform-extended> option.
 
+=item C<raoblackwell>
+
+Rao-Blackwellised (marginalised) particle filter, as described in Chen & Liu
+(2000) and SchE<ouml>n, Gustafsson & Nordlund (2005). The state variables given
+by C<--marginal-vars> are marginalised, each particle carrying a Gaussian
+distribution over them, updated as in the extended Kalman filter. The
+remaining state variables are sampled as in the bootstrap particle filter.
+This is exact, and reduces the variance of the likelihood estimate, when
+the model is linear-Gaussian in the marginalised variables conditioned on
+the sampled variables, and otherwise approximate. Not available with
+C<--enable-cuda>, and available only to the C<filter> command.
+
+Setting C<--filter raoblackwell> automatically enables the
+C<--with-transform-extended> option.
+
 =back
 
 =back
@@ -137,6 +152,23 @@ for a rejection resampler (Murray, Lee & Jacob 2013), or
 
 =back
 
+=item C<--with-sort> (default 0)
+
+Sort particles along a Hilbert curve before resampling. Particles that are
+close in state space are then close in memory after resampling, improving
+cache behaviour when copying and propagating them. With the C<systematic>
+and C<stratified> resamplers, this also reduces resampling variance
+(Gerber, Chopin & Whiteley 2019). The cost is a sort of the particles at
+each resampling step, which is worthwhile only for large numbers of
+particles.
+
+=item C<--sort-vars> (default all state variables)
+
+Comma-separated list of the names of the state and noise variables that
+span the space of the curve for C<--with-sort>. A few variables that
+dominate the variation between particles are better than many, as fewer
+dimensions give a finer grid. Any other name is an error.
+
 =back
 
 =head2 Metropolis resampler-specific options
@@ -148,7 +180,14 @@ C<metropolis>.
 
 =item C<-C> (default 0)
 
-Number of steps to take.
+Number of steps to take. If zero, the number is chosen each time that
+resampling is performed, from the spread of the log-weights, to keep the
+bias of the resampler within C<--metropolis-bias>.
+
+=item C<--metropolis-bias> (default 0.01)
+
+Tolerance on the bias of the resampler when C<-C> is zero. Smaller values
+take more steps.
 
 =back
 
@@ -168,6 +207,20 @@ bridge weighting will occur at time C<T*k/K>.
 
 =back
 
+=head2 Rao-Blackwellised particle filter-specific options
+
+The following additional options are available when C<--filter> is set to
+C<raoblackwell>:
+
+=over 4
+
+=item C<--marginal-vars> (required)
+
+Comma-separated list of the names of the state variables to marginalise.
+Noise variables are always marginalised.
+
+=back
+
 =head2 Adaptive particle filter-specific options
 
 The following additional options are available when C<--filter> is set to
@@ -218,6 +271,35 @@ Number of particles per block.
 
 =back
 
+=head2 Checkpoint options
+
+The following additional options are available when C<--filter> is set to
+C<'bootstrap'>, to continue filtering as new observations arrive, without
+filtering again from the start:
+
+=over 4
+
+=item C<--checkpoint-file> (default none)
+
+File to which to write the final state of the filter: particles,
+log-weights, marginal log-likelihood, position in the time schedule and the
+state of the random number generators. The output file is then created with
+an unlimited time dimension, so that a resumed run may append to it.
+
+=item C<--resume> (default 0)
+
+Resume filtering from the state in C<--checkpoint-file>, rather than
+initialising. Use the same options as the run that wrote the checkpoint,
+but for a later C<--end-time>, and an C<--obs-file> extended with new
+observations. Output is appended to the existing C<--output-file>, and the
+checkpoint is overwritten with the new final state. The times of
+observations and outputs before the checkpoint must be unchanged; as dense
+output times depend on C<--end-time>, use C<--noutputs 0>. Random number
+generators on GPU are not saved, so that results of a resumed run with
+C<--enable-cuda> differ from those of a single run.
+
+=back
+
 =cut
 our @CLIENT_OPTIONS = (
     {
@@ -265,6 +347,26 @@ our @CLIENT_OPTIONS = (
       type => 'int',
       default => 0
     },
+    {
+      name => 'metropolis-bias',
+      type => 'float',
+      default => 0.01
+    },
+    {
+      name => 'with-sort',
+      type => 'bool',
+      default => 0
+    },
+    {
+      name => 'sort-vars',
+      type => 'string',
+      default => ''
+    },
+    {
+      name => 'marginal-vars',
+      type => 'string',
+      default => ''
+    },
     {
       name => 'nbridges',
       type => 'int',
@@ -290,6 +392,16 @@ our @CLIENT_OPTIONS = (
       type => 'int',
       default => 32768
     },
+    {
+      name => 'checkpoint-file',
+      type => 'string',
+      default => ''
+    },
+    {
+      name => 'resume',
+      type => 'bool',
+      default => 0
+    },
     
     # deprecations
     {
@@ -319,12 +431,6 @@ our @CLIENT_OPTIONS = (
       type => 'bool',
       message => 'kernel resampling is no longer supported'
     },
-    {
-      name => 'with-sort',
-      type => 'bool',
-      deprecated => 1,
-      message => 'presorting weights when resampling is no longer supported'
-    },
     {
       name => 'P',
       type => 'int',
@@ -355,10 +461,43 @@ sub process_args {
     my $self = shift;
 
     $self->Bi::Client::process_args(@_);
+    my $model = shift;
     my $filter = $self->get_named_arg('filter');
-    if ($filter eq 'kalman') {
+    if ($filter eq 'kalman' || $filter eq 'raoblackwell') {
         $self->set_named_arg('with-transform-extended', 1);
     }
+    if ($self->get_named_arg('with-sort') && defined $model) {
+        foreach my $name (split(/,/, $self->get_named_arg('sort-vars'))) {
+            my $var = $model->get_var($name);
+            if (!defined $var || ($var->get_type ne 'state' &&
+                $var->get_type ne 'noise')) {
+                die("--sort-vars: '$name' is not a state or noise variable of the model\n");
+            }
+        }
+    }
+    if ($filter eq 'raoblackwell' &&
+        $self->get_named_arg('marginal-vars') eq '') {
+        die("--filter raoblackwell requires --marginal-vars\n");
+    }
+    if ($filter eq 'raoblackwell' && defined $model) {
+        foreach my $name (split(/,/, $self->get_named_arg('marginal-vars'))) {
+            my $var = $model->get_var($name);
+            if (!defined $var || $var->get_type ne 'state') {
+                die("--marginal-vars: '$name' is not a state variable of the model\n");
+            }
+        }
+    }
+    if ($filter eq 'raoblackwell' && ref($self) ne 'Bi::Client::filter') {
+        die("--filter raoblackwell is supported only by the filter command\n");
+    }
+    if ($self->get_named_arg('checkpoint-file') ne '' &&
+        $filter ne 'bootstrap') {
+        die("--checkpoint-file is supported only with --filter bootstrap\n");
+    }
+    if ($self->get_named_arg('resume') &&
+        $self->get_named_arg('checkpoint-file') eq '') {
+        die("--resume requires --checkpoint-file\n");
+    }
     $self->{_binary} = 'filter';
 }
 
@@ -57,6 +57,23 @@ Nelder-Mead simplex method.
 
 =back
 
+=item C<--restarts> (default 1)
+
+Number of times to run the optimiser. The first run starts from the
+initialisation file, if given, and subsequent runs from draws from the
+prior. Results of all runs are output in sequence, followed by the best
+optimum found.
+
+Under C<--with-mpi>, runs are shared between processes and run
+concurrently, each process using all particles. Each process outputs its
+own runs, followed by the best optimum over all processes.
+
+=item C<--with-common-random-numbers> (default 1)
+
+Use the same random numbers for each evaluation of the objective, so that
+the noise in likelihood estimates does not confound comparisons between
+nearby parameter values.
+
 =back
 
 =head2 Nelder-mead simplex method-specific options
@@ -99,6 +116,16 @@ our @CLIENT_OPTIONS = (
       type => 'string',
       default => 'likelihood'
     },
+    {
+      name => 'restarts',
+      type => 'int',
+      default => 1
+    },
+    {
+      name => 'with-common-random-numbers',
+      type => 'bool',
+      default => 1
+    },
     {
       name => 'simplex-size-rel',
       type => 'float',
@@ -77,6 +77,19 @@ Marginal sequential importance resampling (Chopin, Jacob & Papaspiliopoulos, 201
 
 Marginal sequential importance sampling (SIS).
 
+=item C<pt>
+
+Marginal parallel tempering, a population of marginal Metropolis-Hastings
+chains at different temperatures that periodically swap states.
+
+=item C<pg>
+
+Particle Gibbs with ancestor sampling (Andrieu, Doucet & Holenstein, 2010;
+Lindsten, Jordan & Schon, 2014), which alternates Metropolis-Hastings
+updates of the parameters given the state path, and updates of the path
+by a conditional particle filter. Mixes well with far fewer particles
+than C<mh>.
+
 =back
 
 For MH, the proposal works according to the L<proposal_parameter> top-level
@@ -90,10 +103,123 @@ L<initial> top-level block instead.
 For SIR, the same blocks are used as proposals for rejuvenation steps,
 unless one of the adaptation strategies below is enabled.
 
+For PG, the same blocks are used to propose parameters, but the
+acceptance probability uses the joint density of the current state path
+and the observations in place of the likelihood.
+
 =item C<--nsamples> (default 1)
 
 Number of samples to draw.
 
+=item C<--output-cache-size> (default 16777216)
+
+Size, in bytes, of the in-memory cache in which samples are held before
+being written to C<--output-file>. The cache is double-buffered, so that one
+half is written in the background while sampling continues into the other,
+and this size applies to each half.
+
+=back
+
+=head2 MH-specific options
+
+=over 4
+
+=item C<--correlation> (default 0.0)
+
+Correlation, in [0,1), between the auxiliary variables of the filter for the
+current and proposed states. If positive, the correlated pseudo-marginal
+method is used (Deligiannidis, Doucet & Pitt, 2018): all random variates of
+the filter, including initial values, are computed from standard Gaussian
+auxiliary variables kept with the state, and each proposal perturbs these
+with correlation C<--correlation>. Values close to one, such as 0.99, make
+the likelihood estimates of successive states strongly correlated, so that
+far fewer particles are needed for the same acceptance rate. Resampling
+should be made continuous in the auxiliary variables with C<--with-sort>.
+Not supported with C<--enable-cuda>.
+
+=item C<--diagnostics-interval> (default 0)
+
+Number of samples between convergence diagnostics, zero for none, although
+100 is used if C<--stop-ess> is given and this is zero. The
+effective sample size (ESS), by batch means, and the split-R-hat statistic
+of each parameter are computed online from the samples drawn so far, along
+with the acceptance rate since the previous diagnostics. These are reported
+on stderr, and appended to the output file as they are computed, in the
+variables C<diag_sample>, C<diag_acceptance>, and, for each parameter
+C<x>, C<x_ess> and C<x_rhat>, along the dimension C<ndiag>. With MPI, the
+chain of each process is treated as an independent chain: ESS is summed
+over chains, and split-R-hat computed across them.
+
+=item C<--stop-ess> (default 0)
+
+Target ESS. If positive, sampling stops once the smallest ESS of any
+parameter, as of the most recent diagnostics, reaches this value, with
+C<--nsamples> the maximum number of samples to draw. The sample dimension
+of the output file is then left unlimited, and has the length of the
+number of samples actually drawn.
+
+=back
+
+=head2 PG-specific options
+
+=over 4
+
+=item C<--ancestor-sampling> (default 1)
+
+Use ancestor sampling in the conditional particle filter? If not, the
+reference path keeps its own ancestors, and moves away from them only
+through resampling, so that more particles are needed for the same
+mixing.
+
+=back
+
+The conditional particle filter holds one particle to the reference path
+at each time in the schedule, so that all of these must be output times:
+use C<--noutputs> with one output per time step of the model, and keep
+C<--with-output-at-obs>. Only C<--filter bootstrap> is supported, and not
+with C<--enable-cuda>. Resampling is multinomial, the only scheme under
+which the conditional particle filter is valid: the default
+C<--resampler> is replaced with C<multinomial>, and no other value is
+accepted.
+
+The transition and joint densities are those of the model, which include
+only variables updated with C<~>. Where state variables are updated with
+C<< <- >> from noise variables, the densities do not depend on them, and
+the sampler does not target the posterior: update state variables with
+C<~> directly, or use C<mh>.
+
+C<--diagnostics-interval> and C<--stop-ess> apply as for MH, so that PG and
+MH may be compared by the time taken to reach the same ESS.
+
+=head2 Tuning options
+
+=over 4
+
+=item C<--tune-nparticles> (default 0)
+
+Tune the number of particles used by the filter, starting from
+C<--nparticles>. For MH, pilot runs of the filter are made at the initial
+parameters, and the number of particles scaled until the variance of the
+log-likelihood estimate is near C<--tune-variance>. For SIR, the number of
+particles is doubled, by the exchange step of Chopin, Jacob &
+Papaspiliopoulos (2013), whenever the acceptance rate of move steps falls
+below C<--tune-rate>. Not useful with C<--filter kalman> or
+C<--filter adaptive>.
+
+=item C<--tune-variance> (default 1.0)
+
+For MH, the target variance of the log-likelihood estimate.
+
+=item C<--tune-npilots> (default 20)
+
+For MH, the number of pilot runs used to estimate the variance of the
+log-likelihood estimate for each number of particles tried.
+
+=item C<--tune-rate> (default 0.1)
+
+For SIR, the acceptance rate of move steps below which the number of
+particles is doubled.
+
 =back
 
 =head2 SIR-specific options
@@ -171,6 +297,31 @@ instead.
 
 =back
 
+=head2 PT-specific options
+
+=over 4
+
+=item C<--nchains> (default 4)
+
+Number of chains per process. With MPI, chains are distributed across
+processes, the first process holding the coldest chains, and states are
+exchanged between processes when a swap crosses their boundary. Only the
+first chain of each process is output, and only that of the first process
+targets the posterior.
+
+=item C<--max-temperature> (default 10.0)
+
+Temperature of the hottest chain. Temperatures are geometrically spaced
+between 1 for the first chain and this value for the last.
+
+=item C<--swap-interval> (default 1)
+
+Number of Metropolis-Hastings steps taken by each chain between swap
+proposals. Swaps are proposed between pairs of chains adjacent in
+temperature, alternating between pairs starting at even and odd chains.
+
+=back
+
 =cut
 our @CLIENT_OPTIONS = (
     {
@@ -188,16 +339,61 @@ our @CLIENT_OPTIONS = (
       type => 'int',
       default => 1
     },
+    {
+      name => 'output-cache-size',
+      type => 'int',
+      default => 16777216
+    },
     {
       name => 'conditional-pf',
       type => 'int',
       default => 0
     },
+    {
+      name => 'ancestor-sampling',
+      type => 'int',
+      default => 1
+    },
     {
       name => 'joint-adaptation',
       type => 'int',
       default => 0
     },
+    {
+      name => 'correlation',
+      type => 'float',
+      default => 0.0
+    },
+    {
+      name => 'diagnostics-interval',
+      type => 'int',
+      default => 0
+    },
+    {
+      name => 'stop-ess',
+      type => 'float',
+      default => 0.0
+    },
+    {
+      name => 'tune-nparticles',
+      type => 'int',
+      default => 0
+    },
+    {
+      name => 'tune-variance',
+      type => 'float',
+      default => 1.0
+    },
+    {
+      name => 'tune-npilots',
+      type => 'int',
+      default => 20
+    },
+    {
+      name => 'tune-rate',
+      type => 'float',
+      default => 0.1
+    },
     {
       name => 'nmoves',
       type => 'int',
@@ -248,6 +444,21 @@ our @CLIENT_OPTIONS = (
       type => 'float',
       default => 0.25
     },
+    {
+      name => 'nchains',
+      type => 'int',
+      default => 4
+    },
+    {
+      name => 'max-temperature',
+      type => 'float',
+      default => 10.0
+    },
+    {
+      name => 'swap-interval',
+      type => 'int',
+      default => 1
+    },
 );
 
 sub init {
@@ -281,6 +492,25 @@ sub process_args {
     	if ($sampler eq 'sir' || $sampler eq 'smc2') {
 	    	$self->set_named_arg('sampler', 'sir'); # standardise name
     	}
+    	if ($sampler eq 'pg' && $filter ne 'bootstrap') {
+    	    die("--sampler pg is supported only with --filter bootstrap\n");
+    	}
+    	if ($sampler eq 'pg') {
+    	    # the default is replaced, as defaults cannot be told apart from
+    	    # values given
+    	    my $resampler = $self->get_named_arg('resampler');
+    	    if ($resampler eq 'systematic') {
+    	        $self->set_named_arg('resampler', 'multinomial');
+    	    } elsif ($resampler ne 'multinomial') {
+    	        die("--sampler pg is supported only with --resampler multinomial\n");
+    	    }
+    	}
+    }
+    
+    # stopping on ESS needs diagnostics, otherwise off by default
+    if ($self->get_named_arg('stop-ess') > 0 &&
+        $self->get_named_arg('diagnostics-interval') == 0) {
+        $self->set_named_arg('diagnostics-interval', 100);
     }
     
     $self->{_binary} = 'sample';
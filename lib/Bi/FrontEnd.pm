@@ -185,7 +185,7 @@ sub client {
 
     # process args
     $self->_report("Processing arguments...");
-    $client->process_args;
+    $client->process_args($model);
 
     # transform
     if (defined $model && $client->needs_transform) {
@@ -223,7 +223,7 @@ sub copy_dir {
     my $regexp;
     if (@$exts) {
         $regexp = join('|', @$exts);
-        $regexp = qr/\.$regexp\$/;
+        $regexp = qr/\.(?:$regexp)$/;
     } else {
         $regexp = qr/./;
     }
@@ -112,7 +112,7 @@ sub gen {
     }
     
     # library
-    $self->copy_dir('src', 'src', ['cpp', 'hpp', 'cu', 'cuh']);
+    $self->copy_dir('src', 'src', ['cpp', 'hpp', 'cu', 'cuh', 'h']);
 }
 
 =item B<process_dim>(I<dim>)
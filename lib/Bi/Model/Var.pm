@@ -47,6 +47,15 @@ Name to use for the variable in output files.
 
 Output the variable only once, not at each time.
 
+=item C<output_summary> (default 0)
+
+Output only summary statistics of the variable across particles at each
+time, not its value for each particle. These are the weighted mean, weighted
+variance and weighted quantiles, written to variables with the suffixes
+C<_mean>, C<_var> and C<_quantile> on the output name. Applies to state and
+noise variables, and only to the output of C<filter>, and of C<sample> with
+C<--target prior> or C<--target joint>.
+
 =back
 
 =cut
@@ -67,6 +76,10 @@ our $VAR_ARGS = [
     },
     {
         name => 'output_once'
+    },
+    {
+        name => 'output_summary',
+        default => 0
     }
 ];
 
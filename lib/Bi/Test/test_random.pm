@@ -0,0 +1,79 @@
+=head1 NAME
+
+test_random - test random number generation on host.
+
+=head1 SYNOPSIS
+
+    libbi test_random ...
+
+=head1 DESCRIPTION
+
+Checks that the Mersenne Twister engine produces the same stream as
+C<boost::mt19937>, word for word, whether called once per variate, in bulk,
+or through the distributions of Boost.Random. Then checks the bulk standard
+Gaussian (ziggurat) and uniform variates, in both single and double
+precision, for their moments, a chi-square test over bins, and, for
+Gaussians, counts in the tails. Finally times bulk generation. Exits with
+nonzero status if any check fails.
+
+=head1 INHERITS
+
+L<Bi::Client>
+
+=cut
+
+package Bi::Test::test_random;
+
+use parent 'Bi::Client';
+use warnings;
+use strict;
+
+=head1 OPTIONS
+
+=over 4
+
+=item C<--samples> (default 100000000)
+
+Number of variates for each distribution check and timing.
+
+=item C<--max-z> (default 5)
+
+Maximum distance, in standard errors, of each statistic from its expected
+value for a check to pass.
+
+=back
+
+=cut
+our @CLIENT_OPTIONS = (
+    {
+      name => 'samples',
+      type => 'int',
+      default => 100000000
+    },
+    {
+      name => 'max-z',
+      type => 'float',
+      default => 5
+    }
+);
+
+sub init {
+    my $self = shift;
+
+	$self->{_binary} = 'test_random';
+    push(@{$self->{_params}}, @CLIENT_OPTIONS);
+}
+
+sub needs_model {
+    return 0;
+}
+
+1;
+
+=head1 AUTHOR
+
+Lawrence Murray <lawrence.murray@csiro.au>
+
+=head1 VERSION
+
+$Rev$ $Date$
@@ -0,0 +1,92 @@
+=head1 NAME
+
+test_simd - test SIMD math functions.
+
+=head1 SYNOPSIS
+
+    libbi test_simd --enable-sse ...
+
+=head1 DESCRIPTION
+
+Checks the accuracy of the vectorised C<log>, C<exp>, C<log1p>, C<expm1>
+and C<lgamma> against extended precision on random arguments, and against
+libm on zeros, infinities, NaN, subnormals and overflow, then times each
+against its scalar libm version. Requires C<--enable-sse> or
+C<--enable-avx>, and honours C<--enable-single> and
+C<--enable-sse-fast-math>. Exits with nonzero status if any check fails.
+
+=head1 INHERITS
+
+L<Bi::Client>
+
+=cut
+
+package Bi::Test::test_simd;
+
+use parent 'Bi::Client';
+use warnings;
+use strict;
+
+=head1 OPTIONS
+
+=over 4
+
+=item C<--samples> (default 1000000)
+
+Number of random arguments on which to check each function over each
+range.
+
+=item C<--max-ulp> (default 4)
+
+Maximum error, in units in the last place, for a check to pass. With
+C<--enable-sse-fast-math> in double precision, this is in units in the
+last place of single precision. For C<lgamma> near its zeros at 1 and 2,
+where only absolute accuracy is meaningful, sixteen times this in multiples
+of machine epsilon is allowed.
+
+=item C<--reps> (default 100)
+
+Number of repetitions over 65536 arguments when timing each function. Zero
+to skip timing.
+
+=back
+
+=cut
+our @CLIENT_OPTIONS = (
+    {
+      name => 'samples',
+      type => 'int',
+      default => 1000000
+    },
+    {
+      name => 'max-ulp',
+      type => 'float',
+      default => 4
+    },
+    {
+      name => 'reps',
+      type => 'int',
+      default => 100
+    }
+);
+
+sub init {
+    my $self = shift;
+
+	$self->{_binary} = 'test_simd';
+    push(@{$self->{_params}}, @CLIENT_OPTIONS);
+}
+
+sub needs_model {
+    return 0;
+}
+
+1;
+
+=head1 AUTHOR
+
+Lawrence Murray <lawrence.murray@csiro.au>
+
+=head1 VERSION
+
+$Rev$ $Date$
@@ -30,10 +30,12 @@ public:
    * @param file File name.
    * @param mode File open mode.
    * @param scheme File schema.
+   * @param bytes Size of each half of the sample cache, in bytes.
    */
   MCMCBuffer(const Model& m, const size_t P = 0, const size_t T = 0,
       const std::string& file = "", const FileMode mode = READ_ONLY,
-      const SchemaMode schema = DEFAULT);
+      const SchemaMode schema = DEFAULT, const size_t bytes =
+          DEFAULT_CACHE_SIZE);
 
   /**
    * Write sample.
@@ -51,8 +53,8 @@ public:
 template<class IO1>
 bi::MCMCBuffer<IO1>::MCMCBuffer(const Model& m, const size_t P,
     const size_t T, const std::string& file, const FileMode mode,
-    const SchemaMode schema) :
-    IO1(m, P, T, file, mode, schema) {
+    const SchemaMode schema, const size_t bytes) :
+    IO1(m, P, T, file, mode, schema, bytes) {
   //
 }
 
@@ -31,10 +31,13 @@ public:
    * @param P Number of trajectories to hold in file.
    * @param T Number of time points to hold in file.
    * @param mode File open mode.
+   * @param schema File schema.
+   * @param bytes Size of each half of the sample cache, in bytes.
    */
   SMCBuffer(const Model& m, const size_t P = 0, const size_t T = 0,
       const std::string& file = "", const FileMode mode = READ_ONLY,
-      const SchemaMode schema = MULTI);
+      const SchemaMode schema = MULTI, const size_t bytes =
+          DEFAULT_CACHE_SIZE);
 
   /**
    * Write sample.
@@ -50,8 +53,9 @@ public:
 
 template<class IO1>
 bi::SMCBuffer<IO1>::SMCBuffer(const Model& m, const size_t P, const size_t T,
-    const std::string& file, const FileMode mode, const SchemaMode schema) :
-    parent_type(m, P, T, file, mode, schema) {
+    const std::string& file, const FileMode mode, const SchemaMode schema,
+    const size_t bytes) :
+    parent_type(m, P, T, file, mode, schema, bytes) {
   //
 }
 
@@ -65,6 +69,7 @@ void bi::SMCBuffer<IO1>::write(const S1& s) {
       this->clear();
     }
   }
+  this->sync();
   parent_type::writeLogWeights(0, s.logWeights());
 }
 
@@ -31,10 +31,13 @@ public:
    * @param T Number of time points to hold in file.
    * @param file File name.
    * @param mode File open mode.
+   * @param schema File schema.
+   * @param bytes Size of each half of the sample cache, in bytes.
    */
   SRSBuffer(const Model& m, const size_t P = 0, const size_t T = 0,
       const std::string& file = "", const FileMode mode = READ_ONLY,
-      const SchemaMode schema = DEFAULT);
+      const SchemaMode schema = DEFAULT, const size_t bytes =
+          DEFAULT_CACHE_SIZE);
 
   /**
    * Write sample.
@@ -51,8 +54,9 @@ public:
 
 template<class IO1>
 bi::SRSBuffer<IO1>::SRSBuffer(const Model& m, const size_t P, const size_t T,
-    const std::string& file, const FileMode mode, const SchemaMode schema) :
-    parent_type(m, P, T, file, mode, schema) {
+    const std::string& file, const FileMode mode, const SchemaMode schema,
+    const size_t bytes) :
+    parent_type(m, P, T, file, mode, schema, bytes) {
   //
 }
 
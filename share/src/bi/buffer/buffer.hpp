@@ -8,7 +8,14 @@
 #ifndef BI_BUFFER_BUFFER_HPP
 #define BI_BUFFER_BUFFER_HPP
 
+#include <cstddef>
+
 namespace bi {
+/**
+ * Default size, in bytes, of in-memory caches of samples.
+ */
+static const size_t DEFAULT_CACHE_SIZE = 16777216;
+
 /**
  * Schema flags.
  */
@@ -77,6 +77,13 @@ public:
   template<class M1, class V1>
   void writeState(const int k, const M1 X, const V1 as);
 
+  /**
+   * Does nothing, as particles are written in blocks, and summaries are
+   * instead written by push() once all are available.
+   */
+  template<class M1, class V1>
+  void writeSummary(const int k, const M1 X, const V1 lws);
+
   /**
    * Push down to BootstrapPFCache. This is a special method for
    * AdaptivePFCache that pushes temporary storage of particles
@@ -110,6 +117,7 @@ public:
 private:
   typedef typename loc_matrix<CL,real>::type matrix_type;
   typedef typename loc_vector<CL,real>::type vector_type;
+  typedef typename loc_vector<CL,wreal>::type weight_vector_type;
   typedef typename loc_vector<CL,int>::type int_vector_type;
 
   /**
@@ -125,7 +133,7 @@ private:
   /**
    * Cache for log-weights while adapting.
    */
-  CacheObject<vector_type> logWeightCache;
+  CacheObject<weight_vector_type> logWeightCache;
 
   /**
    * Cache for ancestry while adapting.
@@ -258,6 +266,13 @@ void bi::AdaptivePFCache<CL,IO1>::writeState(const int k, const M1 X,
   subrange(ancestorCache.get(j), P - as.size(), as.size()) = as;
 }
 
+template<bi::Location CL, class IO1>
+template<class M1, class V1>
+void bi::AdaptivePFCache<CL,IO1>::writeSummary(const int k, const M1 X,
+    const V1 lws) {
+  //
+}
+
 template<bi::Location CL, class IO1>
 void bi::AdaptivePFCache<CL,IO1>::push(const int P) {
   int k = 0;
@@ -267,6 +282,8 @@ void bi::AdaptivePFCache<CL,IO1>::push(const int P) {
         subrange(ancestorCache.get(k), 0, P));
     parent_type::writeLogWeights(base + k,
         subrange(logWeightCache.get(k), 0, P));
+    parent_type::writeSummary(base + k, rows(particleCache.get(k), 0, P),
+        subrange(logWeightCache.get(k), 0, P));
     ++k;
   }
 
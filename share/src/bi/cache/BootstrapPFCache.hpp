@@ -57,7 +57,7 @@ public:
    *
    * @return The most recent log-weights vector to be written to the cache.
    */
-  const typename Cache1D<real,CL>::vector_reference_type getLogWeights() const;
+  const typename Cache1D<wreal,CL>::vector_reference_type getLogWeights() const;
 
   /**
    * Write-through to the underlying buffer, as well as efficient caching
@@ -120,7 +120,7 @@ private:
   /**
    * Most recent log-weights.
    */
-  Cache1D<real,CL> logWeightsCache;
+  Cache1D<wreal,CL> logWeightsCache;
 
   /**
    * Serialize.
@@ -175,7 +175,7 @@ bi::BootstrapPFCache<CL,IO1>::~BootstrapPFCache() {
 }
 
 template<bi::Location CL, class IO1>
-const typename bi::Cache1D<real,CL>::vector_reference_type bi::BootstrapPFCache<
+const typename bi::Cache1D<wreal,CL>::vector_reference_type bi::BootstrapPFCache<
     CL,IO1>::getLogWeights() const {
   return logWeightsCache.get(0, logWeightsCache.size());
 }
@@ -13,6 +13,8 @@
 #include "CacheCross.hpp"
 #include "../model/Model.hpp"
 #include "../null/MCMCNullBuffer.hpp"
+#include "../pdf/MCMCDiagnostics.hpp"
+#include "../misc/Thread.hpp"
 
 namespace bi {
 /**
@@ -22,6 +24,16 @@ namespace bi {
  *
  * @tparam IO1 Output type.
  * @tparam CL Location.
+ *
+ * The cache is double-buffered. When full, flush() hands the filled half to
+ * a background thread for writing, and sampling continues into the other
+ * half. Each variable is written with a single transaction covering all
+ * samples and times in the half.
+ *
+ * Parameter samples are also passed, as they are written, to convergence
+ * diagnostics (see MCMCDiagnostics), which diagnose() computes and writes
+ * through to the output buffer on request. Each sample should be written
+ * once, in order.
  */
 template<Location CL = ON_HOST, class IO1 = MCMCNullBuffer>
 class MCMCCache: public SimulatorCache<CL,IO1> {
@@ -33,7 +45,8 @@ public:
    */
   MCMCCache(const Model& m, const size_t P = 0, const size_t T = 0,
       const std::string& file = "", const FileMode mode = READ_ONLY,
-      const SchemaMode schema = DEFAULT);
+      const SchemaMode schema = DEFAULT, const size_t bytes =
+          DEFAULT_CACHE_SIZE);
 
   /**
    * Shallow copy constructor.
@@ -149,23 +162,76 @@ public:
   void empty();
 
   /**
-   * Flush to output buffer.
+   * Flush to output buffer. The contents of the cache are written in the
+   * background where possible, and the cache is left empty.
    */
   void flush();
 
+  /**
+   * Wait for any background write to complete.
+   */
+  void sync();
+
+  /**
+   * @copydoc SimulatorNetCDFBuffer::writeClock()
+   */
+  void writeClock(const long clock);
+
+  /**
+   * Compute convergence diagnostics from the parameter samples written so
+   * far, and write them to the output buffer immediately. Under MPI,
+   * collective.
+   *
+   * @return Diagnostics.
+   */
+  const MCMCDiagnostics& diagnose();
+
 protected:
   /**
-   * Flush state trajectories to disk.
+   * Write the back half of the cache to the output buffer, then clear it.
+   */
+  void writeBack();
+
+  /**
+   * Write parameters in the back half of the cache to the output buffer.
+   */
+  void writeBackParameters();
+
+  /**
+   * Write state trajectories in the back half of the cache to the output
+   * buffer.
    *
    * @param type Variable type.
    */
-  void flushPaths(const VarType type);
+  void writeBackPaths(const VarType type);
+
+  /**
+   * Task for background writes.
+   */
+  struct write_task {
+    /**
+     * Cache to write.
+     */
+    MCMCCache<CL,IO1>* cache;
+
+    /**
+     * Run the task.
+     */
+    void operator()() {
+      cache->writeBack();
+    }
+  };
 
   /**
    * Model.
    */
   const Model& m;
 
+  /**
+   * Maximum number of samples to store in each half of the cache.
+   */
+  int maxLen;
+
   /**
    * Log-likelihoods cache.
    */
@@ -197,10 +263,69 @@ protected:
   int len;
 
   /**
-   * Maximum number of samples to store in cache.
+   * Log-likelihoods cache, back half.
+   */
+  Cache1D<real,CL> llBack;
+
+  /**
+   * Log-prior densities cache, back half.
+   */
+  Cache1D<real,CL> lpBack;
+
+  /**
+   * Parameters cache, back half.
+   */
+  CacheCross<real,CL> parameterBack;
+
+  /**
+   * Trajectories cache, back half.
+   */
+  std::vector<CacheCross<real,CL>*> pathBack;
+
+  /**
+   * Id of first sample in back half.
+   */
+  int backFirst;
+
+  /**
+   * Number of samples in back half.
+   */
+  int backLen;
+
+  /**
+   * Convergence diagnostics.
+   */
+  MCMCDiagnostics diagnostics;
+
+  /**
+   * Background writer.
+   */
+  Thread writer;
+
+  /**
+   * Background write task.
+   */
+  write_task task;
+
+  /**
+   * Are writes performed in the background? Device caches, and all caches
+   * in CUDA builds, are written synchronously, as their transfers rely on
+   * per-thread streams and allocators.
    */
-  static const int NUM_SAMPLES = ((CL == ON_HOST) ? 16384 : 4096)
-      / sizeof(real);
+  #ifdef ENABLE_CUDA
+  static const bool ASYNC = false;
+  #else
+  static const bool ASYNC = CL == ON_HOST;
+  #endif
+
+  /**
+   * Compute maximum number of samples to store in each half of the cache.
+   *
+   * @param m Model.
+   * @param T Number of times.
+   * @param bytes Size of each half of the cache, in bytes.
+   */
+  static int capacity(const Model& m, const size_t T, const size_t bytes);
 
   /**
    * Serialize.
@@ -222,52 +347,91 @@ protected:
 };
 }
 
+#include "../math/temp_vector.hpp"
+
 template<bi::Location CL, class IO1>
 bi::MCMCCache<CL,IO1>::MCMCCache(const Model& m, const size_t P,
     const size_t T, const std::string& file, const FileMode mode,
-    const SchemaMode schema) :
-    parent_type(m, P, T, file, mode, schema), m(m), llCache(NUM_SAMPLES), lpCache(
-        NUM_SAMPLES), parameterCache(NUM_SAMPLES, m.getNetSize(P_VAR)), first(
-        0), len(0) {
+    const SchemaMode schema, const size_t bytes) :
+    parent_type(m, P, T, file, mode, schema), m(m), maxLen(
+        capacity(m, T, bytes)), llCache(maxLen), lpCache(maxLen), parameterCache(
+        maxLen, m.getNetSize(P_VAR)), first(0), len(0), llBack(maxLen), lpBack(
+        maxLen), parameterBack(maxLen, m.getNetSize(P_VAR)), backFirst(0), backLen(
+        0), diagnostics(m.getNetSize(P_VAR)) {
   const int N = m.getNetSize(R_VAR) + m.getNetSize(D_VAR);
   pathCache.resize(T);
+  pathBack.resize(T);
   for (int i = 0; i < pathCache.size(); ++i) {
-    pathCache[i] = new CacheCross<real,CL>(NUM_SAMPLES, N);
+    pathCache[i] = new CacheCross<real,CL>(maxLen, N);
+    pathBack[i] = new CacheCross<real,CL>(maxLen, N);
   }
 }
 
 template<bi::Location CL, class IO1>
 bi::MCMCCache<CL,IO1>::MCMCCache(const MCMCCache<CL,IO1>& o) :
-    parent_type(o), m(o.m), llCache(o.llCache), lpCache(o.lpCache), parameterCache(
-        o.parameterCache), first(o.first), len(o.len) {
+    parent_type(o), m(o.m), maxLen(o.maxLen), llCache(o.llCache), lpCache(
+        o.lpCache), parameterCache(o.parameterCache), first(o.first), len(o.len), llBack(
+        o.maxLen), lpBack(o.maxLen), parameterBack(o.maxLen,
+        o.m.getNetSize(P_VAR)), backFirst(0), backLen(0), diagnostics(
+        o.diagnostics) {
+  const int N = m.getNetSize(R_VAR) + m.getNetSize(D_VAR);
   pathCache.resize(o.pathCache.size());
+  pathBack.resize(o.pathCache.size());
   for (int i = 0; i < pathCache.size(); ++i) {
     pathCache[i] = new CacheCross<real,CL>(*o.pathCache[i]);
+    pathBack[i] = new CacheCross<real,CL>(maxLen, N);
   }
 }
 
 template<bi::Location CL, class IO1>
 bi::MCMCCache<CL,IO1>::~MCMCCache() {
+  sync();
   for (int i = 0; i < int(pathCache.size()); ++i) {
     delete pathCache[i];
   }
+  for (int i = 0; i < int(pathBack.size()); ++i) {
+    delete pathBack[i];
+  }
 }
 
 template<bi::Location CL, class IO1>
 bi::MCMCCache<CL,IO1>& bi::MCMCCache<CL,IO1>::operator=(
     const MCMCCache<CL,IO1>& o) {
+  if (this == &o) {
+    return *this;
+  }
+
+  /* the back halves of both are only stable once their writers finish */
+  sync();
+  const_cast<MCMCCache<CL,IO1>&>(o).sync();
   parent_type::operator=(o);
 
+  maxLen = o.maxLen;
   llCache = o.llCache;
   lpCache = o.lpCache;
   parameterCache = o.parameterCache;
   first = o.first;
   len = o.len;
+  llBack = o.llBack;
+  lpBack = o.lpBack;
+  parameterBack = o.parameterBack;
+  backFirst = o.backFirst;
+  backLen = o.backLen;
+  diagnostics = o.diagnostics;
 
+  for (int i = 0; i < int(pathCache.size()); ++i) {
+    delete pathCache[i];
+  }
+  for (int i = 0; i < int(pathBack.size()); ++i) {
+    delete pathBack[i];
+  }
   pathCache.resize(o.pathCache.size());
-  for (int i = 0; i < pathCache.size(); ++i) {
-    pathCache[i] = new CacheCross<real,CL>();
-    pathCache[i] = *o.pathCache[i];
+  pathBack.resize(o.pathBack.size());
+  for (int i = 0; i < int(pathCache.size()); ++i) {
+    pathCache[i] = new CacheCross<real,CL>(*o.pathCache[i]);
+  }
+  for (int i = 0; i < int(pathBack.size()); ++i) {
+    pathBack[i] = new CacheCross<real,CL>(*o.pathBack[i]);
   }
 
   return *this;
@@ -339,6 +503,15 @@ void bi::MCMCCache<CL,IO1>::writeParameter(const int p, const V1 theta) {
     len = p - first + 1;
   }
   parameterCache.set(p - first, theta);
+
+  if (V1::on_device) {
+    typename temp_host_vector<real>::type theta1(theta.size());
+    theta1 = theta;
+    synchronize(V1::on_device);
+    diagnostics.add(theta1);
+  } else {
+    diagnostics.add(theta);
+  }
 }
 
 template<bi::Location CL, class IO1>
@@ -372,11 +545,13 @@ void bi::MCMCCache<CL,IO1>::writePath(const int p, const M1 X) {
 
 template<bi::Location CL, class IO1>
 bool bi::MCMCCache<CL,IO1>::isFull() const {
-  return len == NUM_SAMPLES;
+  return len == maxLen;
 }
 
 template<bi::Location CL, class IO1>
 void bi::MCMCCache<CL,IO1>::swap(MCMCCache<CL,IO1>& o) {
+  sync();
+  o.sync();
   parent_type::swap(o);
   llCache.swap(o.llCache);
   lpCache.swap(o.lpCache);
@@ -384,6 +559,12 @@ void bi::MCMCCache<CL,IO1>::swap(MCMCCache<CL,IO1>& o) {
   pathCache.swap(o.pathCache);
   std::swap(first, o.first);
   std::swap(len, o.len);
+  std::swap(maxLen, o.maxLen);
+  llBack.swap(o.llBack);
+  lpBack.swap(o.lpBack);
+  parameterBack.swap(o.parameterBack);
+  pathBack.swap(o.pathBack);
+  std::swap(diagnostics, o.diagnostics);
 }
 
 template<bi::Location CL, class IO1>
@@ -401,6 +582,7 @@ void bi::MCMCCache<CL,IO1>::clear() {
 
 template<bi::Location CL, class IO1>
 void bi::MCMCCache<CL,IO1>::empty() {
+  sync();
   llCache.empty();
   lpCache.empty();
   parameterCache.empty();
@@ -411,49 +593,141 @@ void bi::MCMCCache<CL,IO1>::empty() {
   pathCache.resize(0);
   first = 0;
   len = 0;
+  llBack.empty();
+  lpBack.empty();
+  parameterBack.empty();
+  for (int k = 0; k < pathBack.size(); ++k) {
+    pathBack[k]->empty();
+    delete pathBack[k];
+  }
+  pathBack.resize(0);
+  backFirst = 0;
+  backLen = 0;
   parent_type::empty();
 }
 
 template<bi::Location CL, class IO1>
 void bi::MCMCCache<CL,IO1>::flush() {
-  parent_type::writeLogLikelihoods(first, llCache.get(0, len));
-  parent_type::writeLogPriors(first, lpCache.get(0, len));
-  parent_type::writeParameters(first, parameterCache.get(0, len));
-
-  llCache.flush();
-  lpCache.flush();
-  parameterCache.flush();
+  /* the back half is only written by the writer, so wait for it before
+   * reusing it */
+  sync();
 
-  flushPaths(R_VAR);
-  flushPaths(D_VAR);
+  /* times are few, and may be cleared on return, so write them now */
   parent_type::flush();
+
+  /* swap halves; the back half is left clear by the previous write */
+  llCache.swap(llBack);
+  lpCache.swap(lpBack);
+  parameterCache.swap(parameterBack);
+  pathCache.swap(pathBack);
+  std::swap(first, backFirst);
+  std::swap(len, backLen);
+  first = backFirst + backLen;
+  len = 0;
+
+  if (backLen > 0) {
+    if (ASYNC) {
+      task.cache = this;
+      writer.start(task);
+    } else {
+      writeBack();
+    }
+  }
+}
+
+template<bi::Location CL, class IO1>
+void bi::MCMCCache<CL,IO1>::sync() {
+  writer.join();
+}
+
+template<bi::Location CL, class IO1>
+void bi::MCMCCache<CL,IO1>::writeClock(const long clock) {
+  sync();
+  parent_type::writeClock(clock);
 }
 
 template<bi::Location CL, class IO1>
-void bi::MCMCCache<CL,IO1>::flushPaths(const VarType type) {
-  /* don't do it time-by-time, too much seeking in looping over variables
-   * several times... */
-  //for (int k = 0; k < int(pathCache.size()); ++k) {
-  //  IO1::writeState(k, first, pathCache[k]->get(0, len));
-  //  pathCache[k]->flush();
-  //}
-  /* ...do it variable-by-variable instead, and loop over times several
-   * times */
+const bi::MCMCDiagnostics& bi::MCMCCache<CL,IO1>::diagnose() {
+  diagnostics.diagnose();
+
+  /* the output buffer is not safe to use concurrently with the writer */
+  sync();
+  parent_type::writeDiagnostics(diagnostics);
+
+  return diagnostics;
+}
+
+template<bi::Location CL, class IO1>
+void bi::MCMCCache<CL,IO1>::writeBack() {
+  parent_type::writeLogLikelihoods(backFirst, llBack.get(0, backLen));
+  parent_type::writeLogPriors(backFirst, lpBack.get(0, backLen));
+  writeBackParameters();
+  writeBackPaths(R_VAR);
+  writeBackPaths(D_VAR);
+
+  llBack.clear();
+  lpBack.clear();
+  parameterBack.clear();
+  for (int k = 0; k < int(pathBack.size()); ++k) {
+    pathBack[k]->clear();
+  }
+  backLen = 0;
+}
+
+template<bi::Location CL, class IO1>
+void bi::MCMCCache<CL,IO1>::writeBackParameters() {
+  /* each variable is staged in a contiguous buffer here, rather than left
+   * to the output buffer, as the latter would use the pooled allocators of
+   * the calling thread */
   Var* var;
-  int id, i, k, start, size;
+  int id, start, size;
 
-  for (id = 0; id < m.getNumVars(type); ++id) {
-    var = m.getVar(type, id);
-    start = var->getStart() + ((type == D_VAR) ? m.getNetSize(R_VAR) : 0);
+  for (id = 0; id < m.getNumVars(P_VAR); ++id) {
+    var = m.getVar(P_VAR, id);
+    start = var->getStart();
     size = var->getSize();
 
-    for (k = 0; k < int(pathCache.size()); ++k) {
-      IO1::writeStateVar(type, id, k, first,
-          columns(pathCache[k]->get(0, len), start, size));
+    host_matrix<real> X(backLen, size);
+    X = columns(parameterBack.get(0, backLen), start, size);
+    parent_type::writeStateVar(P_VAR, id, 0, backFirst, X);
+  }
+}
+
+template<bi::Location CL, class IO1>
+void bi::MCMCCache<CL,IO1>::writeBackPaths(const VarType type) {
+  /* gather each variable across all times in the cache, and write it in a
+   * single transaction, rather than seeking through the file time by
+   * time */
+  const int T = pathBack.size();
+  Var* var;
+  int id, k, start, size;
+
+  if (T > 0) {
+    for (id = 0; id < m.getNumVars(type); ++id) {
+      var = m.getVar(type, id);
+      start = var->getStart() + ((type == D_VAR) ? m.getNetSize(R_VAR) : 0);
+      size = var->getSize();
+
+      host_matrix<real> X(backLen, T * size);
+      for (k = 0; k < T; ++k) {
+        columns(X, k * size, size) = columns(pathBack[k]->get(0, backLen),
+            start, size);
+      }
+      parent_type::writeStateVarRange(type, id, 0, backFirst, X);
     }
   }
 }
 
+template<bi::Location CL, class IO1>
+int bi::MCMCCache<CL,IO1>::capacity(const Model& m, const size_t T,
+    const size_t bytes) {
+  const size_t sampleBytes = sizeof(real)
+      * (2 + m.getNetSize(P_VAR)
+          + T * (m.getNetSize(R_VAR) + m.getNetSize(D_VAR)));
+
+  return bi::max(1, static_cast<int>(bytes / sampleBytes));
+}
+
 template<bi::Location CL, class IO1>
 template<class Archive>
 void bi::MCMCCache<CL,IO1>::save(Archive& ar, const unsigned version) const {
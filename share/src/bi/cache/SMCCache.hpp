@@ -33,7 +33,8 @@ public:
    */
   SMCCache(const Model& m, const size_t P = 0, const size_t T = 0,
       const std::string& file = "", const FileMode mode = READ_ONLY,
-      const SchemaMode schema = MULTI);
+      const SchemaMode schema = MULTI, const size_t bytes =
+          DEFAULT_CACHE_SIZE);
 
 private:
   /**
@@ -58,8 +59,9 @@ private:
 
 template<bi::Location CL, class IO1>
 bi::SMCCache<CL,IO1>::SMCCache(const Model& m, const size_t P, const size_t T,
-    const std::string& file, const FileMode mode, const SchemaMode schema) :
-    parent_type(m, P, T, file, mode, schema) {
+    const std::string& file, const FileMode mode, const SchemaMode schema,
+    const size_t bytes) :
+    parent_type(m, P, T, file, mode, schema, bytes) {
   //
 }
 
@@ -32,7 +32,8 @@ public:
    */
   SRSCache(const Model& m, const size_t P = 0, const size_t T = 0,
       const std::string& file = "", const FileMode mode = READ_ONLY,
-      const SchemaMode schema = DEFAULT);
+      const SchemaMode schema = DEFAULT, const size_t bytes =
+          DEFAULT_CACHE_SIZE);
 
   /**
    * Shallow copy constructor.
@@ -114,9 +115,9 @@ private:
 
 template<bi::Location CL, class IO1>
 bi::SRSCache<CL,IO1>::SRSCache(const Model& m, const size_t P, const size_t T,
-    const std::string& file, const FileMode mode, const SchemaMode schema) :
-    parent_type(m, P, T, file, mode, schema), lwCache(
-        parent_type::NUM_SAMPLES) {
+    const std::string& file, const FileMode mode, const SchemaMode schema,
+    const size_t bytes) :
+    parent_type(m, P, T, file, mode, schema, bytes), lwCache(this->maxLen) {
   //
 }
 
@@ -183,6 +184,9 @@ void bi::SRSCache<CL,IO1>::empty() {
 
 template<bi::Location CL, class IO1>
 void bi::SRSCache<CL,IO1>::flush() {
+  /* log-weights are written synchronously, so must wait for any background
+   * write of the other half to finish with the output buffer */
+  this->sync();
   parent_type::writeLogWeights(this->first, lwCache.get(0, this->len));
   parent_type::flush();
 }
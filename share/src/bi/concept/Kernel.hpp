@@ -43,5 +43,22 @@ struct Kernel {
    */
   template<class T1>
   T1 operator()(const T1 x) const = 0;
+
+  /**
+   * Evaluate the kernel at the differences between one point and a set of
+   * weighted samples, and sum.
+   *
+   * @tparam V1 Vector type.
+   * @tparam M1 Matrix type.
+   * @tparam V2 Vector type.
+   *
+   * @param x \f$x\f$; point at which to evaluate the kernel.
+   * @param Y Samples. Rows index samples, columns index variables.
+   * @param lw Log-weights of samples.
+   *
+   * @return \f$\sum_j \exp(lw_j)\,\mathcal{K}(x - y_j)\f$.
+   */
+  template<class V1, class M1, class V2>
+  typename V1::value_type sum(const V1 x, const M1 Y, const V2 lw) const = 0;
 };
 }
@@ -53,5 +53,26 @@ public:
    */
   template<class V1>
   bi::Partition assign(const V1 x);
+
+  /**
+   * Partition a set of samples about its midpoint, in place.
+   *
+   * @tparam M1 Matrix type.
+   * @tparam V1 Integer vector type.
+   *
+   * @param X Samples. Rows index samples, columns index variables.
+   * @param[in,out] is Indices of components of interest in the weighted
+   * sample set. On return, reordered so that the first
+   * <tt>is.size()/2</tt> are assigned to the left partition and the
+   * remainder to the right.
+   *
+   * @return True if the partition is successful, false otherwise, as for
+   * init().
+   *
+   * Unlike init() and assign(), this guarantees partitions of equal size
+   * (to within one), as required by KDTree.
+   */
+  template<class M1, class V1>
+  bool split(const M1 X, V1 is);
 };
 }
@@ -45,25 +45,23 @@ void bi::RandomGPU::gammas(Random& rng, V1 x,
   CUDA_CHECK;
 }
 
-template<class V1>
-void bi::RandomGPU::poissons(Random& rng, V1 x,
-    const typename V1::value_type lambda) {
+template<class V1, class V2>
+void bi::RandomGPU::poissons(Random& rng, const V1 lambdas, V2 x) {
   dim3 Db, Dg;
   Db.x = bi::min(x.size(), deviceIdealThreadsPerBlock());
   Dg.x = (bi::min(x.size(), deviceIdealThreads()) + Db.x - 1) / Db.x;
 
-  kernelPoissons<<<Dg,Db>>>(rng.devRngs, x, lambda);
+  kernelPoissons<<<Dg,Db>>>(rng.devRngs, lambdas, x);
   CUDA_CHECK;
 }
 
-template<class V1, class V2>
-void bi::RandomGPU::binomials(Random& rng, V1 x,
-    const typename V1::value_type n, const typename V2::value_type p) {
+template<class V1, class V2, class V3>
+void bi::RandomGPU::binomials(Random& rng, const V1 ns, const V2 ps, V3 x) {
   dim3 Db, Dg;
   Db.x = bi::min(x.size(), deviceIdealThreadsPerBlock());
   Dg.x = (bi::min(x.size(), deviceIdealThreads()) + Db.x - 1) / Db.x;
 
-  kernelBinomials<<<Dg,Db>>>(rng.devRngs, n, p);
+  kernelBinomials<<<Dg,Db>>>(rng.devRngs, ns, ps, x);
   CUDA_CHECK;
 }
 
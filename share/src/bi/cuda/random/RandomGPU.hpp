@@ -51,16 +51,14 @@ struct RandomGPU {
   /**
    * @copydoc Random::poissons
    */
-  template<class V1>
-  static void poissons(Random& rng, V1 x, const typename V1::value_type labmda =
-                     1.0);
+  template<class V1, class V2>
+  static void poissons(Random& rng, const V1 lambdas, V2 x);
 
   /**
-   * @copydoc Random::binomial
+   * @copydoc Random::binomials
    */
-  template<class V1, class V2>
-  static void binomials(Random& rng, V1 x, const typename V1::value_type n =
-                        1.0, const typename V2::value_type p = 0.5);
+  template<class V1, class V2, class V3>
+  static void binomials(Random& rng, const V1 ns, const V2 ps, V3 x);
 
   /**
    * @copydoc Random::betas
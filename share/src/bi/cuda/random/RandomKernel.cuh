@@ -71,32 +71,34 @@ CUDA_FUNC_GLOBAL void kernelGammas(curandStateSA rng, V1 x,
     const typename V1::value_type beta = 1.0);
 
 /**
- * Kernel function to fill vector with poisson variates.
+ * Kernel function to fill vector with Poisson variates.
  *
  * @tparam V1 Vector type.
+ * @tparam V2 Vector type.
  *
  * @param[in,out] rng Random number generator.
+ * @param lambdas Rates.
  * @param[out] x Vector to fill.
- * @param lambda Rate.
  */
-template<class V1>
-CUDA_FUNC_GLOBAL void bi::kernelPoissons(curandStateSA rng, V1 x,
-    const typename V1::value_type lambda); 
+template<class V1, class V2>
+CUDA_FUNC_GLOBAL void kernelPoissons(curandStateSA rng, const V1 lambdas,
+    V2 x);
 
 /**
  * Kernel function to fill vector with binomial variates.
  *
  * @tparam V1 Vector type.
  * @tparam V2 Vector type.
+ * @tparam V3 Vector type.
  *
  * @param[in,out] rng Random number generator.
+ * @param ns Sizes.
+ * @param ps Probabilities.
  * @param[out] x Vector to fill.
- * @param n Size.
- * @param p Probability.
  */
-template<class V1, class V2>
-CUDA_FUNC_GLOBAL void bi::kernelBinomials(curandStateSA rng, V1 x,
-    const typename V1::value_type n, const typename V2::value_type p);
+template<class V1, class V2, class V3>
+CUDA_FUNC_GLOBAL void kernelBinomials(curandStateSA rng, const V1 ns,
+    const V2 ps, V3 x);
 }
 
 #include "../../random/Random.hpp"
@@ -145,30 +147,30 @@ CUDA_FUNC_GLOBAL void bi::kernelGammas(curandStateSA rng, V1 x,
   rng.store(q, rng1.r);
 }
 
-template<class V1>
-CUDA_FUNC_GLOBAL void bi::kernelPoissons(curandStateSA rng, V1 x,
-    const typename V1::value_type lambda) {
+template<class V1, class V2>
+CUDA_FUNC_GLOBAL void bi::kernelPoissons(curandStateSA rng, const V1 lambdas,
+    V2 x) {
   const int q = blockIdx.x*blockDim.x + threadIdx.x;
   const int Q = blockDim.x*gridDim.x;
 
   RngGPU rng1;
   rng.load(q, rng1.r);
   for (int p = q; p < x.size(); p += Q) {
-    x(p) = rng1.poisson(lambda);
+    x(p) = rng1.poisson(lambdas(p));
   }
   rng.store(q, rng1.r);
 }
 
-template<class V1, class V2>
-CUDA_FUNC_GLOBAL void bi::kernelBinomials(curandStateSA rng, V1 x,
-    const typename V1::value_type n, const typename V2::value_type p) {
+template<class V1, class V2, class V3>
+CUDA_FUNC_GLOBAL void bi::kernelBinomials(curandStateSA rng, const V1 ns,
+    const V2 ps, V3 x) {
   const int q = blockIdx.x*blockDim.x + threadIdx.x;
   const int Q = blockDim.x*gridDim.x;
 
   RngGPU rng1;
   rng.load(q, rng1.r);
   for (int p = q; p < x.size(); p += Q) {
-    x(p) = rng1.binomial(n, p);
+    x(p) = rng1.binomial(ns(p), ps(p));
   }
   rng.store(q, rng1.r);
 }
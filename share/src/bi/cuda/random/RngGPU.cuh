@@ -77,8 +77,9 @@ public:
    * @copydoc Random::binomial
    *
    * CURAND does not currently provide an API for the generation of binomial
-   * variates. This function is implemented using Knuth's algoirthm as
-   * implemented in GSL.
+   * variates. This function uses the generic implementation in
+   * random/generic.hpp, which, unlike the recursive splitting of Knuth's
+   * algorithm, does not draw gamma variates.
    */
   template<class T1, class T2>
   CUDA_FUNC_DEVICE T1 binomial(T1 n = 1.0, T2 p = 0.5);
@@ -90,6 +91,8 @@ public:
 };
 }
 
+#include "../../random/generic.hpp"
+
 inline void bi::RngGPU::seed(const unsigned seed) {
   /**
    * @todo RNG seeding on device is very slow, perhaps use multiple seeds
@@ -169,40 +172,7 @@ inline double bi::RngGPU::poisson(const double lambda) {
 
 template<class T1, class T2>
 inline T1 bi::RngGPU::binomial(T1 n, T2 p) {
-  const T2 zero = static_cast<T1>(0.0);
-  const T2 one = static_cast<T1>(1.0);
-
-  T1 i, a, b, k = 0;
-
-  while (n > 10) {       /* This parameter is tunable */
-    T2 X;
-    a = 1 + (n / 2);
-    b = 1 + n - a;
-
-    T2 x = this->gamma(a, static_cast<T1>(1.0));
-    T2 y = this->gamma(b, static_cast<T1>(1.0));
-
-    X = x / (x + y);
-
-    if (X >= p) {
-      n = a - 1;
-      p /= X;
-    }
-    else
-      {
-        k += floor(a);
-        n = b - 1;
-        p = (p - X) / (1 - X);
-      }
-  }
-
-  for (i = 0; i < n; i++) {
-    T2 u = this->uniform(zero, one);
-    if (u < p)
-      k++;
-  }
-
-  return k;
+  return bi::binomial(*this, n, p);
 }
 
 #endif
@@ -46,7 +46,8 @@ CUDA_FUNC_GLOBAL void bi::kernelMetropolisResamplerAncestors(curandStateSA rng,
   const int q = blockIdx.x*blockDim.x + threadIdx.x; // thread id
 
   int k, p, p1, p2;
-  real a, lw1, lw2;
+  real a;
+  T1 lw1, lw2;
 
   RngGPU rng1;
   rng.load(q, rng1.r);
@@ -80,7 +80,8 @@ CUDA_FUNC_GLOBAL void bi::kernelRejectionResamplerAncestors(
   const int q = blockIdx.x*blockDim.x + threadIdx.x; // thread id
 
   int p, p2, i;
-  real lalpha, lw2;
+  real lalpha;
+  T1 lw2;
   bool accept;
 
   RngGPU rng1;
@@ -126,7 +127,8 @@ CUDA_FUNC_GLOBAL void bi::kernelRejectionResamplerAncestors2(
 
   int p, p2, i;
   int* __restrict__ buf = reinterpret_cast<int*>(shared_mem);
-  real lalpha, lw2;
+  real lalpha;
+  T1 lw2;
   bool accept;
 
   RngGPU rng1;
@@ -0,0 +1,301 @@
+/**
+ * @file
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ */
+#ifndef BI_EMBED_EMBEDCONTEXT_HPP
+#define BI_EMBED_EMBEDCONTEXT_HPP
+
+#include "../random/Random.hpp"
+#include "../state/Schedule.hpp"
+#include "../math/constant.hpp"
+#include "../math/vector.hpp"
+#include "../math/view.hpp"
+#include "../misc/exception.hpp"
+
+#include "boost/shared_ptr.hpp"
+
+#include <vector>
+
+namespace bi {
+/**
+ * Context for repeated filtering from a host program, behind the C
+ * interface of embed.h.
+ *
+ * @ingroup method_filter
+ *
+ * The context owns everything required to run the filter, so that inputs,
+ * observations, the time schedule and the allocations of the filter are
+ * set up once and remain resident across calls.
+ */
+class EmbedContext {
+public:
+  /**
+   * Destructor. Destroys owned objects in the reverse order of
+   * their addition.
+   */
+  virtual ~EmbedContext();
+
+  /**
+   * Take ownership of an object.
+   *
+   * @tparam T Object type.
+   *
+   * @param x Object, allocated with @c new.
+   *
+   * Objects should be added in the order of their construction, so that
+   * objects are destroyed before those that they reference.
+   */
+  template<class T>
+  void own(T* x);
+
+  /**
+   * Share ownership of an object.
+   *
+   * @tparam T Object type.
+   *
+   * @param x Object, as returned by factories.
+   */
+  template<class T>
+  void own(boost::shared_ptr<T> x);
+
+  /**
+   * Number of parameters.
+   */
+  virtual int numParameters() const = 0;
+
+  /**
+   * Set parameters at which to filter.
+   *
+   * @param theta Parameters, of length numParameters().
+   */
+  virtual void setParameters(const double* theta) = 0;
+
+  /**
+   * Get parameters of the most recent run of the filter.
+   *
+   * @param[out] theta Parameters, of length numParameters().
+   */
+  virtual void getParameters(double* theta) const = 0;
+
+  /**
+   * Run the filter.
+   */
+  virtual void filter() = 0;
+
+  /**
+   * Log-likelihood estimate of the most recent run of the filter.
+   */
+  virtual double getLogLikelihood() const = 0;
+
+  /**
+   * Prior log-density of the parameters of the most recent run of the
+   * filter.
+   */
+  virtual double getLogPrior() const = 0;
+
+  /**
+   * Duration of the most recent run of the filter, in microseconds.
+   */
+  virtual long getClock() const = 0;
+
+private:
+  /**
+   * Owned objects.
+   */
+  std::vector<boost::shared_ptr<void> > owned;
+};
+
+/**
+ * Context for a particular model and filter.
+ *
+ * @ingroup method_filter
+ *
+ * @tparam B Model type.
+ * @tparam F #concept::Filter type.
+ * @tparam S State type.
+ * @tparam IO1 Output type.
+ * @tparam IO2 Input type.
+ */
+template<class B, class F, class S, class IO1, class IO2>
+class EmbedContextImpl: public EmbedContext {
+public:
+  /**
+   * Constructor.
+   *
+   * @param rng Random number generator.
+   * @param m Model.
+   * @param filter Filter.
+   * @param s State.
+   * @param out Output buffer.
+   * @param inInit Init buffer.
+   * @param sched Time schedule.
+   *
+   * The arguments are referenced, not owned, see own().
+   */
+  EmbedContextImpl(Random& rng, B& m, F& filter, S& s, IO1& out,
+      IO2& inInit, Schedule& sched);
+
+  virtual int numParameters() const;
+  virtual void setParameters(const double* theta);
+  virtual void getParameters(double* theta) const;
+  virtual void filter();
+  virtual double getLogLikelihood() const;
+  virtual double getLogPrior() const;
+  virtual long getClock() const;
+
+  /**
+   * Propose parameters set with setParameters(), as adapter to the filter.
+   */
+  template<class S1, class S2>
+  void propose(Random& rng, S1& s1, S2& s2);
+
+private:
+  /**
+   * Random number generator.
+   */
+  Random& rng;
+
+  /**
+   * Model.
+   */
+  B& m;
+
+  /**
+   * Filter.
+   */
+  F& f;
+
+  /**
+   * State.
+   */
+  S& s;
+
+  /**
+   * Output buffer.
+   */
+  IO1& out;
+
+  /**
+   * Init buffer.
+   */
+  IO2& inInit;
+
+  /**
+   * Time schedule.
+   */
+  Schedule& sched;
+
+  /**
+   * Parameters set with setParameters().
+   */
+  host_vector<double> theta;
+
+  /**
+   * Have parameters been set?
+   */
+  bool haveParameters;
+};
+
+/**
+ * Factory for creating EmbedContext objects.
+ *
+ * @ingroup method_filter
+ */
+struct EmbedContextFactory {
+  /**
+   * Create context.
+   */
+  template<class B, class F, class S, class IO1, class IO2>
+  static EmbedContextImpl<B,F,S,IO1,IO2>* create(Random& rng, B& m,
+      F& filter, S& s, IO1& out, IO2& inInit, Schedule& sched) {
+    return new EmbedContextImpl<B,F,S,IO1,IO2>(rng, m, filter, s, out,
+        inInit, sched);
+  }
+};
+}
+
+inline bi::EmbedContext::~EmbedContext() {
+  while (!owned.empty()) {
+    owned.pop_back();
+  }
+}
+
+template<class T>
+void bi::EmbedContext::own(T* x) {
+  owned.push_back(boost::shared_ptr<void>(x));
+}
+
+template<class T>
+void bi::EmbedContext::own(boost::shared_ptr<T> x) {
+  owned.push_back(x);
+}
+
+template<class B, class F, class S, class IO1, class IO2>
+bi::EmbedContextImpl<B,F,S,IO1,IO2>::EmbedContextImpl(Random& rng, B& m,
+    F& filter, S& s, IO1& out, IO2& inInit, Schedule& sched) :
+    rng(rng), m(m), f(filter), s(s), out(out), inInit(inInit), sched(
+        sched), theta(B::NP), haveParameters(false) {
+  //
+}
+
+template<class B, class F, class S, class IO1, class IO2>
+int bi::EmbedContextImpl<B,F,S,IO1,IO2>::numParameters() const {
+  return B::NP;
+}
+
+template<class B, class F, class S, class IO1, class IO2>
+void bi::EmbedContextImpl<B,F,S,IO1,IO2>::setParameters(
+    const double* theta) {
+  this->theta = host_vector_reference<double>(const_cast<double*>(theta),
+      B::NP);
+  haveParameters = true;
+}
+
+template<class B, class F, class S, class IO1, class IO2>
+void bi::EmbedContextImpl<B,F,S,IO1,IO2>::getParameters(double* theta) const {
+  host_vector_reference<double>(theta, B::NP) = vec(s.get(P_VAR));
+}
+
+template<class B, class F, class S, class IO1, class IO2>
+void bi::EmbedContextImpl<B,F,S,IO1,IO2>::filter() {
+  if (haveParameters) {
+    f.propose(rng, *sched.begin(), s, s, out, *this);
+  } else {
+    f.init(rng, *sched.begin(), s, out, inInit);
+  }
+  try {
+    f.filter(rng, sched.begin(), sched.end(), s, out);
+    out.flush();
+  } catch (CholeskyException e) {
+    s.logLikelihood = -BI_INF;
+  } catch (ParticleFilterDegeneratedException e) {
+    s.logLikelihood = -BI_INF;
+  }
+}
+
+template<class B, class F, class S, class IO1, class IO2>
+double bi::EmbedContextImpl<B,F,S,IO1,IO2>::getLogLikelihood() const {
+  return s.logLikelihood;
+}
+
+template<class B, class F, class S, class IO1, class IO2>
+double bi::EmbedContextImpl<B,F,S,IO1,IO2>::getLogPrior() const {
+  return s.logPrior;
+}
+
+template<class B, class F, class S, class IO1, class IO2>
+long bi::EmbedContextImpl<B,F,S,IO1,IO2>::getClock() const {
+  return s.clock;
+}
+
+template<class B, class F, class S, class IO1, class IO2>
+template<class S1, class S2>
+void bi::EmbedContextImpl<B,F,S,IO1,IO2>::propose(Random& rng, S1& s1,
+    S2& s2) {
+  vec(s2.get(P_VAR)) = theta;
+}
+
+#endif
@@ -0,0 +1,73 @@
+/**
+ * @file
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ *
+ * Model-independent functions of the C interface. bi_context_create() is
+ * generated along with the model.
+ */
+#include "embed.h"
+#include "EmbedContext.hpp"
+
+/**
+ * Context behind opaque pointer.
+ */
+static bi::EmbedContext* context(bi_context* ctx) {
+  return reinterpret_cast<bi::EmbedContext*>(ctx);
+}
+
+/**
+ * Context behind opaque pointer.
+ */
+static const bi::EmbedContext* context(const bi_context* ctx) {
+  return reinterpret_cast<const bi::EmbedContext*>(ctx);
+}
+
+void bi_context_destroy(bi_context* ctx) {
+  delete context(ctx);
+}
+
+int bi_context_num_parameters(const bi_context* ctx) {
+  return context(ctx)->numParameters();
+}
+
+int bi_context_set_parameters(bi_context* ctx, const double* theta) {
+  try {
+    context(ctx)->setParameters(theta);
+    return 0;
+  } catch (...) {
+    return 1;
+  }
+}
+
+int bi_context_get_parameters(const bi_context* ctx, double* theta) {
+  try {
+    context(ctx)->getParameters(theta);
+    return 0;
+  } catch (...) {
+    return 1;
+  }
+}
+
+int bi_context_filter(bi_context* ctx) {
+  try {
+    context(ctx)->filter();
+    return 0;
+  } catch (...) {
+    return 1;
+  }
+}
+
+double bi_context_log_likelihood(const bi_context* ctx) {
+  return context(ctx)->getLogLikelihood();
+}
+
+double bi_context_log_prior(const bi_context* ctx) {
+  return context(ctx)->getLogPrior();
+}
+
+long bi_context_clock(const bi_context* ctx) {
+  return context(ctx)->getClock();
+}
@@ -0,0 +1,109 @@
+/**
+ * @file
+ *
+ * C interface to a model and filter built as a shared library by the
+ * @c embed command.
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ *
+ * A context holds all inputs, observations, the time schedule and the
+ * allocations of the filter, and keeps them resident across calls, so that
+ * a host program may evaluate the likelihood at many parameter values
+ * without the cost of starting a new process and reading files each time.
+ * A typical sequence of calls is:
+ *
+ * @code
+ * bi_context* ctx = bi_context_create(argc, argv);
+ * while (...) {
+ *   bi_context_set_parameters(ctx, theta);
+ *   bi_context_filter(ctx);
+ *   ll = bi_context_log_likelihood(ctx);
+ * }
+ * bi_context_destroy(ctx);
+ * @endcode
+ *
+ * Functions returning @c int return zero on success and nonzero on failure.
+ * A context must not be used by more than one thread at a time.
+ */
+#ifndef BI_EMBED_EMBED_H
+#define BI_EMBED_EMBED_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Opaque context.
+ */
+typedef struct bi_context bi_context;
+
+/**
+ * Create context.
+ *
+ * @param argc Number of arguments.
+ * @param argv Arguments, as for the @c filter command. The first is ignored,
+ * by convention the program name. Choices that select types, such as
+ * <tt>--filter</tt>, and the presence of files, are fixed when the library
+ * is built, and only their associated values may be changed here.
+ *
+ * @return The context, or null on failure.
+ */
+bi_context* bi_context_create(int argc, char** argv);
+
+/**
+ * Destroy context.
+ */
+void bi_context_destroy(bi_context* ctx);
+
+/**
+ * Number of parameters of the model.
+ */
+int bi_context_num_parameters(const bi_context* ctx);
+
+/**
+ * Set parameters at which to filter.
+ *
+ * @param ctx Context.
+ * @param theta Parameters, of length bi_context_num_parameters().
+ *
+ * Until this is called, parameters are initialised as for the @c filter
+ * command, from the init file or prior.
+ */
+int bi_context_set_parameters(bi_context* ctx, const double* theta);
+
+/**
+ * Get parameters of the most recent run of the filter.
+ *
+ * @param ctx Context.
+ * @param[out] theta Parameters, of length bi_context_num_parameters().
+ */
+int bi_context_get_parameters(const bi_context* ctx, double* theta);
+
+/**
+ * Run the filter. A filter that degenerates is not an error, but gives a
+ * log-likelihood of negative infinity.
+ */
+int bi_context_filter(bi_context* ctx);
+
+/**
+ * Log-likelihood estimate of the most recent run of the filter.
+ */
+double bi_context_log_likelihood(const bi_context* ctx);
+
+/**
+ * Prior log-density of the parameters of the most recent run of the filter.
+ */
+double bi_context_log_prior(const bi_context* ctx);
+
+/**
+ * Duration of the most recent run of the filter, in microseconds.
+ */
+long bi_context_clock(const bi_context* ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -138,7 +138,7 @@ template<class B, class F, class O, class R, class S2>
 template<class S1, class IO1>
 void bi::AdaptivePF<B,F,O,R,S2>::step(Random& rng, ScheduleIterator& iter,
     const ScheduleIterator last, S1& s, IO1& out) {
-  typedef typename loc_temp_vector<S1::location,real>::type vector_type;
+  typedef typename loc_temp_vector<S1::location,wreal>::type weight_vector_type;
   typedef typename loc_temp_matrix<S1::location,real>::type matrix_type;
   typedef typename loc_temp_vector<S1::location,int>::type int_vector_type;
 
@@ -147,7 +147,7 @@ void bi::AdaptivePF<B,F,O,R,S2>::step(Random& rng, ScheduleIterator& iter,
 
   /* state at current time */
   matrix_type X(P, N);
-  vector_type lws(P);
+  weight_vector_type lws(P);
   int_vector_type as(P);
 
   X = s.getDyn();
@@ -0,0 +1,371 @@
+/**
+ * @file
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ */
+#ifndef BI_FILTER_CONDITIONALPF_HPP
+#define BI_FILTER_CONDITIONALPF_HPP
+
+#include "BootstrapPF.hpp"
+#include "../resampler/MultinomialResampler.hpp"
+#include "../misc/exception.hpp"
+
+namespace bi {
+/**
+ * Conditional particle filter.
+ *
+ * @ingroup method_filter
+ *
+ * @tparam B Model type.
+ * @tparam F Forcer type.
+ * @tparam O Observer type.
+ * @tparam R Resampler type.
+ *
+ * When conditional, the first particle is held to a reference trajectory,
+ * taken from the path of the state (see FilterState::path), as in the
+ * conditional sequential Monte Carlo of
+ * @ref Andrieu2010 "Andrieu, Doucet \& Holenstein (2010)". The reference
+ * must have been sampled, with BootstrapPF::samplePath(), from a run of the
+ * filter over the same schedule, and every time in the schedule must be an
+ * output time, so that the reference is known at each.
+ *
+ * With ancestor sampling, at each resampling the ancestor of the reference
+ * is redrawn with weights proportional to the weight of each particle,
+ * multiplied by the transition density from it to the next state of the
+ * reference (@ref Lindsten2014 "Lindsten, Jordan \& Schön, 2014"). The
+ * sampled path then moves away from the reference far more readily, so that
+ * few particles are needed.
+ *
+ * When conditional, resampling is always multinomial, whatever the
+ * resampler given: only then are the ancestors of the other particles
+ * independent of that of the reference, so that fixing the latter leaves
+ * the former with the correct conditional distribution. The given
+ * resampler still determines when to resample, and is used when not
+ * conditional.
+ *
+ * The transition density is that computed by the model, which includes
+ * only variables updated with <tt>~</tt>. Where state variables are
+ * updated with <tt><-</tt> from noise variables, the density of the noise
+ * variables alone is used, which does not depend on the ancestor, and
+ * ancestor sampling should be disabled (see also
+ * @ref Murray2013 "Murray, Jones \& Parslow, 2013").
+ *
+ * When not conditional, behaves as BootstrapPF.
+ */
+template<class B, class F, class O, class R>
+class ConditionalPF: public BootstrapPF<B,F,O,R> {
+public:
+  /**
+   * Constructor.
+   *
+   * @param m Model.
+   * @param in Forcer.
+   * @param obs Observer.
+   * @param resam Resampler.
+   * @param ancestorSampling Use ancestor sampling?
+   */
+  ConditionalPF(B& m, F& in, O& obs, R& resam,
+      const bool ancestorSampling = true);
+
+  /**
+   * Is the filter conditioned on a reference trajectory?
+   */
+  bool getConditional() const;
+
+  /**
+   * Condition, or not, on a reference trajectory.
+   *
+   * @param conditional Condition on the path of the state?
+   */
+  void setConditional(const bool conditional);
+
+  /**
+   * @name High-level interface
+   *
+   * An easier interface for common usage.
+   */
+  //@{
+  /**
+   * @copydoc BootstrapPF::step()
+   */
+  template<class S1, class IO1>
+  void step(Random& rng, ScheduleIterator& iter, const ScheduleIterator last,
+      S1& s, IO1& out);
+  //@}
+
+  /**
+   * @name Low-level interface
+   *
+   * Largely used by other features of the library or for finer control over
+   * performance and behaviour.
+   */
+  //@{
+  /**
+   * Hold the first particle to the reference, if conditional, then update
+   * particle weights using observations at the current time.
+   *
+   * @tparam S1 State type.
+   *
+   * @param rng Random number generator.
+   * @param now Current step in time schedule.
+   * @param s State.
+   */
+  template<class S1>
+  void correct(Random& rng, const ScheduleElement now, S1& s);
+
+  /**
+   * Resample, drawing the ancestor of the reference.
+   *
+   * @tparam S1 State type.
+   *
+   * @param[in,out] rng Random number generator.
+   * @param now Current step in time schedule.
+   * @param next Next step in time schedule.
+   * @param[in,out] s State.
+   */
+  template<class S1>
+  void resample(Random& rng, const ScheduleElement now,
+      const ScheduleElement next, S1& s)
+          throw (ParticleFilterDegeneratedException);
+
+  /**
+   * Compute the joint log-density of the path of the state and the
+   * observations, given the parameters.
+   *
+   * @tparam S1 State type.
+   *
+   * @param first Start of time schedule.
+   * @param last End of time schedule.
+   * @param[in,out] s State. The first particle is overwritten.
+   *
+   * @return Log-density.
+   */
+  template<class S1>
+  double pathLogDensity(const ScheduleIterator first,
+      const ScheduleIterator last, S1& s);
+  //@}
+
+private:
+  /**
+   * Compute ancestor log-weights of the reference.
+   *
+   * @tparam S1 State type.
+   * @tparam V1 Vector type.
+   *
+   * @param next Next step in time schedule.
+   * @param s State.
+   * @param[in,out] lws On input, log-weights of particles. On output,
+   * ancestor log-weights of the reference.
+   */
+  template<class S1, class V1>
+  void ancestorLogWeights(const ScheduleElement next, S1& s, V1 lws);
+
+  /**
+   * Set the first particle, or its query point, to the reference.
+   *
+   * @tparam S1 State type.
+   *
+   * @param k Index of output time.
+   * @param s State.
+   * @param alt Set the alternative buffers rather than the state?
+   */
+  template<class S1>
+  void setReference(const int k, S1& s, const bool alt = false);
+
+  /**
+   * Resampler for conditional resampling.
+   */
+  MultinomialResampler multi;
+
+  /**
+   * Use ancestor sampling?
+   */
+  bool ancestorSampling;
+
+  /**
+   * Conditioned on reference?
+   */
+  bool conditional;
+};
+}
+
+#include "../math/view.hpp"
+#include "../math/loc_temp_matrix.hpp"
+#include "../primitive/vector_primitive.hpp"
+#include "../primitive/matrix_primitive.hpp"
+#include "../traits/resampler_traits.hpp"
+
+template<class B, class F, class O, class R>
+bi::ConditionalPF<B,F,O,R>::ConditionalPF(B& m, F& in, O& obs, R& resam,
+    const bool ancestorSampling) :
+    BootstrapPF<B,F,O,R>(m, in, obs, resam), ancestorSampling(
+        ancestorSampling), conditional(false) {
+  //
+}
+
+template<class B, class F, class O, class R>
+inline bool bi::ConditionalPF<B,F,O,R>::getConditional() const {
+  return conditional;
+}
+
+template<class B, class F, class O, class R>
+inline void bi::ConditionalPF<B,F,O,R>::setConditional(
+    const bool conditional) {
+  this->conditional = conditional;
+}
+
+template<class B, class F, class O, class R>
+template<class S1, class IO1>
+void bi::ConditionalPF<B,F,O,R>::step(Random& rng, ScheduleIterator& iter,
+    const ScheduleIterator last, S1& s, IO1& out) {
+  do {
+    this->resample(rng, *iter, *(iter + 1), s);
+    ++iter;
+    this->predict(rng, *iter, s);
+    this->correct(rng, *iter, s);
+    this->output(*iter, s, out);
+  } while (iter + 1 != last && !iter->isObserved());
+}
+
+template<class B, class F, class O, class R>
+template<class S1>
+double bi::ConditionalPF<B,F,O,R>::pathLogDensity(
+    const ScheduleIterator first, const ScheduleIterator last, S1& s) {
+  /* pre-condition */
+  BI_ASSERT(first->hasOutput());
+
+  ScheduleIterator iter = first;
+  double lp;
+
+  if (iter->hasInput()) {
+    this->in.update(iter->indexInput(), s);
+  }
+  if (iter->hasObs()) {
+    this->obs.update(iter->indexObs(), s);
+  }
+  setReference(iter->indexOutput(), s, true);
+  lp = this->m.initialLogDensity(s, 0);
+  setReference(iter->indexOutput(), s);
+  if (iter->isObserved()) {
+    lp += this->m.observationLogDensity(s,
+        this->obs.getMask(iter->indexObs()), 0);
+  }
+
+  while (iter + 1 != last) {
+    ++iter;
+
+    /* pre-condition */
+    BI_ASSERT(iter->hasOutput());
+
+    if (iter->hasInput()) {
+      this->in.update(iter->indexInput(), s);
+    }
+    if (iter->hasObs()) {
+      this->obs.update(iter->indexObs(), s);
+    }
+    setReference(iter->indexOutput(), s, true);
+    lp += this->m.transitionLogDensity(iter->getFrom(), iter->getTo(),
+        iter->hasDelta(), s, 0);
+    setReference(iter->indexOutput(), s);
+    if (iter->isObserved()) {
+      lp += this->m.observationLogDensity(s,
+          this->obs.getMask(iter->indexObs()), 0);
+    }
+  }
+
+  return lp;
+}
+
+template<class B, class F, class O, class R>
+template<class S1>
+void bi::ConditionalPF<B,F,O,R>::correct(Random& rng,
+    const ScheduleElement now, S1& s) {
+  if (conditional) {
+    BI_ERROR_MSG(now.hasOutput(), "Conditional particle filter requires an output at every time in the schedule");
+    setReference(now.indexOutput(), s);
+  }
+  BootstrapPF<B,F,O,R>::correct(rng, now, s);
+}
+
+template<class B, class F, class O, class R>
+template<class S1>
+void bi::ConditionalPF<B,F,O,R>::resample(Random& rng,
+    const ScheduleElement now, const ScheduleElement next, S1& s)
+        throw (ParticleFilterDegeneratedException) {
+  if (!conditional) {
+    BootstrapPF<B,F,O,R>::resample(rng, now, s);
+  } else {
+    bool r = (now.isObserved() || now.hasBridge())
+        && s.ess < this->resam.getEssRel() * s.size();
+    if (r) {
+      typename precompute_type<MultinomialResampler,S1::location>::type pre;
+      typename S1::temp_int_vector_type as1(s.size());
+      int a = 0;
+
+      if (ancestorSampling) {
+        typename S1::temp_weight_vector_type lws(s.size());
+        lws = s.logWeights();
+        ancestorLogWeights(next, s, lws);
+        a = rng.multinomial(lws);
+      }
+      /* ancestors are i.i.d., so fixing that of the reference leaves the
+       * rest with their conditional distribution; not so once permuted */
+      multi.precompute(s.logWeights(), pre);
+      multi.ancestors(rng, s.logWeights(), as1, pre);
+      *as1.begin() = a;
+
+      s.gather(now, as1);
+      set_elements(s.logWeights(), s.logLikelihood);
+    } else if (now.hasOutput()) {
+      seq_elements(s.ancestors(), 0);
+    }
+  }
+}
+
+template<class B, class F, class O, class R>
+template<class S1, class V1>
+void bi::ConditionalPF<B,F,O,R>::ancestorLogWeights(
+    const ScheduleElement next, S1& s, V1 lws) {
+  /* pre-condition */
+  BI_ASSERT(next.hasOutput());
+
+  typedef typename loc_temp_matrix<S1::location,real>::type matrix_type;
+
+  /* the log-density leaves the query point in the state, so restore it */
+  matrix_type X(s.size(), B::NR + B::ND);
+  X = s.getDyn();
+
+  if (next.hasInput()) {
+    this->in.update(next.indexInput(), s);
+  }
+  if (next.hasObs()) {
+    this->obs.update(next.indexObs(), s);
+  }
+  set_rows(s.get(RY_VAR), subrange(column(s.path, next.indexOutput()), 0,
+      B::NR));
+  set_rows(s.get(DY_VAR), subrange(column(s.path, next.indexOutput()),
+      B::NR, B::ND));
+  this->m.transitionLogDensities(next.getFrom(), next.getTo(),
+      next.hasDelta(), s, lws);
+
+  s.getDyn() = X;
+}
+
+template<class B, class F, class O, class R>
+template<class S1>
+void bi::ConditionalPF<B,F,O,R>::setReference(const int k, S1& s,
+    const bool alt) {
+  /* pre-condition */
+  BI_ASSERT(k >= 0 && k < s.path.size2());
+
+  if (alt) {
+    row(s.get(RY_VAR), 0) = subrange(column(s.path, k), 0, B::NR);
+    row(s.get(DY_VAR), 0) = subrange(column(s.path, k), B::NR, B::ND);
+  } else {
+    row(s.getDyn(), 0) = column(s.path, k);
+  }
+}
+
+#endif
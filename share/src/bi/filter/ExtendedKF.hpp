@@ -13,7 +13,11 @@
 #include "../misc/location.hpp"
 #include "../misc/exception.hpp"
 
+#include <vector>
+
 namespace bi {
+template<class F> class Filter;
+
 /**
  * Extended Kalman filter.
  *
@@ -22,6 +26,13 @@ namespace bi {
  * @tparam B Model type.
  * @tparam F Forcer type.
  * @tparam O Observer type.
+ *
+ * Besides filtering a single state, the filter can advance a batch of
+ * states together, e.g. one for each \f$\theta\f$-particle of SMC^2. The
+ * model is simulated for each state in turn, but the dense linear algebra
+ * of the prediction and correction, which dominates the cost as the state
+ * size grows, is performed for all states at once, on multi-matrices laid
+ * out for the batched kernels of @ref math_multi_op.
  */
 template<class B, class F, class O>
 class ExtendedKF: public Simulator<B,F,O> {
@@ -85,13 +96,95 @@ public:
    * @param[in,out] s State.
    *
    * @return Incremental log-likelihood.
+   *
+   * When the observation noise of the active observations is uncorrelated,
+   * and the state is on the host, the observations are conditioned on one
+   * at a time, at \f$O(WM^2)\f$ cost for \f$W\f$ active observations,
+   * rather than jointly at \f$O(W^3)\f$ cost.
    */
   template<class S1>
   void correct(Random& rng, const ScheduleElement now, S1& s)
       throw (CholeskyException);
   //@}
 
+  /**
+   * @name Batch interface
+   *
+   * As for the high- and low-level interfaces, but for a batch of states,
+   * each with its own parameters, that share a time schedule.
+   */
+  //@{
+  /**
+   * @copydoc step()
+   *
+   * @param ss States.
+   * @param outs Output buffers, one for each state.
+   */
+  template<class S1, class IO1>
+  void step(Random& rng, ScheduleIterator& iter, const ScheduleIterator last,
+      std::vector<S1*>& ss, std::vector<IO1*>& outs)
+      throw (CholeskyException);
+
+  /**
+   * @copydoc predict()
+   *
+   * @param[in,out] ss States.
+   */
+  template<class S1>
+  void predict(Random& rng, const ScheduleElement next,
+      std::vector<S1*>& ss) throw (CholeskyException);
+
+  /**
+   * @copydoc correct()
+   *
+   * @param[in,out] ss States.
+   */
+  template<class S1>
+  void correct(Random& rng, const ScheduleElement now,
+      std::vector<S1*>& ss) throw (CholeskyException);
+  //@}
+
 protected:
+  /**
+   * Construct projection from mask of observations.
+   *
+   * @tparam V1 Integer vector type.
+   *
+   * @param now Current step in time schedule.
+   * @param[out] map Indices of active observations.
+   */
+  template<class V1>
+  void project(const ScheduleElement now, V1 map);
+
+  /**
+   * Can observations be conditioned on one at a time?
+   *
+   * @tparam S1 State type.
+   * @tparam V1 Integer vector type.
+   *
+   * @param s State.
+   * @param map Indices of active observations.
+   *
+   * @return True if the observation noise of the active observations is
+   * uncorrelated, false otherwise.
+   */
+  template<class S1, class V1>
+  bool isSequential(S1& s, const V1 map);
+
+  /**
+   * Correct prediction with observations, one at a time.
+   *
+   * @tparam S1 State type.
+   * @tparam V1 Integer vector type.
+   *
+   * @param now Current step in time schedule.
+   * @param[in,out] s State, after observe().
+   * @param map Indices of active observations.
+   */
+  template<class S1, class V1>
+  void correctSequential(const ScheduleElement now, S1& s, const V1 map)
+      throw (CholeskyException);
+
   /*
    * Sizes for convenience.
    */
@@ -100,6 +193,19 @@ protected:
   static const int NO = B::NO;
   static const int M = NR + ND;
 };
+
+/**
+ * Take one step of an extended Kalman filter for each of a batch of
+ * states.
+ *
+ * @ingroup method_filter
+ *
+ * @see step_batch()
+ */
+template<class B, class F, class O, class S1, class IO1>
+void step_batch(Filter<ExtendedKF<B,F,O> >& filter, Random& rng,
+    ScheduleIterator& iter, const ScheduleIterator last,
+    std::vector<S1*>& ss, std::vector<IO1*>& outs);
 }
 
 #include "../math/view.hpp"
@@ -108,6 +214,7 @@ protected:
 #include "../math/constant.hpp"
 #include "../math/loc_temp_vector.hpp"
 #include "../math/loc_temp_matrix.hpp"
+#include "../math/multi_operation.hpp"
 
 template<class B, class F, class O>
 bi::ExtendedKF<B,F,O>::ExtendedKF(B& m, F& in, O& obs) :
@@ -229,19 +336,11 @@ void bi::ExtendedKF<B,F,O>::correct(Random& rng, const ScheduleElement now,
     int_vector_type map(W);
 
     /* construct projection from mask */
-    Var* var;
-    int id, start = 0, size;
-    for (id = 0; id < this->m.getNumVars(O_VAR); ++id) {
-      var = this->m.getVar(O_VAR, id);
-      size = mask.getSize(id);
-
-      if (mask.isSparse(id)) {
-        addscal_elements(mask.getIndices(id), var->getStart(),
-            subrange(map, start, size));
-      } else {
-        seq_elements(subrange(map, start, size), var->getStart());
-      }
-      start += size;
+    project(now, map);
+
+    if (S1::location == ON_HOST && isSequential(s, map)) {
+      correctSequential(now, s, map);
+      return;
     }
 
     /* project matrices and vectors to active variables in mask */
@@ -261,8 +360,8 @@ void bi::ExtendedKF<B,F,O>::correct(Random& rng, const ScheduleElement now,
     /* update marginal log-likelihood */
     ///@todo Duplicates some operations in condition() calls below
     sub_elements(y, mu3, z);
-    trsv(U3, z, 'U');
-    s.logLikelihood += -0.5 * dot(z) - BI_HALF_LOG_TWO_PI
+    trsv(U3, z, 'U', 'T');
+    s.logLikelihood += -0.5 * dot(z) - W*BI_HALF_LOG_TWO_PI
         - bi::log(prod_reduce(diagonal(U3)));
 
     if (now.indexTime() > 0) {
@@ -279,4 +378,287 @@ void bi::ExtendedKF<B,F,O>::correct(Random& rng, const ScheduleElement now,
   }
 }
 
+template<class B, class F, class O>
+template<class S1, class IO1>
+void bi::ExtendedKF<B,F,O>::step(Random& rng, ScheduleIterator& iter,
+    const ScheduleIterator last, std::vector<S1*>& ss,
+    std::vector<IO1*>& outs) throw (CholeskyException) {
+  /* pre-condition */
+  BI_ASSERT(ss.size() == outs.size());
+
+  int b;
+  do {
+    ++iter;
+    this->predict(rng, *iter, ss);
+    this->correct(rng, *iter, ss);
+    for (b = 0; b < (int)ss.size(); ++b) {
+      this->output(*iter, *ss[b], *outs[b]);
+    }
+  } while (iter + 1 != last && !iter->isObserved());
+}
+
+template<class B, class F, class O>
+template<class S1>
+void bi::ExtendedKF<B,F,O>::predict(Random& rng, const ScheduleElement next,
+    std::vector<S1*>& ss) throw (CholeskyException) {
+  typedef typename loc_temp_matrix<S1::location,real>::type matrix_type;
+
+  const int P = ss.size();
+  int p;
+
+  /* predict, gathering Jacobians and factors into multi-matrices */
+  matrix_type Fs(P*M, M), Qs(P*M, M), U1s(P*M, M), U2s(P*M, M), Cs(P*M, M);
+  for (p = 0; p < P; ++p) {
+    S1& s = *ss[p];
+
+    Simulator<B,F,O>::predict(rng, next, s);
+    s.mu1 = row(s.getDyn(), 0);
+
+    multi_set_matrix(P, Fs, p, s.F());
+    multi_set_matrix(P, Qs, p, s.Q());
+    multi_set_matrix(P, U2s, p, s.U2);
+  }
+
+  /* across-time block of square-root covariance */
+  columns(Cs, 0, NR).clear();
+  subrange(Cs, 0, P*NR, NR, ND).clear();
+  subrange(Cs, P*NR, P*ND, NR, ND) = subrange(Fs, P*NR, P*ND, NR, ND);
+  multi_trmm(P, 1.0, U2s, Cs);
+
+  /* current-time block of square-root covariance */
+  rows(U1s, P*NR, P*ND).clear();
+  subrange(U1s, 0, P*NR, 0, NR) = subrange(Qs, 0, P*NR, 0, NR);
+  subrange(U1s, 0, P*NR, NR, ND) = subrange(Fs, 0, P*NR, NR, ND);
+  multi_trmm(P, 1.0, subrange(U1s, 0, P*NR, 0, NR),
+      subrange(U1s, 0, P*NR, NR, ND));
+
+  /* predicted covariance */
+  matrix_type Sigmas(P*M, M);
+  Sigmas.clear();
+  multi_syrk(P, 1.0, Cs, 0.0, Sigmas, 'U', 'T');
+  multi_syrk(P, 1.0, U1s, 1.0, Sigmas, 'U', 'T');
+
+  /* across-time covariance */
+  multi_trmm(P, 1.0, U2s, Cs, 'L', 'U', 'T');
+
+  /* Cholesky factor of predicted covariance */
+  multi_chol(P, Sigmas, U1s);
+
+  for (p = 0; p < P; ++p) {
+    S1& s = *ss[p];
+
+    multi_get_matrix(P, U1s, p, s.U1);
+    multi_get_matrix(P, Cs, p, s.C);
+
+    /* reset Jacobian, as it has now been multiplied in */
+    ident(s.F());
+    s.Q().clear();
+  }
+}
+
+template<class B, class F, class O>
+template<class S1>
+void bi::ExtendedKF<B,F,O>::correct(Random& rng, const ScheduleElement now,
+    std::vector<S1*>& ss) throw (CholeskyException) {
+  typedef typename loc_temp_matrix<S1::location,real>::type matrix_type;
+  typedef typename loc_temp_vector<S1::location,real>::type vector_type;
+  typedef typename loc_temp_vector<S1::location,int>::type int_vector_type;
+
+  const int P = ss.size();
+  int p;
+
+  for (p = 0; p < P; ++p) {
+    ss[p]->mu2 = ss[p]->mu1;
+    ss[p]->U2 = ss[p]->U1;
+  }
+
+  if (now.isObserved() && P > 0) {
+    BOOST_AUTO(mask, this->obs.getMask(now.indexObs()));
+    const int W = mask.size();
+
+    matrix_type C(M, W), R3(W, W), U3(W, W);
+    matrix_type U1s(P*M, M), U2s(P*M, M), Cs(P*M, W), R3s(P*W, W),
+        U3s(P*W, W), Sigma3s(P*W, W);
+    vector_type mu2s(P*M), mu3s(P*W), zs(P*W), mu3(W), y(W);
+    int_vector_type map(W);
+
+    project(now, map);
+
+    /* observe, gathering projected matrices and vectors into
+     * multi-matrices and multi-vectors */
+    for (p = 0; p < P; ++p) {
+      S1& s = *ss[p];
+
+      this->observe(rng, s);
+
+      gather_columns(map, s.G(), C);
+      gather_matrix(map, map, s.R(), R3);
+      gather(map, row(s.get(O_VAR), 0), mu3);
+
+      multi_set_matrix(P, Cs, p, C);
+      multi_set_matrix(P, R3s, p, R3);
+      multi_set_vector(P, mu3s, p, mu3);
+      multi_set_matrix(P, U1s, p, s.U1);
+      multi_set_matrix(P, U2s, p, s.U2);
+      multi_set_vector(P, mu2s, p, s.mu2);
+    }
+
+    /* observations are common to all states */
+    gather(map, row(ss[0]->get(OY_VAR), 0), y);
+
+    multi_trmm(P, 1.0, U1s, Cs);
+
+    Sigma3s.clear();
+    multi_syrk(P, 1.0, Cs, 0.0, Sigma3s, 'U', 'T');
+    multi_syrk(P, 1.0, R3s, 1.0, Sigma3s, 'U', 'T');
+    multi_trmm(P, 1.0, U1s, Cs, 'L', 'U', 'T');
+    multi_chol(P, Sigma3s, U3s, 'U');
+
+    /* update marginal log-likelihoods */
+    set_rows(reshape(vector_as_column_matrix(zs), P, W), y);
+    axpy(-1.0, mu3s, zs);
+    multi_trsv(P, U3s, zs, 'U', 'T');
+
+    if (now.indexTime() > 0) {
+      multi_condition(P, mu2s, U2s, mu3s, U3s, Cs, y);
+    } else {
+      multi_condition(P, subrange(mu2s, P*NR, P*ND),
+          subrange(U2s, P*NR, P*ND, NR, ND), mu3s, U3s, rows(Cs, P*NR, P*ND),
+          y);
+    }
+
+    for (p = 0; p < P; ++p) {
+      S1& s = *ss[p];
+
+      multi_get_vector(P, zs, p, mu3);
+      multi_get_matrix(P, U3s, p, U3);
+      s.logLikelihood += -0.5 * dot(mu3) - W*BI_HALF_LOG_TWO_PI
+          - bi::log(prod_reduce(diagonal(U3)));
+
+      multi_get_vector(P, mu2s, p, s.mu2);
+      multi_get_matrix(P, U2s, p, s.U2);
+      row(s.getDyn(), 0) = s.mu2;
+
+      /* reset Jacobian */
+      s.G().clear();
+      s.R().clear();
+    }
+  }
+}
+
+template<class B, class F, class O>
+template<class V1>
+void bi::ExtendedKF<B,F,O>::project(const ScheduleElement now, V1 map) {
+  BOOST_AUTO(mask, this->obs.getMask(now.indexObs()));
+
+  /* pre-condition */
+  BI_ASSERT(map.size() == mask.size());
+
+  Var* var;
+  int id, start = 0, size;
+  for (id = 0; id < this->m.getNumVars(O_VAR); ++id) {
+    var = this->m.getVar(O_VAR, id);
+    size = mask.getSize(id);
+
+    if (mask.isSparse(id)) {
+      addscal_elements(mask.getIndices(id), var->getStart(),
+          subrange(map, start, size));
+    } else {
+      seq_elements(subrange(map, start, size), var->getStart());
+    }
+    start += size;
+  }
+}
+
+template<class B, class F, class O>
+template<class S1, class V1>
+bool bi::ExtendedKF<B,F,O>::isSequential(S1& s, const V1 map) {
+  BOOST_AUTO(R, s.R());
+  int i, j;
+
+  for (j = 0; j < map.size(); ++j) {
+    for (i = 0; i < j; ++i) {
+      if (R(map(i), map(j)) != 0.0 || R(map(j), map(i)) != 0.0) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+template<class B, class F, class O>
+template<class S1, class V1>
+void bi::ExtendedKF<B,F,O>::correctSequential(const ScheduleElement now,
+    S1& s, const V1 map) throw (CholeskyException) {
+  typedef typename loc_temp_matrix<S1::location,real>::type matrix_type;
+  typedef typename loc_temp_vector<S1::location,real>::type vector_type;
+
+  /* at the first time, only d-vars are conditioned on the observations */
+  const int start = (now.indexTime() > 0) ? 0 : NR;
+  const int size = M - start;
+
+  BOOST_AUTO(mu2, subrange(s.mu2, start, size));
+  BOOST_AUTO(U2, subrange(s.U2, start, size, start, size));
+  BOOST_AUTO(mu3, row(s.get(O_VAR), 0));
+  BOOST_AUTO(y, row(s.get(OY_VAR), 0));
+
+  vector_type c(M), a(size), b(size);
+  real r, sigma, z;
+  int i, j;
+
+  for (i = 0; i < map.size(); ++i) {
+    j = map(i);
+    BOOST_AUTO(g, column(s.G(), j));
+
+    /* predicted observation, given observations conditioned on so far, the
+     * observation being linear in the state */
+    sub_elements(s.mu2, s.mu1, c);
+    z = y(j) - mu3(j) - dot(g, c);
+
+    /* innovation standard deviation */
+    c = g;
+    trmv(s.U2, c);
+    r = s.R()(j, j);
+    sigma = bi::sqrt(dot(c) + r*r);
+    z /= sigma;
+
+    /* update marginal log-likelihood */
+    s.logLikelihood += -0.5*z*z - BI_HALF_LOG_TWO_PI - bi::log(sigma);
+
+    /* cross-covariance, scaled to give the Cholesky downdate vector */
+    trmv(s.U2, c, 'U', 'T');
+    a = subrange(c, start, size);
+    scal(1.0/sigma, a);
+
+    /* update mean */
+    axpy(z, a, mu2);
+
+    /* update Cholesky factor of covariance */
+    try {
+      ch1dn(U2, a, b);
+    } catch (CholeskyException e) {
+      matrix_type Sigma(size, size);
+      a = subrange(c, start, size);
+      scal(1.0/sigma, a);
+
+      Sigma.clear();
+      syrk(1.0, U2, 0.0, Sigma, 'U', 'T');
+      syr(-1.0, a, Sigma, 'U');
+      chol(Sigma, U2, 'U');
+    }
+  }
+  row(s.getDyn(), 0) = s.mu2;
+
+  /* reset Jacobian */
+  s.G().clear();
+  s.R().clear();
+}
+
+template<class B, class F, class O, class S1, class IO1>
+void bi::step_batch(Filter<ExtendedKF<B,F,O> >& filter, Random& rng,
+    ScheduleIterator& iter, const ScheduleIterator last,
+    std::vector<S1*>& ss, std::vector<IO1*>& outs) {
+  filter.step(rng, iter, last, ss, outs);
+}
+
 #endif
@@ -13,6 +13,8 @@
 #include "../misc/TicToc.hpp"
 #include "../misc/macro.hpp"
 
+#include <vector>
+
 namespace bi {
 /**
  * Filter wrapper, buckles a common interface onto any filter.
@@ -52,7 +54,56 @@ public:
   void filter(Random& rng, const ScheduleIterator first,
       const ScheduleIterator last, S1& s, IO1& out, TicToc& clock,
       const long deadline);
+
+  /**
+   * %Filter, resuming from a state saved part way through the time
+   * schedule.
+   *
+   * @tparam S1 State type.
+   * @tparam IO1 Output type.
+   *
+   * @param[in,out] rng Random number generator.
+   * @param first Start of time schedule.
+   * @param now Position in time schedule of the saved state.
+   * @param last End of time schedule.
+   * @param[in,out] s State, as saved at @p now.
+   * @param[out] out Output buffer, holding the output of the previous run.
+   *
+   * The state has already been corrected and output at @p now, so this
+   * takes up with the step that follows. The times of outputs up to and
+   * including @p now are written to @p out again, so that it holds all
+   * times from the start of the schedule; other output of the previous
+   * run is left in place.
+   */
+  template<class S1, class IO1>
+  void resume(Random& rng, const ScheduleIterator first,
+      const ScheduleIterator now, const ScheduleIterator last, S1& s,
+      IO1& out);
 };
+
+/**
+ * Take one step of a filter for each of a batch of states.
+ *
+ * @ingroup method_filter
+ *
+ * @tparam F Filter type.
+ * @tparam S1 State type.
+ * @tparam IO1 Output type.
+ *
+ * @param filter Filter.
+ * @param[in,out] rng Random number generator.
+ * @param[in,out] iter Current position in time schedule. Advanced on return.
+ * @param last End of time schedule.
+ * @param[in,out] ss States.
+ * @param[out] outs Output buffers, one for each state.
+ *
+ * This generic version steps each state in turn. Filters that are able to
+ * process a batch of states together provide overloads.
+ */
+template<class F, class S1, class IO1>
+void step_batch(F& filter, Random& rng, ScheduleIterator& iter,
+    const ScheduleIterator last, std::vector<S1*>& ss,
+    std::vector<IO1*>& outs);
 }
 
 template<class F>
@@ -93,4 +144,43 @@ void bi::Filter<F>::filter(Random& rng, const ScheduleIterator first,
   }
 }
 
+template<class F>
+template<class S1, class IO1>
+void bi::Filter<F>::resume(Random& rng, const ScheduleIterator first,
+    const ScheduleIterator now, const ScheduleIterator last, S1& s,
+    IO1& out) {
+  /* pre-condition */
+  BI_ASSERT(first <= now && now < last);
+
+  TicToc clock;
+  ScheduleIterator iter;
+  for (iter = first; iter <= now; ++iter) {
+    if (iter->hasOutput()) {
+      out.writeTime(iter->indexOutput(), iter->getTime());
+    }
+  }
+  iter = now;
+  while (iter + 1 != last) {
+    this->step(rng, iter, last, s, out);
+  }
+  this->term(s);
+  s.clock = clock.toc();
+  this->outputT(s, out);
+}
+
+template<class F, class S1, class IO1>
+void bi::step_batch(F& filter, Random& rng, ScheduleIterator& iter,
+    const ScheduleIterator last, std::vector<S1*>& ss,
+    std::vector<IO1*>& outs) {
+  /* pre-condition */
+  BI_ASSERT(ss.size() == outs.size());
+
+  ScheduleIterator iter1 = iter;
+  for (int p = 0; p < (int)ss.size(); ++p) {
+    iter1 = iter;
+    filter.step(rng, iter1, last, *ss[p], *outs[p]);
+  }
+  iter = iter1;
+}
+
 #endif
@@ -13,6 +13,8 @@
 #include "LookaheadPF.hpp"
 #include "BridgePF.hpp"
 #include "AdaptivePF.hpp"
+#include "RaoBlackwellPF.hpp"
+#include "ConditionalPF.hpp"
 #include "ExtendedKF.hpp"
 
 namespace bi {
@@ -52,6 +54,20 @@ public:
       B& m, F& in, O& obs, R& resam, S2& stopper, const int initialP,
       const int blockP);
 
+  /**
+   * Create Rao-Blackwellised particle filter.
+   */
+  template<class B, class F, class O, class R>
+  static boost::shared_ptr<Filter<RaoBlackwellPF<B,F,O,R> > > createRaoBlackwellPF(
+      B& m, F& in, O& obs, R& resam, const std::vector<int>& marginals);
+
+  /**
+   * Create conditional particle filter.
+   */
+  template<class B, class F, class O, class R>
+  static boost::shared_ptr<Filter<ConditionalPF<B,F,O,R> > > createConditionalPF(
+      B& m, F& in, O& obs, R& resam, const bool ancestorSampling = true);
+
   /**
    * Create extended Kalman filter.
    */
@@ -90,6 +106,20 @@ boost::shared_ptr<bi::Filter<bi::AdaptivePF<B,F,O,R,S2> > > bi::FilterFactory::c
   return boost::shared_ptr<T>(new T(m, in, obs, resam, stopper, initialP, blockP));
 }
 
+template<class B, class F, class O, class R>
+boost::shared_ptr<bi::Filter<bi::RaoBlackwellPF<B,F,O,R> > > bi::FilterFactory::createRaoBlackwellPF(
+    B& m, F& in, O& obs, R& resam, const std::vector<int>& marginals) {
+  typedef Filter<RaoBlackwellPF<B,F,O,R> > T;
+  return boost::shared_ptr<T>(new T(m, in, obs, resam, marginals));
+}
+
+template<class B, class F, class O, class R>
+boost::shared_ptr<bi::Filter<bi::ConditionalPF<B,F,O,R> > > bi::FilterFactory::createConditionalPF(
+    B& m, F& in, O& obs, R& resam, const bool ancestorSampling) {
+  typedef Filter<ConditionalPF<B,F,O,R> > T;
+  return boost::shared_ptr<T>(new T(m, in, obs, resam, ancestorSampling));
+}
+
 template<class B, class F, class O>
 boost::shared_ptr<bi::Filter<bi::ExtendedKF<B,F,O> > > bi::FilterFactory::createExtendedKF(
     B& m, F& in, O& obs) {
@@ -0,0 +1,549 @@
+/**
+ * @file
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ */
+#ifndef BI_FILTER_RAOBLACKWELLPF_HPP
+#define BI_FILTER_RAOBLACKWELLPF_HPP
+
+#include "BootstrapPF.hpp"
+#include "../state/RaoBlackwellPFState.hpp"
+#include "../misc/exception.hpp"
+
+#include <vector>
+
+namespace bi {
+/**
+ * Rao-Blackwellised particle filter.
+ *
+ * @ingroup method_filter
+ *
+ * @tparam B Model type.
+ * @tparam F Forcer type.
+ * @tparam O Observer type.
+ * @tparam R Resampler type.
+ *
+ * Also known as the marginalised particle filter
+ * (@ref Schon2005 "Schön, Gustafsson & Nordlund, 2005") or mixture Kalman
+ * filter (@ref Chen2000 "Chen & Liu, 2000"). The state variables are
+ * partitioned into those that are sampled, as in BootstrapPF, and those
+ * that are marginalised. Each particle carries a Gaussian distribution over
+ * the marginalised and noise variables, conditioned on its sampled
+ * variables, which is updated with the prediction and correction of an
+ * extended Kalman filter. At each prediction, the sampled variables are
+ * drawn from their marginal under the predicted distribution, and the
+ * marginalised variables conditioned on them. At each correction, each
+ * particle is weighted by the predictive likelihood of the observations.
+ *
+ * The Kalman updates of all particles are performed together, on
+ * multi-matrices laid out for the batched kernels of @ref math_multi_op.
+ *
+ * Where the model is linear-Gaussian in the marginalised variables,
+ * conditioned on the sampled variables, the Gaussian distributions are
+ * exact, and the variance of the likelihood estimate is reduced relative to
+ * BootstrapPF. Otherwise they are a first-order approximation.
+ *
+ * The model must provide Jacobian terms, as for ExtendedKF. The observation
+ * means are computed for each particle in turn, so the state must be on
+ * host.
+ */
+template<class B, class F, class O, class R>
+class RaoBlackwellPF: public BootstrapPF<B,F,O,R> {
+public:
+  /**
+   * Constructor.
+   *
+   * @param m Model.
+   * @param in Forcer.
+   * @param obs Observer.
+   * @param resam Resampler.
+   * @param marginals Columns of the dynamic state that are marginalised.
+   * Columns of noise variables are always marginalised, so need not be
+   * given.
+   */
+  RaoBlackwellPF(B& m, F& in, O& obs, R& resam,
+      const std::vector<int>& marginals);
+
+  /**
+   * @name High-level interface
+   *
+   * An easier interface for common usage.
+   */
+  //@{
+  /**
+   * @copydoc BootstrapPF::step()
+   */
+  template<class S1, class IO1>
+  void step(Random& rng, ScheduleIterator& iter, const ScheduleIterator last,
+      S1& s, IO1& out) throw (CholeskyException);
+  //@}
+
+  /**
+   * @name Low-level interface
+   *
+   * Largely used by other features of the library or for finer control over
+   * performance and behaviour.
+   */
+  //@{
+  /**
+   * @copydoc Simulator::init()
+   */
+  template<class S1, class IO1, class IO2>
+  void init(Random& rng, const ScheduleElement now, S1& s, IO1& out,
+      IO2& inInit) throw (CholeskyException);
+
+  /**
+   * @copydoc ExtendedKF::predict()
+   */
+  template<class S1>
+  void predict(Random& rng, const ScheduleElement next, S1& s)
+      throw (CholeskyException);
+
+  /**
+   * @copydoc BootstrapPF::correct()
+   */
+  template<class S1>
+  void correct(Random& rng, const ScheduleElement now, S1& s)
+      throw (CholeskyException);
+  //@}
+
+protected:
+  /**
+   * Sample the sampled variables from their marginal, and condition the
+   * marginalised variables on them.
+   *
+   * @tparam S1 State type.
+   * @tparam M1 Matrix type.
+   *
+   * @param rng Random number generator.
+   * @param ks Columns of marginalised variables to condition.
+   * @param[in,out] s State. On input, holds the means of all variables, on
+   * output, the samples of the sampled variables, and the means and
+   * Cholesky factors of the marginalised variables.
+   * @param Sigmas Multi-matrix of covariance matrices of all variables,
+   * upper triangle only.
+   */
+  template<class S1, class M1>
+  void marginalise(Random& rng, const std::vector<int>& ks, S1& s,
+      const M1 Sigmas) throw (CholeskyException);
+
+  /**
+   * Construct projection from mask of observations.
+   *
+   * @param now Current step in time schedule.
+   * @param[out] map Indices of active observations.
+   */
+  void project(const ScheduleElement now, std::vector<int>& map);
+
+  /**
+   * Gather blocks of a multi-matrix.
+   *
+   * @tparam M1 Matrix type.
+   * @tparam M2 Matrix type.
+   *
+   * @param P Number of matrices.
+   * @param map1 Rows to gather.
+   * @param map2 Columns to gather.
+   * @param Xs Multi-matrix.
+   * @param[out] Ys Multi-matrix of gathered blocks.
+   *
+   * @p Xs is symmetric, with only its upper triangle used, if @p sym is
+   * true.
+   */
+  template<class M1, class M2>
+  static void multiGather(const int P, const std::vector<int>& map1,
+      const std::vector<int>& map2, const M1 Xs, M2 Ys,
+      const bool sym = false);
+
+  /**
+   * Scatter blocks of a multi-matrix.
+   *
+   * @tparam M1 Matrix type.
+   * @tparam M2 Matrix type.
+   *
+   * @param P Number of matrices.
+   * @param map1 Rows to scatter.
+   * @param map2 Columns to scatter.
+   * @param Xs Multi-matrix of blocks.
+   * @param[in,out] Ys Multi-matrix.
+   */
+  template<class M1, class M2>
+  static void multiScatter(const int P, const std::vector<int>& map1,
+      const std::vector<int>& map2, const M1 Xs, M2 Ys);
+
+  /**
+   * Reset Jacobian, once it has been multiplied in.
+   *
+   * @tparam S1 State type.
+   *
+   * @param[in,out] s State.
+   */
+  template<class S1>
+  static void resetJacobian(S1& s);
+
+  /**
+   * Columns of marginalised variables, including noise variables.
+   */
+  std::vector<int> ks;
+
+  /**
+   * Columns of marginalised variables, excluding noise variables.
+   */
+  std::vector<int> kds;
+
+  /**
+   * Columns of sampled variables.
+   */
+  std::vector<int> ss;
+
+  /*
+   * Sizes for convenience.
+   */
+  static const int NR = B::NR;
+  static const int ND = B::ND;
+  static const int NO = B::NO;
+  static const int M = NR + ND;
+};
+}
+
+#include "../math/view.hpp"
+#include "../math/operation.hpp"
+#include "../math/constant.hpp"
+#include "../math/loc_temp_vector.hpp"
+#include "../math/loc_temp_matrix.hpp"
+#include "../math/multi_operation.hpp"
+#include "../primitive/vector_primitive.hpp"
+
+#include <algorithm>
+
+template<class B, class F, class O, class R>
+bi::RaoBlackwellPF<B,F,O,R>::RaoBlackwellPF(B& m, F& in, O& obs, R& resam,
+    const std::vector<int>& marginals) :
+    BootstrapPF<B,F,O,R>(m, in, obs, resam) {
+  std::vector<bool> marginal(M, false);
+  int i;
+
+  for (i = 0; i < NR; ++i) {
+    marginal[i] = true;
+  }
+  for (i = 0; i < (int)marginals.size(); ++i) {
+    /* pre-condition */
+    BI_ASSERT(marginals[i] >= NR && marginals[i] < M);
+
+    marginal[marginals[i]] = true;
+  }
+  for (i = 0; i < M; ++i) {
+    if (marginal[i]) {
+      ks.push_back(i);
+      if (i >= NR) {
+        kds.push_back(i);
+      }
+    } else {
+      ss.push_back(i);
+    }
+  }
+}
+
+template<class B, class F, class O, class R>
+template<class S1, class IO1>
+void bi::RaoBlackwellPF<B,F,O,R>::step(Random& rng, ScheduleIterator& iter,
+    const ScheduleIterator last, S1& s, IO1& out) throw (CholeskyException) {
+  do {
+    this->resample(rng, *iter, s);
+    ++iter;
+    this->predict(rng, *iter, s);
+    this->correct(rng, *iter, s);
+    this->output(*iter, s, out);
+  } while (iter + 1 != last && !iter->isObserved());
+}
+
+template<class B, class F, class O, class R>
+template<class S1, class IO1, class IO2>
+void bi::RaoBlackwellPF<B,F,O,R>::init(Random& rng,
+    const ScheduleElement now, S1& s, IO1& out, IO2& inInit)
+        throw (CholeskyException) {
+  typedef typename loc_temp_matrix<S1::location,real>::type matrix_type;
+
+  Simulator<B,F,O>::init(rng, now, s, out, inInit);
+
+  const int P = s.size();
+  matrix_type Fs(P*M, M), Qs(P*M, M), Sigmas(P*M, M);
+  reshape(Fs, P, M*M) = s.F();
+  reshape(Qs, P, M*M) = s.Q();
+
+  /* square-root covariance of initial state, the noise term of each
+   * variable entering it with unit coefficient, and those initialised after
+   * it through the Jacobian */
+  for (int i = NR; i < M; ++i) {
+    set_elements(subrange(column(Fs, i), i*P, P), 1.0);
+  }
+  BOOST_AUTO(Fdds, subrange(Fs, P*NR, P*ND, NR, ND));
+  multi_trmm(P, 1.0, subrange(Qs, P*NR, P*ND, NR, ND), Fdds);
+
+  /* initial covariance, noise variables have none yet */
+  Sigmas.clear();
+  multi_syrk(P, 1.0, Fdds, 0.0, subrange(Sigmas, P*NR, P*ND, NR, ND), 'U',
+      'T');
+
+  marginalise(rng, kds, s, Sigmas);
+  resetJacobian(s);
+}
+
+template<class B, class F, class O, class R>
+template<class S1>
+void bi::RaoBlackwellPF<B,F,O,R>::predict(Random& rng,
+    const ScheduleElement next, S1& s) throw (CholeskyException) {
+  typedef typename loc_temp_matrix<S1::location,real>::type matrix_type;
+
+  /* predict means */
+  Simulator<B,F,O>::predict(rng, next, s);
+
+  /* gather Jacobians and factors into multi-matrices */
+  const int P = s.size();
+  matrix_type Fs(P*M, M), Qs(P*M, M), U1s(P*M, M), U2s(P*M, M), Cs(P*M, M);
+  reshape(Fs, P, M*M) = s.F();
+  reshape(Qs, P, M*M) = s.Q();
+  reshape(U2s, P, M*M) = s.factors();
+
+  /* across-time block of square-root covariance */
+  columns(Cs, 0, NR).clear();
+  subrange(Cs, 0, P*NR, NR, ND).clear();
+  subrange(Cs, P*NR, P*ND, NR, ND) = subrange(Fs, P*NR, P*ND, NR, ND);
+  multi_trmm(P, 1.0, U2s, Cs);
+
+  /* current-time block of square-root covariance, including the noise
+   * terms of state variables, through which the sampled variables are
+   * usually perturbed */
+  subrange(U1s, 0, P*NR, 0, NR) = subrange(Qs, 0, P*NR, 0, NR);
+  subrange(U1s, 0, P*NR, NR, ND) = subrange(Fs, 0, P*NR, NR, ND);
+  multi_trmm(P, 1.0, subrange(U1s, 0, P*NR, 0, NR),
+      subrange(U1s, 0, P*NR, NR, ND));
+  subrange(U1s, P*NR, P*ND, 0, NR).clear();
+  subrange(U1s, P*NR, P*ND, NR, ND) = subrange(Qs, P*NR, P*ND, NR, ND);
+
+  /* predicted covariance */
+  matrix_type Sigmas(P*M, M);
+  Sigmas.clear();
+  multi_syrk(P, 1.0, Cs, 0.0, Sigmas, 'U', 'T');
+  multi_syrk(P, 1.0, U1s, 1.0, Sigmas, 'U', 'T');
+
+  marginalise(rng, ks, s, Sigmas);
+  resetJacobian(s);
+}
+
+template<class B, class F, class O, class R>
+template<class S1>
+void bi::RaoBlackwellPF<B,F,O,R>::correct(Random& rng,
+    const ScheduleElement now, S1& s) throw (CholeskyException) {
+  typedef typename loc_temp_matrix<S1::location,real>::type matrix_type;
+  typedef typename loc_temp_vector<S1::location,real>::type vector_type;
+
+  if (now.isObserved()) {
+    BOOST_AUTO(mask, this->obs.getMask(now.indexObs()));
+
+    /* at the first time, only d-vars are conditioned on the observations */
+    const std::vector<int>& ks1 = (now.indexTime() > 0) ? ks : kds;
+    const int P = s.size();
+    const int W = mask.size();
+    const int MK = ks1.size();
+
+    matrix_type Gs(P*M, NO), Rs(P*NO, NO), Us(P*M, M), UKs(P*MK, MK),
+        Cs(P*MK, W), R3s(P*W, W), U3s(P*W, W), Sigma3s(P*W, W);
+    vector_type muKs(P*MK), mu3s(P*W), zs(P*W), y(W), ls(P), ls1(P);
+    std::vector<int> map(W);
+    int p, i;
+
+    project(now, map);
+
+    /* observation means are computed into a single row common to all
+     * particles, so observe each in turn */
+    BOOST_AUTO(o, row(s.get(O_VAR), 0));
+    for (p = 0; p < P; ++p) {
+      this->m.observationSample(rng, s, p);
+      for (i = 0; i < W; ++i) {
+        mu3s(i*P + p) = o(map[i]);
+      }
+    }
+    for (i = 0; i < W; ++i) {
+      y(i) = s.get(OY_VAR)(0, map[i]);
+    }
+
+    /* project matrices and vectors to active variables */
+    reshape(Gs, P, M*NO) = s.G();
+    reshape(Rs, P, NO*NO) = s.R();
+    reshape(Us, P, M*M) = s.factors();
+    multiGather(P, ks1, map, Gs, Cs);
+    multiGather(P, map, map, Rs, R3s);
+    multiGather(P, ks1, ks1, Us, UKs);
+    for (i = 0; i < MK; ++i) {
+      subrange(muKs, i*P, P) = column(s.getDyn(), ks1[i]);
+    }
+
+    multi_trmm(P, 1.0, UKs, Cs);
+
+    Sigma3s.clear();
+    multi_syrk(P, 1.0, Cs, 0.0, Sigma3s, 'U', 'T');
+    multi_syrk(P, 1.0, R3s, 1.0, Sigma3s, 'U', 'T');
+    multi_trmm(P, 1.0, UKs, Cs, 'L', 'U', 'T');
+    multi_chol(P, Sigma3s, U3s, 'U');
+
+    /* weight by predictive log-likelihoods */
+    set_rows(reshape(vector_as_column_matrix(zs), P, W), y);
+    axpy(-1.0, mu3s, zs);
+    multi_trsv(P, U3s, zs, 'U', 'T');
+
+    ls.clear();
+    for (i = 0; i < W; ++i) {
+      sq_elements(subrange(zs, i*P, P), ls1);
+      axpy(-0.5, ls1, ls);
+      log_elements(subrange(column(U3s, i), i*P, P), ls1);
+      axpy(-1.0, ls1, ls);
+    }
+    addscal_elements(ls, -W*BI_HALF_LOG_TWO_PI, ls);
+    add_elements(s.logWeights(), ls, s.logWeights());
+
+    double lW;
+    s.ess = this->resam.reduce(s.logWeights(), &lW);
+    s.logIncrements(now.indexObs()) = lW - s.logLikelihood;
+    s.logLikelihood = lW;
+
+    /* condition marginalised variables */
+    multi_condition(P, muKs, UKs, mu3s, U3s, Cs, y);
+    for (i = 0; i < MK; ++i) {
+      column(s.getDyn(), ks1[i]) = subrange(muKs, i*P, P);
+    }
+    multiScatter(P, ks1, ks1, UKs, Us);
+    s.factors() = reshape(Us, P, M*M);
+
+    /* reset Jacobian */
+    s.G().clear();
+    s.R().clear();
+  }
+}
+
+template<class B, class F, class O, class R>
+template<class S1, class M1>
+void bi::RaoBlackwellPF<B,F,O,R>::marginalise(Random& rng,
+    const std::vector<int>& ks, S1& s, const M1 Sigmas)
+        throw (CholeskyException) {
+  typedef typename loc_temp_matrix<S1::location,real>::type matrix_type;
+  typedef typename loc_temp_vector<S1::location,real>::type vector_type;
+
+  const int P = s.size();
+  const int MK = ks.size();
+  const int MS = ss.size();
+
+  matrix_type Us(P*M, M), SigmaKKs(P*MK, MK), UKs(P*MK, MK);
+  vector_type muKs(P*MK);
+  int i;
+
+  multiGather(P, ks, ks, Sigmas, SigmaKKs, true);
+  multi_chol(P, SigmaKKs, UKs);
+  for (i = 0; i < MK; ++i) {
+    subrange(muKs, i*P, P) = column(s.getDyn(), ks[i]);
+  }
+
+  if (MS > 0) {
+    matrix_type SigmaSSs(P*MS, MS), USs(P*MS, MS), SigmaKSs(P*MK, MS);
+    vector_type muSs(P*MS), xSs(P*MS);
+
+    multiGather(P, ss, ss, Sigmas, SigmaSSs, true);
+    multiGather(P, ks, ss, Sigmas, SigmaKSs, true);
+    multi_chol(P, SigmaSSs, USs);
+    for (i = 0; i < MS; ++i) {
+      subrange(muSs, i*P, P) = column(s.getDyn(), ss[i]);
+    }
+
+    /* sample sampled variables */
+    rng.gaussians(xSs);
+    multi_trmv(P, USs, xSs, 'U', 'T');
+    axpy(1.0, muSs, xSs);
+    for (i = 0; i < MS; ++i) {
+      column(s.getDyn(), ss[i]) = subrange(xSs, i*P, P);
+    }
+
+    /* condition marginalised variables on them */
+    multi_condition(P, muKs, UKs, muSs, USs, SigmaKSs, xSs);
+  }
+
+  for (i = 0; i < MK; ++i) {
+    column(s.getDyn(), ks[i]) = subrange(muKs, i*P, P);
+  }
+  Us.clear();
+  multiScatter(P, ks, ks, UKs, Us);
+  s.factors() = reshape(Us, P, M*M);
+}
+
+template<class B, class F, class O, class R>
+void bi::RaoBlackwellPF<B,F,O,R>::project(const ScheduleElement now,
+    std::vector<int>& map) {
+  BOOST_AUTO(mask, this->obs.getHostMask(now.indexObs()));
+
+  /* pre-condition */
+  BI_ASSERT((int)map.size() == mask.size());
+
+  Var* var;
+  int id, i, start = 0, size;
+  for (id = 0; id < this->m.getNumVars(O_VAR); ++id) {
+    var = this->m.getVar(O_VAR, id);
+    size = mask.getSize(id);
+    for (i = 0; i < size; ++i) {
+      map[start + i] = var->getStart() + mask.getIndex(id, i);
+    }
+    start += size;
+  }
+}
+
+template<class B, class F, class O, class R>
+template<class M1, class M2>
+void bi::RaoBlackwellPF<B,F,O,R>::multiGather(const int P,
+    const std::vector<int>& map1, const std::vector<int>& map2,
+    const M1 Xs, M2 Ys, const bool sym) {
+  /* pre-conditions */
+  BI_ASSERT(Ys.size1() == P*(int)map1.size());
+  BI_ASSERT(Ys.size2() == (int)map2.size());
+
+  int i, j, i1, j1;
+  for (j = 0; j < (int)map2.size(); ++j) {
+    for (i = 0; i < (int)map1.size(); ++i) {
+      i1 = map1[i];
+      j1 = map2[j];
+      if (sym && i1 > j1) {
+        std::swap(i1, j1);
+      }
+      subrange(column(Ys, j), i*P, P) = subrange(column(Xs, j1), i1*P, P);
+    }
+  }
+}
+
+template<class B, class F, class O, class R>
+template<class M1, class M2>
+void bi::RaoBlackwellPF<B,F,O,R>::multiScatter(const int P,
+    const std::vector<int>& map1, const std::vector<int>& map2,
+    const M1 Xs, M2 Ys) {
+  /* pre-conditions */
+  BI_ASSERT(Xs.size1() == P*(int)map1.size());
+  BI_ASSERT(Xs.size2() == (int)map2.size());
+
+  int i, j;
+  for (j = 0; j < (int)map2.size(); ++j) {
+    for (i = 0; i < (int)map1.size(); ++i) {
+      subrange(column(Ys, map2[j]), map1[i]*P, P) = subrange(column(Xs, j),
+          i*P, P);
+    }
+  }
+}
+
+template<class B, class F, class O, class R>
+template<class S1>
+void bi::RaoBlackwellPF<B,F,O,R>::resetJacobian(S1& s) {
+  s.F().clear();
+  for (int i = 0; i < M; ++i) {
+    set_elements(column(s.F(), i*M + i), 1.0);
+  }
+  s.Q().clear();
+}
+
+#endif
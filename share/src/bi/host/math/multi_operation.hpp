@@ -60,6 +60,16 @@ struct multi_syrk_impl<ON_HOST,T1> {
       M2 Cs, const char uplo, const char trans);
 };
 
+/**
+ * @internal
+ */
+template<class T1>
+struct multi_trmv_impl<ON_HOST,T1> {
+  template<class M1, class V1>
+  static void func(const int P, const M1 A, V1 x, const char uplo,
+      const char transA);
+};
+
 /**
  * @internal
  */
@@ -100,10 +110,13 @@ template<class T1>
 template<class M1, class V1, class V2>
 void bi::multi_ch1dn_impl<bi::ON_HOST,T1>::func(const int P, M1 Us, V1 as, V2 bs)
     throw (CholeskyException) {
-  #pragma omp parallel
+  int nerrs = 0;
+
+  #pragma omp parallel reduction(+:nerrs)
   {
     typename sim_temp_matrix<M1>::type U(Us.size1()/P, Us.size2());
-    typename sim_temp_vector<V1>::type a(as.size()/P);
+    typename sim_temp_matrix<M1>::type Sigma(Us.size1()/P, Us.size2());
+    typename sim_temp_vector<V1>::type a(as.size()/P), a1(as.size()/P);
     typename sim_temp_vector<V2>::type b(as.size()/P);
     int p;
 
@@ -112,14 +125,32 @@ void bi::multi_ch1dn_impl<bi::ON_HOST,T1>::func(const int P, M1 Us, V1 as, V2 bs
       multi_get_matrix(P, Us, p, U);
       multi_get_vector(P, as, p, a);
       multi_get_vector(P, bs, p, b);
+      a1 = a;
 
-      ch1dn(U, a, b);
+      try {
+        ch1dn(U, a, b);
+      } catch (CholeskyException e) {
+        /* downdate failed, leaving U unchanged, so refactorise, as in
+         * condition(), noting that a has been overwritten */
+        try {
+          Sigma.clear();
+          syrk(1.0, U, 0.0, Sigma, 'U', 'T');
+          syrk(-1.0, vector_as_column_matrix(a1), 1.0, Sigma, 'U', 'N');
+          chol(Sigma, U, 'U');
+        } catch (CholeskyException e) {
+          ++nerrs;
+        }
+      }
 
       multi_set_matrix(P, Us, p, U);
       multi_set_vector(P, as, p, a);
       multi_set_vector(P, bs, p, b);
     }
   }
+
+  if (nerrs > 0) {
+    throw CholeskyException(0);
+  }
 }
 
 template<class T1>
@@ -217,6 +248,28 @@ void bi::multi_syrk_impl<bi::ON_HOST,T1>::func(const int P, const T1 alpha,
   }
 }
 
+template<class T1>
+template<class M1, class V1>
+void bi::multi_trmv_impl<bi::ON_HOST,T1>::func(const int P, const M1 As, V1 xs,
+    const char uplo, const char transA) {
+  #pragma omp parallel
+  {
+    typename sim_temp_matrix<M1>::type A(As.size1()/P, As.size2());
+    typename sim_temp_vector<V1>::type x(xs.size()/P);
+    int p;
+
+    #pragma omp for
+    for (p = 0; p < P; ++p) {
+      multi_get_matrix(P, As, p, A);
+      multi_get_vector(P, xs, p, x);
+
+      trmv(A, x, uplo, transA);
+
+      multi_set_vector(P, xs, p, x);
+    }
+  }
+}
+
 template<class T1>
 template<class M1, class V1>
 void bi::multi_trsv_impl<bi::ON_HOST,T1>::func(const int P, const M1 As, V1 xs,
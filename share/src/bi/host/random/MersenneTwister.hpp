@@ -0,0 +1,230 @@
+/**
+ * @file
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ */
+#ifndef BI_HOST_RANDOM_MERSENNETWISTER_HPP
+#define BI_HOST_RANDOM_MERSENNETWISTER_HPP
+
+#include "boost/cstdint.hpp"
+
+namespace bi {
+/**
+ * Mersenne Twister MT19937 engine, on host.
+ *
+ * @ingroup math_rng
+ *
+ * Produces the same sequence as @c boost::mt19937 for the same seed, and
+ * models the same engine concept, so that it may be used with the
+ * distributions of Boost.Random. In addition, generate() produces many
+ * variates at once, with loops over the state that the compiler is able
+ * to vectorise, for much greater throughput than repeated calls.
+ *
+ * See @ref Matsumoto1998 "Matsumoto & Nishimura (1998)".
+ */
+class MersenneTwister {
+public:
+  /**
+   * Variate type.
+   */
+  typedef boost::uint32_t result_type;
+
+  /**
+   * For Boost.Random.
+   */
+  static const bool has_fixed_range = false;
+
+  /**
+   * Number of words in the complete state of the engine, as given by
+   * getState(): the 624 words of the generator, and the position in them.
+   */
+  static const int STATE_SIZE = 625;
+
+  /**
+   * Constructor.
+   *
+   * @param seed Seed value.
+   */
+  MersenneTwister(const result_type seed = 5489u);
+
+  /**
+   * Seed.
+   *
+   * @param seed Seed value.
+   */
+  void seed(const result_type seed = 5489u);
+
+  /**
+   * Generate a variate.
+   */
+  result_type operator()();
+
+  /**
+   * Generate many variates.
+   *
+   * @param[out] x Array of variates.
+   * @param n Number of variates.
+   */
+  void generate(result_type* x, const int n);
+
+  /**
+   * Get the complete state of the engine, so that it may be saved and
+   * restored.
+   *
+   * @param[out] x Array of #STATE_SIZE words.
+   */
+  void getState(result_type* x) const;
+
+  /**
+   * Set the complete state of the engine.
+   *
+   * @param x Array of #STATE_SIZE words, as from getState().
+   */
+  void setState(const result_type* x);
+
+  /**
+   * Smallest variate.
+   */
+  static result_type min();
+
+  /**
+   * Largest variate.
+   */
+  static result_type max();
+
+private:
+  /**
+   * Regenerate the state.
+   */
+  void twist();
+
+  /**
+   * Transformation of state in twist().
+   */
+  static result_type twist(const result_type u, const result_type v,
+      const result_type w);
+
+  /**
+   * Tempering of state into variate.
+   */
+  static result_type temper(const result_type y);
+
+  /**
+   * Size of state.
+   */
+  static const int N = 624;
+
+  /**
+   * Shift of twist.
+   */
+  static const int M = 397;
+
+  /**
+   * State.
+   */
+  result_type state[N];
+
+  /**
+   * Position in state of next variate.
+   */
+  int i;
+};
+}
+
+#include "../../misc/assert.hpp"
+
+#include <algorithm>
+
+inline bi::MersenneTwister::MersenneTwister(const result_type seed) {
+  this->seed(seed);
+}
+
+inline void bi::MersenneTwister::seed(const result_type seed) {
+  state[0] = seed;
+  for (int j = 1; j < N; ++j) {
+    state[j] = 1812433253u*(state[j - 1] ^ (state[j - 1] >> 30)) + j;
+  }
+  i = N;
+}
+
+inline bi::MersenneTwister::result_type bi::MersenneTwister::operator()() {
+  if (i >= N) {
+    twist();
+  }
+  return temper(state[i++]);
+}
+
+inline void bi::MersenneTwister::generate(result_type* x, const int n) {
+  const result_type* y;
+  int m, j, k = 0;
+  while (k < n) {
+    if (i >= N) {
+      twist();
+    }
+    m = std::min(n - k, N - i);
+
+    /* local pointer, so that writes to x are not thought to alias i */
+    y = state + i;
+    for (j = 0; j < m; ++j) {
+      x[k + j] = temper(y[j]);
+    }
+    i += m;
+    k += m;
+  }
+}
+
+inline void bi::MersenneTwister::getState(result_type* x) const {
+  std::copy(state, state + N, x);
+  x[N] = static_cast<result_type>(i);
+}
+
+inline void bi::MersenneTwister::setState(const result_type* x) {
+  /* pre-condition */
+  BI_ASSERT(x[N] <= static_cast<result_type>(N));
+
+  std::copy(x, x + N, state);
+  i = static_cast<int>(x[N]);
+}
+
+inline bi::MersenneTwister::result_type bi::MersenneTwister::min() {
+  return 0u;
+}
+
+inline bi::MersenneTwister::result_type bi::MersenneTwister::max() {
+  return 0xffffffffu;
+}
+
+inline void bi::MersenneTwister::twist() {
+  int j;
+
+  /* each of these loops reads only elements that it has not yet written,
+   * or wrote at least N - M iterations earlier, so vectorises */
+  for (j = 0; j < N - M; ++j) {
+    state[j] = twist(state[j], state[j + 1], state[j + M]);
+  }
+  for (j = N - M; j < N - 1; ++j) {
+    state[j] = twist(state[j], state[j + 1], state[j + M - N]);
+  }
+  state[N - 1] = twist(state[N - 1], state[0], state[M - 1]);
+  i = 0;
+}
+
+inline bi::MersenneTwister::result_type bi::MersenneTwister::twist(
+    const result_type u, const result_type v, const result_type w) {
+  const result_type y = (u & 0x80000000u) | (v & 0x7fffffffu);
+  return w ^ (y >> 1) ^ ((0u - (y & 1u)) & 0x9908b0dfu);
+}
+
+inline bi::MersenneTwister::result_type bi::MersenneTwister::temper(
+    const result_type y) {
+  result_type z = y;
+  z ^= z >> 11;
+  z ^= (z << 7) & 0x9d2c5680u;
+  z ^= (z << 15) & 0xefc60000u;
+  z ^= z >> 18;
+  return z;
+}
+
+#endif
@@ -0,0 +1,194 @@
+/**
+ * @file
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ */
+#ifndef BI_HOST_RANDOM_NOISETAPEHOST_HPP
+#define BI_HOST_RANDOM_NOISETAPEHOST_HPP
+
+#include "RngHost.hpp"
+#include "../../math/scalar.hpp"
+
+#include <vector>
+
+namespace bi {
+/**
+ * Pre-generated noise, on host.
+ *
+ * @ingroup math_rng
+ *
+ * Wraps the base pseudorandom number generator of a thread, and serves
+ * standard Gaussian and uniform variates from tapes filled in bulk by
+ * fill(), so that their generation is kept out of the inner loops of
+ * updaters. Once a tape is exhausted, variates are drawn from the base
+ * generator as usual, so that the tapes need only be sized for the
+ * variates drawn by direct simulation; those drawn by rejection samplers,
+ * in number unknown in advance, may come from either.
+ *
+ * All other distributions are forwarded to the base generator. The
+ * interface is that of RngHost, so that it may be used in its place as the
+ * generator passed to actions.
+ */
+class NoiseTapeHost {
+public:
+  /**
+   * Constructor.
+   *
+   * @param rng Base pseudorandom number generator.
+   */
+  NoiseTapeHost(RngHost& rng);
+
+  /**
+   * Fill tapes.
+   *
+   * @param G Number of standard Gaussian variates.
+   * @param U Number of standard uniform variates.
+   *
+   * Any variates remaining on the tapes are discarded.
+   */
+  void fill(const int G, const int U);
+
+  /**
+   * @copydoc Random::uniformInt
+   */
+  template<class T1>
+  T1 uniformInt(const T1 lower = 0, const T1 upper = 1);
+
+  /**
+   * @copydoc Random::multinomial
+   */
+  template<class V1>
+  typename V1::difference_type multinomial(const V1 lps);
+
+  /**
+   * @copydoc Random::uniform
+   */
+  template<class T1>
+  T1 uniform(const T1 lower = 0.0, const T1 upper = 1.0);
+
+  /**
+   * @copydoc Random::gaussian
+   */
+  template<class T1>
+  T1 gaussian(const T1 mu = 0.0, const T1 sigma = 1.0);
+
+  /**
+   * @copydoc Random::gamma
+   */
+  template<class T1>
+  T1 gamma(const T1 alpha = 1.0, const T1 beta = 1.0);
+
+  /**
+   * @copydoc Random::poisson
+   */
+  template<class T1>
+  T1 poisson(const T1 lambda = 1.0);
+
+  /**
+   * @copydoc Random::binomial
+   */
+  template<class T1, class T2>
+  T1 binomial(const T1 n = 1.0, const T2 p = 0.5);
+
+private:
+  /**
+   * Base pseudorandom number generator.
+   */
+  RngHost& rng;
+
+  /**
+   * Tape of standard Gaussian variates.
+   */
+  std::vector<real> gaussians;
+
+  /**
+   * Tape of standard uniform variates.
+   */
+  std::vector<real> uniforms;
+
+  /**
+   * Position on Gaussian tape.
+   */
+  int g;
+
+  /**
+   * Position on uniform tape.
+   */
+  int u;
+};
+}
+
+inline bi::NoiseTapeHost::NoiseTapeHost(RngHost& rng) :
+    rng(rng), g(0), u(0) {
+  //
+}
+
+inline void bi::NoiseTapeHost::fill(const int G, const int U) {
+  /* pre-condition */
+  BI_ASSERT(G >= 0 && U >= 0);
+
+  gaussians.resize(G);
+  uniforms.resize(U);
+  g = 0;
+  u = 0;
+  if (G > 0) {
+    rng.gaussians(&gaussians[0], G);
+  }
+  if (U > 0) {
+    rng.uniforms(&uniforms[0], U);
+  }
+}
+
+template<class T1>
+inline T1 bi::NoiseTapeHost::uniformInt(const T1 lower, const T1 upper) {
+  return rng.uniformInt(lower, upper);
+}
+
+template<class V1>
+inline typename V1::difference_type bi::NoiseTapeHost::multinomial(
+    const V1 lps) {
+  return rng.multinomial(lps);
+}
+
+template<class T1>
+inline T1 bi::NoiseTapeHost::uniform(const T1 lower, const T1 upper) {
+  /* pre-condition */
+  BI_ASSERT(upper >= lower);
+
+  if (u < static_cast<int>(uniforms.size())) {
+    return lower + (upper - lower)*static_cast<T1>(uniforms[u++]);
+  } else {
+    return rng.uniform(lower, upper);
+  }
+}
+
+template<class T1>
+inline T1 bi::NoiseTapeHost::gaussian(const T1 mu, const T1 sigma) {
+  /* pre-condition */
+  BI_ASSERT(sigma >= 0.0);
+
+  if (g < static_cast<int>(gaussians.size())) {
+    return mu + sigma*static_cast<T1>(gaussians[g++]);
+  } else {
+    return rng.gaussian(mu, sigma);
+  }
+}
+
+template<class T1>
+inline T1 bi::NoiseTapeHost::gamma(const T1 alpha, const T1 beta) {
+  return rng.gamma(alpha, beta);
+}
+
+template<class T1>
+inline T1 bi::NoiseTapeHost::poisson(const T1 lambda) {
+  return bi::poisson(*this, lambda);
+}
+
+template<class T1, class T2>
+inline T1 bi::NoiseTapeHost::binomial(const T1 n, const T2 p) {
+  return bi::binomial(*this, n, p);
+}
+
+#endif
@@ -49,16 +49,14 @@ struct RandomHost {
   /**
    * @copydoc Random::poissons
    */
-  template<class V1>
-  static void poissons(Random& rng, V1 x, const typename V1::value_type lambda =
-                     1.0);
+  template<class V1, class V2>
+  static void poissons(Random& rng, const V1 lambdas, V2 x);
 
   /**
    * @copydoc Random::binomials
    */
-  template<class V1, class V2>
-  static void binomials(Random& rng, V1 x, const typename V1::value_type n =
-                        1.0, const typename V2::value_type p = 0.5);
+  template<class V1, class V2, class V3>
+  static void binomials(Random& rng, const V1 ns, const V2 ps, V3 x);
 
   /**
    * @copydoc Random::betas
@@ -76,6 +74,7 @@ struct RandomHost {
 }
 
 #include "../../random/Random.hpp"
+#include "../../math/temp_vector.hpp"
 
 template<class V1>
 void bi::RandomHost::uniforms(Random& rng, V1 x,
@@ -85,21 +84,16 @@ void bi::RandomHost::uniforms(Random& rng, V1 x,
   BI_ASSERT(upper >= lower);
 
   typedef typename V1::value_type T1;
-  typedef boost::uniform_real<T1> dist_type;
 
-  //#pragma omp parallel
-  //{
-    RngHost& rng1 = rng.getHostRng();
-    int j;
-
-    dist_type dist(lower, upper);
-    boost::variate_generator<RngHost::rng_type&, dist_type> gen(rng1.rng, dist);
+  RngHost& rng1 = rng.getHostRng();
+  typename temp_host_vector<T1>::type z(x.size());
+  int j;
 
-    //#pragma omp for
-    for (j = 0; j < x.size(); ++j) {
-      x(j) = gen();
-    }
-    //}
+  /* standard variates in bulk, then transform */
+  rng1.uniforms(z.buf(), z.size());
+  for (j = 0; j < x.size(); ++j) {
+    x(j) = lower + (upper - lower)*z(j);
+  }
 }
 
 template<class V1>
@@ -109,21 +103,16 @@ void bi::RandomHost::gaussians(Random& rng, V1 x,
   BI_ASSERT(sigma >= 0.0);
 
   typedef typename V1::value_type T1;
-  typedef boost::normal_distribution<T1> dist_type;
 
-  //#pragma omp parallel
-  //{
-    RngHost& rng1 = rng.getHostRng();
-    int j;
-
-    dist_type dist(mu, sigma);
-    boost::variate_generator<RngHost::rng_type&, dist_type> gen(rng1.rng, dist);
+  RngHost& rng1 = rng.getHostRng();
+  typename temp_host_vector<T1>::type z(x.size());
+  int j;
 
-    //#pragma omp for schedule(static)
-    for (j = 0; j < x.size(); ++j) {
-      x(j) = gen();
-    }
-  //}
+  /* standard variates in bulk, then transform */
+  rng1.gaussians(z.buf(), z.size());
+  for (j = 0; j < x.size(); ++j) {
+    x(j) = mu + sigma*z(j);
+  }
 }
 
 template<class V1>
@@ -132,22 +121,32 @@ void bi::RandomHost::gammas(Random& rng, V1 x,
   /* pre-condition */
   BI_ASSERT(alpha > 0.0 && beta > 0.0);
 
-  typedef typename V1::value_type T1;
-  typedef boost::gamma_distribution<T1> dist_type;
+  RngHost& rng1 = rng.getHostRng();
+  int j;
+
+  for (j = 0; j < x.size(); ++j) {
+    x(j) = rng1.gamma(alpha, beta);
+  }
+}
+
+template<class V1, class V2>
+void bi::RandomHost::poissons(Random& rng, const V1 lambdas, V2 x) {
+  RngHost& rng1 = rng.getHostRng();
+  int j;
 
-  //#pragma omp parallel
-  //{
-    RngHost& rng1 = rng.getHostRng();
-    int j;
+  for (j = 0; j < x.size(); ++j) {
+    x(j) = rng1.poisson(lambdas(j));
+  }
+}
 
-    dist_type dist(alpha);
-    boost::variate_generator<RngHost::rng_type&, dist_type> gen(rng1.rng, dist);
+template<class V1, class V2, class V3>
+void bi::RandomHost::binomials(Random& rng, const V1 ns, const V2 ps, V3 x) {
+  RngHost& rng1 = rng.getHostRng();
+  int j;
 
-    //#pragma omp for schedule(static)
-    for (j = 0; j < x.size(); ++j) {
-      x(j) = beta*gen();
-    }
-    //}
+  for (j = 0; j < x.size(); ++j) {
+    x(j) = rng1.binomial(ns(j), ps(j));
+  }
 }
 
 template<class V1>
@@ -157,25 +156,17 @@ void bi::RandomHost::betas(Random& rng, V1 x,
   BI_ASSERT(alpha > 0.0 && beta > 0.0);
 
   typedef typename V1::value_type T1;
-  typedef boost::gamma_distribution<T1> dist_type;
 
-  //#pragma omp parallel
-  //{
-    RngHost& rng1 = rng.getHostRng();
-    int j;
-
-    dist_type dist1(alpha), dist2(beta);
-    boost::variate_generator<RngHost::rng_type&, dist_type> gen1(rng1.rng, dist1), gen2(rng1.rng, dist2);
-    T1 y1, y2;
+  RngHost& rng1 = rng.getHostRng();
+  T1 y1, y2;
+  int j;
 
-    //#pragma omp for schedule(static)
-    for (j = 0; j < x.size(); ++j) {
-      y1 = gen1();
-      y2 = gen2();
+  for (j = 0; j < x.size(); ++j) {
+    y1 = rng1.gamma(alpha, static_cast<T1>(1.0));
+    y2 = rng1.gamma(beta, static_cast<T1>(1.0));
 
-      x(j) = y1/(y1 + y2);
-    }
-    //}
+    x(j) = y1/(y1 + y2);
+  }
 }
 
 template<class V1, class V2>
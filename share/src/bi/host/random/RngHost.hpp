@@ -8,7 +8,9 @@
 #ifndef BI_HOST_RANDOM_RNG_HPP
 #define BI_HOST_RANDOM_RNG_HPP
 
-#include "boost/random/mersenne_twister.hpp"
+#include "MersenneTwister.hpp"
+
+#include <vector>
 
 namespace bi {
 /**
@@ -17,7 +19,19 @@ namespace bi {
  * @ingroup math_rng
  *
  * Uses the Mersenne Twister algorithm for generating pseudorandom variates,
- * as implemented in Boost.Random.
+ * with the distributions of Boost.Random, other than for the bulk
+ * generation of gaussians() and uniforms().
+ *
+ * While startReplay() is in effect, variates are instead computed from a
+ * tape of standard Gaussian auxiliary variables, one or more for each
+ * variate, so that they are a deterministic function of the tape: Gaussian
+ * variates are transformed from them directly, uniform variates by the
+ * Gaussian cumulative distribution function, and other distributions by
+ * methods built on these, with gamma variates by
+ * @ref Marsaglia2000b "Marsaglia & Tsang (2000)". A small change to the
+ * tape then gives a small change to most variates, which is the basis of
+ * correlated pseudo-marginal methods. The engine is used only to extend
+ * the tape when exhausted.
  *
  * @section RngHost_references References
  *
@@ -25,9 +39,18 @@ namespace bi {
  * T. Mersenne Twister: A 623-dimensionally equidistributed
  * uniform pseudorandom number generator. <i>ACM Transactions on
  * Modeling and Computer Simulation</i>, <b>1998</b>, 8, 3-30.
+ *
+ * @anchor Marsaglia2000b Marsaglia, G. and Tsang, W. W. A simple method for
+ * generating gamma variables. <i>ACM Transactions on Mathematical
+ * Software</i>, <b>2000</b>, 26, 363-372.
  */
 class RngHost {
 public:
+  /**
+   * Constructor.
+   */
+  RngHost();
+
   /**
    * Seed random number generator.
    *
@@ -77,31 +100,126 @@ public:
   template<class T1, class T2>
   T1 binomial(const T1 n = 1.0, const T2 p = 0.5);
 
+  /**
+   * Generate many standard Gaussian variates.
+   *
+   * @tparam T1 Scalar type.
+   *
+   * @param[out] x Array of variates.
+   * @param n Number of variates.
+   *
+   * Uses the ziggurat method on variates of the engine generated in bulk,
+   * with two engine variates for each in double precision, one in single.
+   */
+  template<class T1>
+  void gaussians(T1* x, const int n);
+
+  /**
+   * Generate many standard uniform variates, on \f$[0,1)\f$.
+   *
+   * @tparam T1 Scalar type.
+   *
+   * @param[out] x Array of variates.
+   * @param n Number of variates.
+   */
+  template<class T1>
+  void uniforms(T1* x, const int n);
+
+  /**
+   * Start replaying variates from a tape of auxiliary variables.
+   *
+   * @param[in,out] aux Tape of standard Gaussian auxiliary variables. Read
+   * from the start, and extended with new variates from the engine if
+   * exhausted.
+   */
+  void startReplay(std::vector<double>& aux);
+
+  /**
+   * Stop replaying variates, and return to the engine.
+   */
+  void stopReplay();
+
   /**
    * Random number generator type.
    */
-  typedef boost::mt19937 rng_type;
+  typedef MersenneTwister rng_type;
 
   /**
    * Random number generator.
    */
   rng_type rng;
+
+private:
+  /**
+   * Generate many standard Gaussian variates from the engine.
+   *
+   * @copydetails gaussians()
+   */
+  template<class T1>
+  void generateGaussians(T1* x, const int n);
+
+  /**
+   * Gamma variate with unit scale, from replayed variates.
+   *
+   * @tparam T1 Scalar type.
+   *
+   * @param alpha Shape.
+   */
+  template<class T1>
+  T1 replayGamma(const T1 alpha);
+
+  /**
+   * Next auxiliary variable on the tape.
+   */
+  double next();
+
+  /**
+   * Standard uniform variate, on \f$[0,1)\f$, from an auxiliary variable.
+   *
+   * @tparam T1 Scalar type.
+   *
+   * @param u Auxiliary variable.
+   */
+  template<class T1>
+  static T1 cdf(const double u);
+
+  /**
+   * Buffer of engine variates for bulk generation.
+   */
+  std::vector<rng_type::result_type> words;
+
+  /**
+   * Tape of auxiliary variables, when replaying, otherwise null.
+   */
+  std::vector<double>* aux;
+
+  /**
+   * Position on tape.
+   */
+  int pos;
 };
 }
 
 #include "../../misc/omp.hpp"
 #include "../../math/sim_temp_vector.hpp"
+#include "../../random/generic.hpp"
+#include "Ziggurat.hpp"
 
 #include "boost/random/uniform_int.hpp"
 #include "boost/random/uniform_real.hpp"
 #include "boost/random/normal_distribution.hpp"
 #include "boost/random/gamma_distribution.hpp"
-#include "boost/random/binomial_distribution.hpp"
-#include "boost/random/poisson_distribution.hpp"
 #include "boost/random/variate_generator.hpp"
 
 #include "thrust/binary_search.h"
 
+#include <limits>
+
+inline bi::RngHost::RngHost() :
+    aux(NULL), pos(0) {
+  //
+}
+
 inline void bi::RngHost::seed(const unsigned seed) {
   rng.seed(seed);
 }
@@ -113,6 +231,12 @@ inline T1 bi::RngHost::uniformInt(const T1 lower, const T1 upper) {
 
   typedef boost::uniform_int<T1> dist_type;
 
+  if (aux != NULL) {
+    const double z = cdf<double>(next());
+    const double n = static_cast<double>(upper - lower) + 1.0;
+    return lower + bi::min(static_cast<T1>(z*n), upper - lower);
+  }
+
   dist_type dist(lower, upper);
   boost::variate_generator<rng_type&, dist_type> gen(rng, dist);
 
@@ -124,17 +248,15 @@ inline typename V1::difference_type bi::RngHost::multinomial(const V1 lps) {
   /* pre-condition */
   BI_ASSERT(lps.size() > 0);
 
-  typedef boost::uniform_real<typename V1::value_type> dist_type;
+  typedef typename V1::value_type T1;
 
   typename sim_temp_vector<V1>::type Ps(lps.size());
   sumexpu_inclusive_scan(lps, Ps);
 
-  typename V1::value_type sumexpu(*(Ps.end() - 1));
+  T1 sumexpu(*(Ps.end() - 1));
   if (sumexpu > 0) {
-    dist_type dist(0.0, sumexpu);
-    boost::variate_generator<rng_type&, dist_type> gen(rng, dist);
-
-    return thrust::lower_bound(Ps.begin(), Ps.end(), gen()) - Ps.begin();
+    T1 u = uniform(static_cast<T1>(0.0), sumexpu);
+    return thrust::lower_bound(Ps.begin(), Ps.end(), u) - Ps.begin();
   } else {
     return thrust::lower_bound(Ps.begin(), Ps.end(), .0) - Ps.begin();
   }
@@ -147,6 +269,10 @@ inline T1 bi::RngHost::uniform(const T1 lower, const T1 upper) {
 
   typedef boost::uniform_real<T1> dist_type;
 
+  if (aux != NULL) {
+    return lower + (upper - lower)*cdf<T1>(next());
+  }
+
   dist_type dist(lower, upper);
   boost::variate_generator<rng_type&, dist_type> gen(rng, dist);
 
@@ -160,6 +286,10 @@ inline T1 bi::RngHost::gaussian(const T1 mu, const T1 sigma) {
 
   typedef boost::normal_distribution<T1> dist_type;
 
+  if (aux != NULL) {
+    return mu + sigma*static_cast<T1>(next());
+  }
+
   dist_type dist(mu, sigma);
   boost::variate_generator<rng_type&, dist_type> gen(rng, dist);
 
@@ -174,6 +304,10 @@ inline T1 bi::RngHost::gamma(const T1 alpha, const T1 beta) {
 
   typedef boost::gamma_distribution<T1> dist_type;
 
+  if (aux != NULL) {
+    return beta*replayGamma(alpha);
+  }
+
   dist_type dist(alpha);
   boost::variate_generator<rng_type&, dist_type> gen(rng, dist);
 
@@ -182,35 +316,146 @@ inline T1 bi::RngHost::gamma(const T1 alpha, const T1 beta) {
 
 template<class T1>
 inline T1 bi::RngHost::poisson(const T1 lambda) {
-  /* pre-condition */
-  BI_ASSERT(lambda >= 0.0);
+  return bi::poisson(*this, lambda);
+}
 
-  if (lambda > 0) {
-    typedef boost::poisson_distribution<int,T1> dist_type;
+template<class T1, class T2>
+inline T1 bi::RngHost::binomial(const T1 n, const T2 p) {
+  return bi::binomial(*this, n, p);
+}
 
-    dist_type dist(lambda);
-    boost::variate_generator<rng_type&, dist_type> gen(rng, dist);
+template<class T1>
+void bi::RngHost::gaussians(T1* x, const int n) {
+  /* pre-condition */
+  BI_ASSERT(n >= 0);
 
-    return static_cast<T1>(gen());
+  if (aux != NULL) {
+    for (int i = 0; i < n; ++i) {
+      x[i] = static_cast<T1>(next());
+    }
   } else {
-    return 0;
+    generateGaussians(x, n);
   }
-
 }
 
-template<class T1, class T2>
-inline T1 bi::RngHost::binomial(const T1 n, const T2 p) {
+template<class T1>
+void bi::RngHost::uniforms(T1* x, const int n) {
   /* pre-condition */
-  BI_ASSERT(n >= static_cast<T1>(0.0));
-  BI_ASSERT(p >= static_cast<T2>(0.0));
-  BI_ASSERT(p <= static_cast<T2>(1.0));
+  BI_ASSERT(n >= 0);
 
-  typedef boost::binomial_distribution<int,T2> dist_type;
+  const bool single = sizeof(T1) <= sizeof(rng_type::result_type);
+  int i;
 
-  dist_type dist(n, p);
-  boost::variate_generator<rng_type&, dist_type> gen(rng, dist);
+  if (aux != NULL) {
+    for (i = 0; i < n; ++i) {
+      x[i] = cdf<T1>(next());
+    }
+    return;
+  }
+
+  words.resize(n);
+  if (n > 0) {
+    rng.generate(&words[0], n);
+  }
+
+  /* in single precision, keep only as many bits as can be represented, so
+   * that rounding cannot give one */
+  for (i = 0; i < n; ++i) {
+    if (single) {
+      x[i] = static_cast<T1>(words[i] >> 8)*static_cast<T1>(1.0/16777216.0);
+    } else {
+      x[i] = static_cast<T1>(words[i])*static_cast<T1>(1.0/4294967296.0);
+    }
+  }
+}
+
+inline void bi::RngHost::startReplay(std::vector<double>& aux) {
+  this->aux = &aux;
+  this->pos = 0;
+}
+
+inline void bi::RngHost::stopReplay() {
+  aux = NULL;
+  pos = 0;
+}
+
+template<class T1>
+void bi::RngHost::generateGaussians(T1* x, const int n) {
+  static const Ziggurat zig;
+  const int W = (sizeof(T1) > sizeof(rng_type::result_type)) ? 2 : 1;
+  boost::uint64_t bits;
+  double u;
+  int i, l;
+
+  words.resize(W*n);
+  if (n > 0) {
+    rng.generate(&words[0], W*n);
+  }
+
+  /* the layer is chosen with the low bits, the position with the high */
+  for (i = 0; i < n; ++i) {
+    if (W == 2) {
+      bits = (static_cast<boost::uint64_t>(words[2*i]) << 32)
+          | words[2*i + 1];
+      u = static_cast<double>(bits >> 11)*(1.0/4503599627370496.0) - 1.0;
+    } else {
+      bits = words[i];
+      u = static_cast<double>(bits >> 7)*(1.0/16777216.0) - 1.0;
+    }
+    l = static_cast<int>(bits & (Ziggurat::L - 1));
+    if (bi::abs(u) < zig.r[l]) {
+      x[i] = static_cast<T1>(u*zig.x[l]);
+    } else {
+      x[i] = static_cast<T1>(zig.reject(rng, l, u));
+    }
+  }
+}
+
+template<class T1>
+T1 bi::RngHost::replayGamma(const T1 alpha) {
+  const T1 one = static_cast<T1>(1.0);
+
+  if (alpha < one) {
+    /* boost shape, then scale back down */
+    return replayGamma(alpha + one)*bi::pow(uniform<T1>(), one/alpha);
+  }
+
+  const T1 d = alpha - one/static_cast<T1>(3.0);
+  const T1 c = one/bi::sqrt(static_cast<T1>(9.0)*d);
+  T1 x, v, u;
+
+  while (true) {
+    do {
+      x = gaussian<T1>();
+      v = one + c*x;
+    } while (v <= static_cast<T1>(0.0));
+    v = v*v*v;
+    u = uniform<T1>();
+    if (bi::log(u) < static_cast<T1>(0.5)*x*x + d - d*v + d*bi::log(v)) {
+      return d*v;
+    }
+  }
+}
+
+inline double bi::RngHost::next() {
+  if (pos >= static_cast<int>(aux->size())) {
+    /* extend with fresh variates; those not yet used do not affect
+     * anything, so may be drawn at any time */
+    const int n = bi::max(1024, static_cast<int>(aux->size()));
+    aux->resize(aux->size() + n);
+    generateGaussians(&(*aux)[pos], n);
+  }
+  return (*aux)[pos++];
+}
+
+template<class T1>
+inline T1 bi::RngHost::cdf(const double u) {
+  /* largest value below one, as rounding may otherwise give one */
+  static const T1 ub = static_cast<T1>(1.0)
+      - std::numeric_limits<T1>::epsilon()/static_cast<T1>(2.0);
 
-  return static_cast<T1>(gen());
+  return bi::min(static_cast<T1>(0.5*bi::erfc(-u*0.70710678118654752440)),
+      ub);
 }
 
 #endif
@@ -0,0 +1,154 @@
+/**
+ * @file
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ *
+ * @section Ziggurat_references References
+ *
+ * @anchor Marsaglia2000 Marsaglia, G. and Tsang, W. W. The ziggurat method
+ * for generating random variables. <i>Journal of Statistical Software</i>,
+ * <b>2000</b>, 5, 1-7.
+ *
+ * @anchor Doornik2005 Doornik, J. A. An improved ziggurat method to
+ * generate normal random samples. Technical report, University of Oxford,
+ * <b>2005</b>.
+ */
+#ifndef BI_HOST_RANDOM_ZIGGURAT_HPP
+#define BI_HOST_RANDOM_ZIGGURAT_HPP
+
+#include "boost/cstdint.hpp"
+
+namespace bi {
+/**
+ * Tables of the ziggurat method for standard Gaussian variates.
+ *
+ * @ingroup math_rng
+ *
+ * The density is covered by 128 layers of equal area, per
+ * @ref Marsaglia2000 "Marsaglia & Tsang (2000)". A variate is drawn by
+ * choosing a layer and a uniform position across it; the great majority
+ * fall within the part of the layer under the density and are accepted
+ * with just a comparison, which is cheap enough to apply over many
+ * variates at once. The remainder go to reject(). Following
+ * @ref Doornik2005 "Doornik (2005)", the bits used to choose the layer are
+ * disjoint from those used for the position.
+ */
+class Ziggurat {
+public:
+  /**
+   * Number of layers.
+   */
+  static const int L = 128;
+
+  /**
+   * Constructor. Computes the tables.
+   */
+  Ziggurat();
+
+  /**
+   * Complete a variate that fell outside the part of its layer under the
+   * density.
+   *
+   * @tparam E Engine type.
+   *
+   * @param[in,out] eng Engine, for further variates.
+   * @param i Layer.
+   * @param u Position across layer, in \f$[-1,1)\f$.
+   *
+   * @return The variate.
+   */
+  template<class E>
+  double reject(E& eng, int i, double u) const;
+
+  /**
+   * Right edges of layers. Layer @c i covers \f$[-x_i,x_i]\f$, with the
+   * part over \f$[-x_{i+1},x_{i+1}]\f$ under the density.
+   */
+  double x[L + 1];
+
+  /**
+   * Ratios \f$x_{i+1}/x_i\f$, for the acceptance test.
+   */
+  double r[L];
+
+private:
+  /**
+   * Draw a uniform variate on \f$(0,1]\f$ with 53 random bits.
+   */
+  template<class E>
+  static double uniform(E& eng);
+
+  /**
+   * Start of tail, right edge of the layer after the base.
+   */
+  static double tail();
+};
+}
+
+#include "../../math/function.hpp"
+
+inline bi::Ziggurat::Ziggurat() {
+  /* area of each layer */
+  const double v = 9.91256303526217e-3;
+  double f = bi::exp(-0.5*tail()*tail());
+  int i;
+
+  x[0] = v/f;
+  x[1] = tail();
+  for (i = 2; i < L; ++i) {
+    x[i] = bi::sqrt(-2.0*bi::log(v/x[i - 1] + f));
+    f = bi::exp(-0.5*x[i]*x[i]);
+  }
+  x[L] = 0.0;
+  for (i = 0; i < L; ++i) {
+    r[i] = x[i + 1]/x[i];
+  }
+}
+
+template<class E>
+double bi::Ziggurat::reject(E& eng, int i, double u) const {
+  double x0, f0, f1, y, z;
+  boost::uint64_t bits;
+
+  while (true) {
+    if (i == 0) {
+      /* base layer, sample from tail by Marsaglia's method */
+      do {
+        y = bi::log(uniform(eng))/tail();
+        z = bi::log(uniform(eng));
+      } while (-2.0*z < y*y);
+      return (u > 0.0) ? tail() - y : y - tail();
+    }
+
+    /* wedge, test against density relative to that at the position */
+    x0 = u*x[i];
+    f0 = bi::exp(-0.5*(x[i]*x[i] - x0*x0));
+    f1 = bi::exp(-0.5*(x[i + 1]*x[i + 1] - x0*x0));
+    if (f1 + uniform(eng)*(f0 - f1) < 1.0) {
+      return x0;
+    }
+
+    /* start again */
+    bits = (static_cast<boost::uint64_t>(eng()) << 32) | eng();
+    i = static_cast<int>(bits & (L - 1));
+    u = static_cast<double>(bits >> 11)*(1.0/4503599627370496.0) - 1.0;
+    if (bi::abs(u) < r[i]) {
+      return u*x[i];
+    }
+  }
+}
+
+template<class E>
+inline double bi::Ziggurat::uniform(E& eng) {
+  const boost::uint64_t bits = (static_cast<boost::uint64_t>(eng()) << 32)
+      | eng();
+  return (static_cast<double>(bits >> 11) + 1.0)*(1.0/9007199254740992.0);
+}
+
+inline double bi::Ziggurat::tail() {
+  return 3.442619855899;
+}
+
+#endif
@@ -9,6 +9,7 @@
 #define BI_HOST_RESAMPLER_METROPOLISRESAMPLERHOST_HPP
 
 #include "ResamplerHost.hpp"
+#include "../../misc/compile.hpp"
 
 namespace bi {
 /**
@@ -27,6 +28,14 @@ public:
    */
   template<class V1, class V2>
   static void ancestorsPermute(Random& rng, const V1 lws, V2 as, int B);
+
+private:
+  /**
+   * Number of particles advanced together by each thread. Their chains are
+   * independent, so the random reads of their proposals may be in flight
+   * at the same time, rather than each waiting on the last.
+   */
+  static const int LANES = 8;
 };
 }
 
@@ -35,30 +44,55 @@ void bi::MetropolisResamplerHost::ancestors(Random& rng, const V1 lws,
     V2 as, int B) {
   const int P1 = lws.size(); // number of particles
   const int P2 = as.size(); // number of ancestors to draw
+  const int Q = (P2 + LANES - 1)/LANES; // number of groups of particles
 
   #pragma omp parallel
   {
-    real alpha, lw1, lw2;
-    int k, p1, p2, p;
+    RngHost& rng1 = rng.getHostRng();
+    real alpha[LANES];
+    wreal lw1[LANES], lw2[LANES];
+    int p1[LANES], p2[LANES], p3[LANES];
+    int q, g, k, p, n;
 
     #pragma omp for
-    for (p = 0; p < P2; ++p) {
-      p1 = p;
-      lw1 = lws(p);
+    for (q = 0; q < Q; ++q) {
+      p = q*LANES;
+      n = bi::min(LANES, P2 - p);
+      for (g = 0; g < n; ++g) {
+        p1[g] = p + g;
+        lw1[g] = lws(p + g);
+        if (B > 0) {
+          p3[g] = rng1.uniformInt(0, P1 - 1);
+          BI_PREFETCH(&lws(p3[g]));
+        }
+      }
       for (k = 0; k < B; ++k) {
-        p2 = rng.uniformInt(0, P1 - 1);
-        lw2 = lws(p2);
-        alpha = rng.uniform<real>();
-
-        if (bi::log(alpha) < lw2 - lw1) {
-          /* accept */
-          p1 = p2;
-          lw1 = lw2;
+        /* draw the proposals of the next step and prefetch their
+         * log-weights, so that the reads overlap with this step */
+        for (g = 0; g < n; ++g) {
+          p2[g] = p3[g];
+          alpha[g] = rng1.uniform<real>();
+          if (k + 1 < B) {
+            p3[g] = rng1.uniformInt(0, P1 - 1);
+            BI_PREFETCH(&lws(p3[g]));
+          }
+        }
+        for (g = 0; g < n; ++g) {
+          lw2[g] = lws(p2[g]);
+        }
+        for (g = 0; g < n; ++g) {
+          if (bi::log(alpha[g]) < lw2[g] - lw1[g]) {
+            /* accept */
+            p1[g] = p2[g];
+            lw1[g] = lw2[g];
+          }
         }
       }
 
       /* write result */
-      as(p) = p1;
+      for (g = 0; g < n; ++g) {
+        as(p + g) = p1[g];
+      }
     }
   }
 }
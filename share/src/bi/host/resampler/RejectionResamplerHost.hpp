@@ -47,7 +47,8 @@ void bi::RejectionResamplerHost::ancestors(Random& rng, const V1 lws,
 
   #pragma omp parallel
   {
-    real alpha, lw2;
+    real alpha;
+    wreal lw2;
     int p, p2;
 
     #pragma omp for
@@ -47,20 +47,14 @@ void bi::StratifiedResamplerHost::op(Random& rng, const V1 Ws, V2 Os,
    */
   //rng.uniforms(alphas);
 
-  typedef typename V1::value_type T1;
-  typedef boost::uniform_real<T1> dist_type;
-
   #pragma omp parallel
   {
     RngHost& rng1 = rng.getHostRng();
     int i;
 
-    dist_type dist(0.0, 1.0);
-    boost::variate_generator<RngHost::rng_type&, dist_type> gen(rng1.rng, dist);
-
-    #pragma omp for
+    #pragma omp for schedule(static)
     for (i = 0; i < alphas.size(); ++i) {
-      alphas(i) = gen();
+      alphas(i) = rng1.uniform<T1>();
     }
 
     #pragma omp barrier
@@ -19,6 +19,11 @@ namespace bi {
  *
  * @tparam B Model type.
  * @tparam S Action type list.
+ *
+ * When sampling all trajectories, the standard Gaussian and uniform
+ * variates required by the block are pre-generated in bulk for a batch of
+ * trajectories at a time, with NoiseTapeHost, before the actions of the
+ * block are applied to them.
  */
 template<class B, class S>
 class DynamicSamplerHost {
@@ -42,6 +47,7 @@ public:
 #include "DynamicSamplerVisitorHost.hpp"
 #include "DynamicSamplerMatrixVisitorHost.hpp"
 #include "../host.hpp"
+#include "../random/NoiseTapeHost.hpp"
 #include "../../state/Pa.hpp"
 #include "../../state/Ou.hpp"
 #include "../../traits/block_traits.hpp"
@@ -50,7 +56,7 @@ template<class B, class S>
 template<class T1>
 void bi::DynamicSamplerHost<B,S>::samples(Random& rng, const T1 t1,
     const T1 t2, State<B,ON_HOST>& s) {
-  typedef RngHost R1;
+  typedef NoiseTapeHost R1;
   typedef Pa<ON_HOST,B,host,host,host,host> PX;
   typedef Ou<ON_HOST,B,host> OX;
   typedef DynamicSamplerMatrixVisitorHost<B,S,R1,PX,OX> MatrixVisitor;
@@ -58,16 +64,26 @@ void bi::DynamicSamplerHost<B,S>::samples(Random& rng, const T1 t1,
   typedef typename boost::mpl::if_c<block_is_matrix<S>::value,MatrixVisitor,
       ElementVisitor>::type Visitor;
 
+  static const int G = block_num_gaussians<S>::value;
+  static const int U = block_num_uniforms<S>::value;
+
+  /* trajectories per batch, so that the tapes stay in cache */
+  const int N = bi::max(1, 4096/bi::max(1, G + U));
+
   #pragma omp parallel
   {
     PX pax;
     OX x;
-    R1& rng1 = rng.getHostRng();
-    int p;
+    R1 rng1(rng.getHostRng());
+    int q, p, n;
 
-    #pragma omp for
-    for (p = 0; p < s.size(); ++p) {
-      Visitor::accept(rng1, t1, t2, s, p, pax, x);
+    #pragma omp for schedule(static)
+    for (q = 0; q < s.size(); q += N) {
+      n = bi::min(N, s.size() - q);
+      rng1.fill(n*G, n*U);
+      for (p = q; p < q + n; ++p) {
+        Visitor::accept(rng1, t1, t2, s, p, pax, x);
+      }
     }
   }
 }
@@ -11,6 +11,10 @@
 #define BI_PDF_FASTGAUSSIANKERNEL_HPP
 
 #include "../math/scalar.hpp"
+#include "../math/function.hpp"
+#include "../misc/assert.hpp"
+
+#include <algorithm>
 
 namespace bi {
 /**
@@ -70,7 +74,21 @@ public:
   template<class V1>
   typename V1::value_type operator()(const V1 x) const;
 
+  /**
+   * @copydoc concept::Kernel::sum()
+   *
+   * Samples are processed in blocks, with the innermost loops running over
+   * contiguous columns of @p Y so that they may be vectorised.
+   */
+  template<class V1, class M1, class V2>
+  typename V1::value_type sum(const V1 x, const M1 Y, const V2 lw) const;
+
 private:
+  /**
+   * Number of samples in each block of sum().
+   */
+  static const int BLOCK_SIZE = 16;
+
   /**
    * \f$h\f$; bandwidth.
    */
@@ -121,4 +139,41 @@ inline typename V1::value_type bi::FastGaussianKernel::operator()(const V1 x) co
   return density(x);
 }
 
+template<class V1, class M1, class V2>
+typename V1::value_type bi::FastGaussianKernel::sum(const V1 x, const M1 Y,
+    const V2 lw) const {
+  /* pre-conditions */
+  BI_ASSERT(x.size() == Y.size2());
+  BI_ASSERT(lw.size() == Y.size1());
+  BI_ASSERT(Y.inc() == 1);
+  BI_ASSERT(!M1::on_device);
+
+  typedef typename V1::value_type T1;
+
+  T1 d[BLOCK_SIZE], y, result = 0.0;
+  const T1* col;
+  int i, j, k, n;
+
+  for (j = 0; j < Y.size1(); j += BLOCK_SIZE) {
+    n = std::min(BLOCK_SIZE, Y.size1() - j);
+    for (k = 0; k < n; ++k) {
+      d[k] = 0.0;
+    }
+    for (i = 0; i < Y.size2(); ++i) {
+      y = x(i);
+      col = Y.buf() + i*Y.lead() + j;
+      for (k = 0; k < n; ++k) {
+        d[k] += (col[k] - y)*(col[k] - y);
+      }
+    }
+    for (k = 0; k < n; ++k) {
+      d[k] = bi::exp(E*d[k] + lw(j + k));
+    }
+    for (k = 0; k < n; ++k) {
+      result += d[k];
+    }
+  }
+  return ZI*result;
+}
+
 #endif
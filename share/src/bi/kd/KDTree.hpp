@@ -12,8 +12,16 @@
 
 #include "KDTreeNode.hpp"
 #include "MedianPartitioner.hpp"
+#include "../math/matrix.hpp"
+#include "../math/vector.hpp"
+#include "../math/view.hpp"
 
+#include <vector>
+
+#ifndef __CUDACC__
 #include "boost/serialization/split_member.hpp"
+#include "boost/serialization/vector.hpp"
+#endif
 
 namespace bi {
 /**
@@ -21,15 +29,36 @@ namespace bi {
  *
  * @ingroup kd
  *
- * @tparam M1 Vector type.
+ * @tparam V1 Vector type.
+ * @tparam M1 Matrix type.
+ *
+ * The tree is stored flat. Nodes are kept in an array, with the children
+ * of the node at position \f$k\f$ at positions \f$2k+1\f$ and \f$2k+2\f$.
+ * Samples are copied into the tree in leaf order, so that the samples
+ * encompassed by any node occupy a contiguous block of rows, and bounds of
+ * all nodes occupy the columns of a single matrix.
+ *
+ * Each internal node is split at the midpoint of its samples, so that the
+ * tree is balanced. It is built one level at a time, with the nodes of
+ * each level partitioned in parallel.
  */
-template <class V1 = host_vector<>, class M1 = host_matrix<> >
+template<class V1 = host_vector<>, class M1 = host_matrix<> >
 class KDTree {
 public:
   /**
    * Node type.
    */
-  typedef KDTreeNode<V1,M1> var_type;
+  typedef KDTreeNode node_type;
+
+  /**
+   * Vector reference type.
+   */
+  typedef typename V1::vector_reference_type vector_reference_type;
+
+  /**
+   * Matrix reference type.
+   */
+  typedef typename M1::matrix_reference_type matrix_reference_type;
 
   /**
    * Default constructor.
@@ -43,14 +72,16 @@ public:
    * Constructor.
    *
    * @tparam M2 Matrix type.
+   * @tparam V2 Vector type.
    * @tparam S1 #concept::Partitioner type.
    *
-   * @param X Samples.
+   * @param X Samples. Rows index samples, columns index variables.
    * @param lw Log-weights.
    * @param partitioner Partitioner.
+   * @param leafSize Maximum number of samples in a terminal node.
    */
   template<class M2, class V2, class S1>
-  KDTree(const M2 X, const V2 lw, S1 partitioner);
+  KDTree(const M2 X, const V2 lw, S1 partitioner, const int leafSize = 8);
 
   /**
    * Constructor.
@@ -58,231 +89,520 @@ public:
    * @tparam M2 Matrix type.
    * @tparam S1 #concept::Partitioner type.
    *
-   * @param X Samples.
+   * @param X Samples. Rows index samples, columns index variables.
    * @param partitioner Partitioner.
+   * @param leafSize Maximum number of samples in a terminal node.
    */
   template<class M2, class S1>
-  KDTree(const M2 X, S1 partitioner);
+  KDTree(const M2 X, S1 partitioner, const int leafSize = 8);
+
+  /**
+   * Is the tree empty?
+   */
+  bool isEmpty() const;
 
   /**
-   * Copy constructor.
+   * Get size.
+   *
+   * @return Number of variables.
    */
-  KDTree(const KDTree<V1,M1>& o);
+  int getSize() const;
 
   /**
-   * Destructor.
+   * Get count.
+   *
+   * @return Number of samples.
    */
-  ~KDTree();
+  int getCount() const;
 
   /**
-   * Assignment operator.
+   * Get number of node positions, including those of empty nodes.
    */
-  KDTree<V1,M1>& operator=(const KDTree<V1,M1>& o);
+  int getNumNodes() const;
 
   /**
-   * Get root node.
+   * Get root node position.
+   */
+  static int getRoot();
+
+  /**
+   * Get position of left child.
    *
-   * @return Root node.
+   * @param k Position of internal node.
    */
-  var_type* getRoot();
+  static int getLeft(const int k);
 
   /**
-   * Get size.
+   * Get position of right child.
    *
-   * @return Size.
+   * @param k Position of internal node.
    */
-  int getSize();
+  static int getRight(const int k);
 
   /**
-   * Set root node.
+   * Get node.
    *
-   * @param root Root node.
+   * @param k Position of node.
    */
-  void setRoot(var_type* root);
+  const node_type& getNode(const int k) const;
+
+  /**
+   * Get lower bound of node.
+   *
+   * @param k Position of node.
+   */
+  const vector_reference_type getLower(const int k) const;
 
-private:
   /**
-   * Root node of the tree.
+   * Get upper bound of node.
+   *
+   * @param k Position of node.
+   */
+  const vector_reference_type getUpper(const int k) const;
+
+  /**
+   * Get samples encompassed by node.
+   *
+   * @param k Position of node.
+   *
+   * @return Samples, one per row, in leaf order.
+   */
+  const matrix_reference_type getValues(const int k) const;
+
+  /**
+   * Get log-weights of samples encompassed by node.
+   *
+   * @param k Position of node.
+   *
+   * @return Log-weights, in leaf order.
    */
-  var_type* root;
+  const vector_reference_type getLogWeights(const int k) const;
 
   /**
-   * Build \f$kd\f$ tree node.
+   * Get index of sample.
+   *
+   * @param i Index of sample in leaf order.
+   *
+   * @return Index of the sample in the original data set.
+   */
+  int getIndex(const int i) const;
+
+  /**
+   * Find the coordinate difference of a node from a single point.
+   *
+   * @tparam V2 Vector type.
+   * @tparam V3 Vector type.
+   *
+   * @param k Position of node.
+   * @param x Query point.
+   * @param[out] result Difference between the query point and the nearest
+   * point within the volume contained by the node.
+   *
+   * Note that the difference may contain negative values. Usually a norm
+   * would subsequently be applied to obtain a scalar distance.
+   */
+  template<class V2, class V3>
+  void difference(const int k, const V2 x, V3 result) const;
+
+  /**
+   * Find the coordinate difference of a node from a node of another tree.
+   *
+   * @tparam V2 Vector type.
+   * @tparam M2 Matrix type.
+   * @tparam V3 Vector type.
+   *
+   * @param k Position of node in this tree.
+   * @param tree Other tree.
+   * @param l Position of node in @p tree.
+   * @param[out] result Difference between the closest two points in the
+   * volumes contained by the nodes.
+   *
+   * Note that the difference may contain negative values. Usually a norm
+   * would subsequently be applied to obtain a scalar distance.
+   */
+  template<class V2, class M2, class V3>
+  void difference(const int k, const KDTree<V2,M2>& tree, const int l,
+      V3 result) const;
+
+private:
+  /**
+   * Build tree.
    *
    * @tparam M2 Matrix type.
+   * @tparam V2 Vector type.
+   * @tparam S1 #concept::Partitioner type.
    *
    * @param X Samples.
-   * @param is Indices of the subset of components in @p X over which to build
-   * the node.
-   * @param depth Depth of the node in the tree. Zero for the root node.
-   * 
-   * @return The node. Caller has ownership.
+   * @param lw Log-weights.
+   * @param partitioner Partitioner.
+   * @param leafSize Maximum number of samples in a terminal node.
    */
   template<class M2, class V2, class S1>
-  static var_type* build(const M2 X, const V2 lw, S1 partitioner,
-      const std::vector<int>& is, const int depth = 0);
+  void build(const M2 X, const V2 lw, S1 partitioner, const int leafSize);
+
+  /**
+   * Compute bounds of all nodes, bottom up.
+   *
+   * @param depth Depth of the deepest level of the tree.
+   */
+  void bound(const int depth);
+
+  /**
+   * Samples, in leaf order.
+   */
+  M1 X;
+
+  /**
+   * Log-weights, in leaf order.
+   */
+  V1 lw;
+
+  /**
+   * Indices of samples, in leaf order, into the original data set.
+   */
+  host_vector<int> is;
+
+  /**
+   * Lower bounds of nodes, one per column.
+   */
+  M1 lower;
 
+  /**
+   * Upper bounds of nodes, one per column.
+   */
+  M1 upper;
+
+  /**
+   * Nodes.
+   */
+  std::vector<node_type> nodes;
+
+  #ifndef __CUDACC__
   /**
    * Serialize.
    */
   template<class Archive>
-  void save(Archive& ar, const int version) const;
+  void save(Archive& ar, const unsigned version) const;
 
   /**
    * Restore from serialization.
    */
   template<class Archive>
-  void load(Archive& ar, const int version);
+  void load(Archive& ar, const unsigned version);
 
   /*
    * Boost.Serialization requirements.
    */
   BOOST_SERIALIZATION_SPLIT_MEMBER()
   friend class boost::serialization::access;
+  #endif
 };
 }
 
-#include "partition.hpp"
+#include "../primitive/vector_primitive.hpp"
+#include "../math/serialization.hpp"
 
 template<class V1, class M1>
-bi::KDTree<V1,M1>::KDTree() : root(NULL) {
+bi::KDTree<V1,M1>::KDTree() {
   //
 }
 
 template<class V1, class M1>
 template<class M2, class V2, class S1>
-bi::KDTree<V1,M1>::KDTree(const M2 X, const V2 lw, const S1 partitioner) {
-  host_vector<int> is(X.size1());
-  seq_elements(is, 0);
-
-  root = (is.size() > 0) ? build(X, lw, partitioner, is) : NULL;
+bi::KDTree<V1,M1>::KDTree(const M2 X, const V2 lw, S1 partitioner,
+    const int leafSize) {
+  /* pre-conditions */
+  BI_ASSERT(lw.size() == X.size1());
+  BI_ASSERT(leafSize >= 1);
+
+  if (X.size1() > 0) {
+    build(X, lw, partitioner, leafSize);
+  }
 }
 
 template<class V1, class M1>
 template<class M2, class S1>
-bi::KDTree<V1,M1>::KDTree(const M2 X, const S1 partitioner) {
-  V1 lw(X.size1());
-  lw.clear();
-  host_vector<int> is(X.size1());
-  seq_elements(is, 0);
+bi::KDTree<V1,M1>::KDTree(const M2 X, S1 partitioner, const int leafSize) {
+  /* pre-condition */
+  BI_ASSERT(leafSize >= 1);
 
-  root = (is.size() > 0) ? build(X, lw, partitioner, is) : NULL;
+  if (X.size1() > 0) {
+    V1 lw(X.size1());
+    lw.clear();
+    build(X, lw, partitioner, leafSize);
+  }
 }
 
 template<class V1, class M1>
-bi::KDTree<V1,M1>::KDTree(const KDTree<V1,M1>& o) {
-  root = (o.root == NULL) ? NULL : new KDTreeNode<V1,M1>(o.root);
+inline bool bi::KDTree<V1,M1>::isEmpty() const {
+  return nodes.empty();
 }
 
 template<class V1, class M1>
-bi::KDTree<V1,M1>::~KDTree() {
-  delete root;
+inline int bi::KDTree<V1,M1>::getSize() const {
+  return X.size2();
 }
 
 template<class V1, class M1>
-bi::KDTree<V1,M1>& bi::KDTree<V1,M1>::operator=(const KDTree<V1,M1>& o) {
-  delete root;
-  root = (o.root == NULL) ? NULL : new var_type(o.root);
-  
-  return *this;
+inline int bi::KDTree<V1,M1>::getCount() const {
+  return X.size1();
 }
 
 template<class V1, class M1>
-inline bi::KDTreeNode<V1,M1>* bi::KDTree<V1,M1>::getRoot() {
-  return root;
+inline int bi::KDTree<V1,M1>::getNumNodes() const {
+  return (int)nodes.size();
 }
 
 template<class V1, class M1>
-inline void bi::KDTree<V1,M1>::setRoot(var_type* root) {
-  this->root = root;
+inline int bi::KDTree<V1,M1>::getRoot() {
+  return 0;
 }
 
 template<class V1, class M1>
-inline int bi::KDTree<V1,M1>::getSize() {
-  return this->root->getSize();
+inline int bi::KDTree<V1,M1>::getLeft(const int k) {
+  return 2*k + 1;
 }
 
 template<class V1, class M1>
-template<class M2, class V2, class S1>
-typename bi::KDTree<V1,M1>::var_type* bi::KDTree<V1,M1>::build(const M2 X,
-    const V2 lw, S1 partitioner, const std::vector<int>& is, const int depth) {
+inline int bi::KDTree<V1,M1>::getRight(const int k) {
+  return 2*k + 2;
+}
+
+template<class V1, class M1>
+inline const typename bi::KDTree<V1,M1>::node_type& bi::KDTree<V1,M1>::getNode(
+    const int k) const {
+  /* pre-condition */
+  BI_ASSERT(k >= 0 && k < getNumNodes());
+
+  return nodes[k];
+}
+
+template<class V1, class M1>
+inline const typename bi::KDTree<V1,M1>::vector_reference_type bi::KDTree<V1,M1>::getLower(
+    const int k) const {
+  return column(lower, k);
+}
+
+template<class V1, class M1>
+inline const typename bi::KDTree<V1,M1>::vector_reference_type bi::KDTree<V1,M1>::getUpper(
+    const int k) const {
+  return column(upper, k);
+}
+
+template<class V1, class M1>
+inline const typename bi::KDTree<V1,M1>::matrix_reference_type bi::KDTree<V1,M1>::getValues(
+    const int k) const {
+  return rows(X, nodes[k].getStart(), nodes[k].getCount());
+}
+
+template<class V1, class M1>
+inline const typename bi::KDTree<V1,M1>::vector_reference_type bi::KDTree<V1,M1>::getLogWeights(
+    const int k) const {
+  return subrange(lw, nodes[k].getStart(), nodes[k].getCount());
+}
+
+template<class V1, class M1>
+inline int bi::KDTree<V1,M1>::getIndex(const int i) const {
+  return is(i);
+}
+
+template<class V1, class M1>
+template<class V2, class V3>
+inline void bi::KDTree<V1,M1>::difference(const int k, const V2 x,
+    V3 result) const {
   /* pre-condition */
-  BI_ASSERT(is.size() > 0);
+  BI_ASSERT(x.size() == getSize());
+  BI_ASSERT(result.size() == getSize());
 
-  var_type* result;
+  BOOST_AUTO(lower, getLower(k));
+  BOOST_AUTO(upper, getUpper(k));
+  real val, low, high;
   int i;
-  
-  if (is.size() == 1) {
-    /* leaf node */
-    result = new var_type(X, lw, is.front(), depth);
-  } else if (is.size() <= 4) {
-    /* prune node */
-    result = new var_type(X, lw, is, depth);
-  } else {
-    /* internal node */
-    if (partitioner.init(X, is)) {
-      var_type *left, *right; // child nodes
-      std::vector<int> ls, rs; // indices of left, right components
-      ls.reserve(is.size()/2 + 1);
-      rs.reserve(is.size()/2 + 1);
-      
-      for (i = 0; i < (int)is.size(); ++i) {
-        if (partitioner.assign(row(X,is[i])) == LEFT) {
-          ls.push_back(is[i]);
-        } else {
-          rs.push_back(is[i]);
-        }
-      }
 
-      if (ls.size() == 0) {
-        /* degenerate case left child, make prune node from right */
-        result = new var_type(X, lw, rs, depth);
-      } else if (rs.size() == 0) {
-        /* degenerate right child, make prune node from left*/
-        result = new var_type(X, lw, ls, depth);
+  for (i = 0; i < lower.size(); ++i) {
+    val = x(i);
+    low = lower(i);
+    if (val < low) {
+      result(i) = low - val;
+    } else {
+      high = upper(i);
+      if (val > high) {
+        result(i) = val - high;
       } else {
-        /* internal node */
-        left = build(X, lw, partitioner, ls, depth + 1);
-        right = build(X, lw, partitioner, rs, depth + 1);
-      
-        result = new var_type(left, right, depth);
+        result(i) = 0.0;
       }
+    }
+  }
+}
+
+template<class V1, class M1>
+template<class V2, class M2, class V3>
+inline void bi::KDTree<V1,M1>::difference(const int k,
+    const KDTree<V2,M2>& tree, const int l, V3 result) const {
+  /* pre-conditions */
+  BI_ASSERT(tree.getSize() == getSize());
+  BI_ASSERT(result.size() == getSize());
+
+  BOOST_AUTO(lower, getLower(k));
+  BOOST_AUTO(upper, getUpper(k));
+  BOOST_AUTO(nodeLower, tree.getLower(l));
+  BOOST_AUTO(nodeUpper, tree.getUpper(l));
+  real high, low;
+  int i;
+
+  for (i = 0; i < lower.size(); ++i) {
+    high = nodeUpper(i);
+    low = lower(i);
+    if (high < low) {
+      result(i) = low - high;
     } else {
-      /* Degenerate case, usually occurs when all points are identical or
-         one has negligible weight, so that they cannot be partitioned
-         spatially. Put them all into one prune node... */
-      result = new var_type(X, lw, is, depth);
+      high = upper(i);
+      low = nodeLower(i);
+      if (low > high) {
+        result(i) = low - high;
+      } else {
+        result(i) = 0.0;
+      }
+    }
+  }
+}
+
+template<class V1, class M1>
+template<class M2, class V2, class S1>
+void bi::KDTree<V1,M1>::build(const M2 X, const V2 lw, S1 partitioner,
+    const int leafSize) {
+  const int P = X.size1(), N = X.size2();
+  int depth, level, n, i, j;
+
+  /* depth at which nodes of a balanced tree hold no more than leafSize
+   * samples, noting that the larger child of a node of n samples holds
+   * ceil(n/2) */
+  depth = 0;
+  for (n = P; n > leafSize; n = (n + 1)/2) {
+    ++depth;
+  }
+  nodes.clear();
+  nodes.resize((1 << (depth + 1)) - 1);
+  nodes[getRoot()] = node_type(0, P, 0);
+
+  is.resize(P);
+  seq_elements(is, 0);
+
+  /* partition top down, nodes of each level in parallel; each node permutes
+   * only its own contiguous block of is, so no synchronisation is required
+   * within a level */
+  for (level = 0; level < depth; ++level) {
+    const int first = (1 << level) - 1;
+    const int last = (1 << (level + 1)) - 1;
+
+    #pragma omp parallel
+    {
+      S1 part(partitioner);
+      int k, start, count;
+
+      #pragma omp for schedule(dynamic)
+      for (k = first; k < last; ++k) {
+        node_type& node = nodes[k];
+        start = node.getStart();
+        count = node.getCount();
+        if (count > leafSize) {
+          if (part.split(X, subrange(is, start, count))) {
+            node.split();
+            nodes[getLeft(k)] = node_type(start, count/2, level + 1);
+            nodes[getRight(k)] = node_type(start + count/2,
+                count - count/2, level + 1);
+          }
+          /* otherwise degenerate, usually when all points are identical or
+           * one has negligible weight, so that they cannot be partitioned
+           * spatially; the node remains a prune node */
+        }
+      }
+    }
+  }
+
+  /* copy samples in leaf order */
+  this->X.resize(P, N);
+  this->lw.resize(P);
+  #pragma omp parallel for private(i)
+  for (j = 0; j < N; ++j) {
+    for (i = 0; i < P; ++i) {
+      this->X(i, j) = X(is(i), j);
     }
   }
+  for (i = 0; i < P; ++i) {
+    this->lw(i) = lw(is(i));
+  }
 
-  return result;
+  bound(depth);
+}
+
+template<class V1, class M1>
+void bi::KDTree<V1,M1>::bound(const int depth) {
+  const int N = X.size2();
+  int level;
+
+  lower.resize(N, nodes.size());
+  upper.resize(N, nodes.size());
+
+  for (level = depth; level >= 0; --level) {
+    const int first = (1 << level) - 1;
+    const int last = (1 << (level + 1)) - 1;
+    int k;
+
+    #pragma omp parallel for
+    for (k = first; k < last; ++k) {
+      const node_type& node = nodes[k];
+      BOOST_AUTO(lower, column(this->lower, k));
+      BOOST_AUTO(upper, column(this->upper, k));
+      int i, j;
+
+      if (node.isInternal()) {
+        BOOST_AUTO(leftLower, column(this->lower, getLeft(k)));
+        BOOST_AUTO(leftUpper, column(this->upper, getLeft(k)));
+        BOOST_AUTO(rightLower, column(this->lower, getRight(k)));
+        BOOST_AUTO(rightUpper, column(this->upper, getRight(k)));
+
+        for (j = 0; j < N; ++j) {
+          lower(j) = bi::min(leftLower(j), rightLower(j));
+          upper(j) = bi::max(leftUpper(j), rightUpper(j));
+        }
+      } else if (!node.isEmpty()) {
+        BOOST_AUTO(Y, getValues(k));
+        for (j = 0; j < N; ++j) {
+          lower(j) = Y(0, j);
+          upper(j) = Y(0, j);
+          for (i = 1; i < Y.size1(); ++i) {
+            lower(j) = bi::min(lower(j), Y(i, j));
+            upper(j) = bi::max(upper(j), Y(i, j));
+          }
+        }
+      }
+    }
+  }
 }
 
 #ifndef __CUDACC__
 template<class V1, class M1>
 template<class Archive>
-void bi::KDTree<V1,M1>::save(Archive& ar, const int version) const {
-  const bool haveRoot = (root != NULL);
-  ar & haveRoot;
-  if (haveRoot) {
-    ar & root;
-  }
+void bi::KDTree<V1,M1>::save(Archive& ar, const unsigned version) const {
+  save_resizable_matrix(ar, version, X);
+  save_resizable_vector(ar, version, lw);
+  save_resizable_vector(ar, version, is);
+  save_resizable_matrix(ar, version, lower);
+  save_resizable_matrix(ar, version, upper);
+  ar & nodes;
 }
 
 template<class V1, class M1>
 template<class Archive>
-void bi::KDTree<V1,M1>::load(Archive& ar, const int version) {
-  bool haveRoot = false;
-  
-  if (root != NULL) {
-    delete root;
-    root = NULL;
-  }
-  
-  ar & haveRoot;
-  if (haveRoot) {
-    ar & root;
-  }
+void bi::KDTree<V1,M1>::load(Archive& ar, const unsigned version) {
+  load_resizable_matrix(ar, version, X);
+  load_resizable_vector(ar, version, lw);
+  load_resizable_vector(ar, version, is);
+  load_resizable_matrix(ar, version, lower);
+  load_resizable_matrix(ar, version, upper);
+  ar & nodes;
 }
 #endif
+
 #endif
@@ -37,7 +37,21 @@ public:
   template<class V1>
   Partition assign(const V1 x) const;
 
+  /**
+   * @copydoc #concept::Partitioner::split()
+   */
+  template<class M1, class V1>
+  bool split(const M1 X, V1 is);
+
 private:
+  /**
+   * Select the dimension with greatest range.
+   *
+   * @return Range along the selected dimension.
+   */
+  template<class M1, class V1>
+  real longest(const M1 X, const V1 is);
+
   /**
    * Index of the dimension on which to split.
    */
@@ -52,15 +66,71 @@ private:
 
 #include "../primitive/vector_primitive.hpp"
 
+#include <algorithm>
+
+namespace bi {
+/**
+ * Orders indices of rows of a matrix by their value in one column.
+ *
+ * @ingroup kd
+ *
+ * @tparam M1 Matrix type.
+ */
+template<class M1>
+struct median_less {
+  const M1 X;
+  const int j;
+
+  median_less(const M1 X, const int j) : X(X), j(j) {
+    //
+  }
+
+  bool operator()(const int i1, const int i2) const {
+    return X(i1, j) < X(i2, j);
+  }
+};
+}
+
 template<class M1, class V1>
 bool bi::MedianPartitioner::init(const M1 X, const V1 is) {
   /* pre-condition */
   BI_ASSERT(is.size() >= 2);
 
-  int i, j, longest = 0;
+  real maxlen = longest(X, is);
+
+  /* split on median of selected dimension */
+  temp_host_vector<real>::type values(is.size());
+  bi::gather(is, column(X,index), values);
+  int median = values.size()/2;
+  std::nth_element(values.begin(), values.begin() + median, values.end());
+
+  this->value = values(median);
+
+  return maxlen > 0.0;
+}
+
+template<class M1, class V1>
+bool bi::MedianPartitioner::split(const M1 X, V1 is) {
+  /* pre-condition */
+  BI_ASSERT(is.size() >= 2);
+  BI_ASSERT(is.inc() == 1);
+
+  real maxlen = longest(X, is);
+  if (maxlen > 0.0) {
+    int median = is.size()/2;
+    std::nth_element(is.buf(), is.buf() + median, is.buf() + is.size(),
+        median_less<M1>(X, index));
+    this->value = X(is(median), index);
+  }
+  return maxlen > 0.0;
+}
+
+template<class M1, class V1>
+real bi::MedianPartitioner::longest(const M1 X, const V1 is) {
+  int i, j;
   real mn, mx, x, maxlen = 0.0;
 
-  /* select longest dimension */
+  index = 0;
   for (j = 0; j < X.size2(); ++j) {
     mn = X(is[0], j);
     mx = mn;
@@ -71,20 +141,10 @@ bool bi::MedianPartitioner::init(const M1 X, const V1 is) {
     }
     if (mx - mn > maxlen) {
       maxlen = mx - mn;
-      longest = j;
+      index = j;
     }
   }
-
-  /* split on median of selected dimension */
-  temp_host_vector<real>::type values(is.size());
-  bi::gather(is, column(X,longest), values);
-  int median = values.size()/2;
-  std::nth_element(values.begin(), values.begin() + median, values.end());
-
-  this->value = values(median);
-  this->index = longest;
-
-  return maxlen > 0.0;
+  return maxlen;
 }
 
 template<class V1>
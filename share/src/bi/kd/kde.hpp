@@ -57,8 +57,9 @@ double hopt(const int N, const int P);
  * @param clear Clear @p p before computations?
  */
 template<class V1, class M1, class V2, class M2, class K1, class V3>
-void dualTreeDensity(KDTree<V1,M1>& queryTree, KDTree<V2,M2>& targetTree,
-    const K1& K, V3 p, const bool clear = true);
+void dualTreeDensity(const KDTree<V1,M1>& queryTree,
+    const KDTree<V2,M2>& targetTree, const K1& K, V3 p,
+    const bool clear = true);
 
 /**
  * Self-tree kernel density evaluation.
@@ -115,208 +116,125 @@ void dualTreeDensity(KDTree<V1,M1>& queryTree, KDTree<V2,M2>& targetTree,
 
 #include "../math/temp_vector.hpp"
 #include "../math/temp_matrix.hpp"
-#include "../math/sim_temp_vector.hpp"
-#include "../math/sim_temp_matrix.hpp"
+#include "../primitive/matrix_primitive.hpp"
+#include "../misc/omp.hpp"
 
-#include <list>
-#include <stack>
+#include <vector>
+#include <utility>
 
 inline double bi::hopt(const int N, const int P) {
   return std::pow(4.0 / ((N + 2) * P), 1.0 / (N + 4));
 }
 
 template<class V1, class M1, class V2, class M2, class K1, class V3>
-void bi::dualTreeDensity(KDTree<V1,M1>& queryTree, KDTree<V2,M2>& targetTree,
-    const K1& K, V3 p, const bool clear) {
-  typedef typename KDTree<V1,M1>::var_type query_var_type;
-  typedef typename KDTree<V2,M2>::var_type target_var_type;
+void bi::dualTreeDensity(const KDTree<V1,M1>& queryTree,
+    const KDTree<V2,M2>& targetTree, const K1& K, V3 p, const bool clear) {
+  typedef std::pair<int,int> pair_type;
 
-  BOOST_AUTO(queryRoot, queryTree.getRoot());
-  BOOST_AUTO(targetRoot, targetTree.getRoot());
   if (clear) {
     p.clear();
   }
-  if (queryRoot != NULL && targetRoot != NULL) {
-#if defined(ENABLE_OPENMP) and defined(HAVE_OMP_H)
-    omp_lock_t lock;
-    omp_init_lock(&lock);
-#endif
-
+  if (!queryTree.isEmpty() && !targetTree.isEmpty()) {
     /* start with breadth first search to build reasonable work set for
      * division between threads */
-    std::list<const query_var_type*> queryNodes1;
-    std::list<const target_var_type*> targetVars1;
-    queryNodes1.push_back(queryRoot);
-    targetVars1.push_back(targetRoot);
-
-    sim_temp_vector<M1> x(queryTree.getSize());
-    bool done = false;
-#if defined(ENABLE_OPENMP) and defined(HAVE_OMP_H)
-    while (!done && (int)queryNodes1.size() < 64*omp_get_max_threads()) {
-#else
-    while (!done) {
-#endif
-      BOOST_AUTO(queryNode, queryNodes1.front());
-      BOOST_AUTO(targetVar, targetVars1.front());
+    std::vector<pair_type> work;
+    typename temp_host_vector<real>::type x1(queryTree.getSize());
+    BOOST_AUTO(x, x1.ref());
+    int front = 0, query, target;
 
-      done = queryNode == NULL || !queryNode->isInternal()
-          || targetVar == NULL || !targetVar->isInternal();
-      if (!done) {
-        targetVar->difference(*queryNode, *x);
-        if (K(*x) > 0.0) {
-          queryNodes1.push_back(queryNode->getLeft());
-          targetVars1.push_back(targetVar->getLeft());
-
-          queryNodes1.push_back(queryNode->getLeft());
-          targetVars1.push_back(targetVar->getRight());
-
-          queryNodes1.push_back(queryNode->getRight());
-          targetVars1.push_back(targetVar->getLeft());
+    work.push_back(pair_type(queryTree.getRoot(), targetTree.getRoot()));
+    while (front < (int)work.size() &&
+        (int)work.size() - front < 64*bi_omp_max_threads) {
+      query = work[front].first;
+      target = work[front].second;
+      if (!queryTree.getNode(query).isInternal() ||
+          !targetTree.getNode(target).isInternal()) {
+        break;
+      }
+      ++front;
 
-          queryNodes1.push_back(queryNode->getRight());
-          targetVars1.push_back(targetVar->getRight());
-        }
-        queryNodes1.pop_front();
-        targetVars1.pop_front();
-        done = queryNodes1.empty();
+      targetTree.difference(target, queryTree, query, x);
+      if (K(x) > 0.0) {
+        work.push_back(pair_type(queryTree.getLeft(query),
+            targetTree.getLeft(target)));
+        work.push_back(pair_type(queryTree.getLeft(query),
+            targetTree.getRight(target)));
+        work.push_back(pair_type(queryTree.getRight(query),
+            targetTree.getLeft(target)));
+        work.push_back(pair_type(queryTree.getRight(query),
+            targetTree.getRight(target)));
       }
     }
+    work.erase(work.begin(), work.begin() + front);
 
-    /* now multithread */
-#if defined(ENABLE_OPENMP) and defined(HAVE_OMP_H)
-    typename temp_host_matrix<real>::type P(p.size(), omp_get_max_threads());
-#else
-    typename temp_host_matrix<real>::type P(p.size(), 1);
-#endif
+    /* now multithread; threads claim items of the work set dynamically,
+     * each descending from its items depth first and accumulating into its
+     * own column of P, so that no locks are required */
+    typename temp_host_matrix<real>::type P(p.size(), bi_omp_max_threads);
     P.clear();
 
-#pragma omp parallel
+    #pragma omp parallel
     {
-#if defined(ENABLE_OPENMP) and defined(HAVE_OMP_H)
-      int nthreads = omp_get_num_threads();
-      int tid = omp_get_thread_num();
-#else
-      int nthreads = 1;
-      int tid = 0;
-#endif
-      typename V2::value_type q;
-      int i, j;
-
-#if defined(ENABLE_OPENMP) and defined(HAVE_OMP_H)
-      omp_set_lock (&lock);
-#endif
-      sim_temp_vector<M1> x1(queryTree.getSize());
-#if defined(ENABLE_OPENMP) and defined(HAVE_OMP_H)
-      omp_unset_lock(&lock);
-#endif
+      std::vector<pair_type> stack;
+      typename temp_host_vector<real>::type x1(queryTree.getSize());
       BOOST_AUTO(x, x1.ref());
+      BOOST_AUTO(q, column(P, bi_omp_tid));
+      int w, query, target, i;
 
-      /* take share of nodes */
-      std::list<const query_var_type*> queryNodes;  // list or vector appears ~6% faster than stack
-      std::list<const target_var_type*> targetVars;
-      BOOST_AUTO(queryIter, queryNodes1.begin());
-      BOOST_AUTO(targetIter, targetVars1.begin());
-      i = 0;
-      while (queryIter != queryNodes1.end()) {
-        if ((i - tid) % nthreads == 0) {
-          queryNodes.push_back(*queryIter);
-          targetVars.push_back(*targetIter);
-        }
-        ++i;
-        ++queryIter;
-        ++targetIter;
-      }
-
-      /* traverse tree */
-      while (!queryNodes.empty()) {
-        BOOST_AUTO(queryNode, queryNodes.back());
-        BOOST_AUTO(targetVar, targetVars.back());
-        queryNodes.pop_back();
-        targetVars.pop_back();
+      #pragma omp for schedule(dynamic)
+      for (w = 0; w < (int)work.size(); ++w) {
+        stack.push_back(work[w]);
 
-        if (queryNode->isInternal() || targetVar->isInternal()) {
-          /* should we recurse? */
-          targetVar->difference(*queryNode, x);
-          if (K(x) > 0.0) {
-            if (queryNode->isInternal()) {
-              if (targetVar->isInternal()) {
-                /* split both query and target nodes */
-                queryNodes.push_back(queryNode->getLeft());
-                targetVars.push_back(targetVar->getLeft());
+        /* traverse tree */
+        while (!stack.empty()) {
+          query = stack.back().first;
+          target = stack.back().second;
+          stack.pop_back();
 
-                queryNodes.push_back(queryNode->getLeft());
-                targetVars.push_back(targetVar->getRight());
+          const KDTreeNode& queryNode = queryTree.getNode(query);
+          const KDTreeNode& targetNode = targetTree.getNode(target);
 
-                queryNodes.push_back(queryNode->getRight());
-                targetVars.push_back(targetVar->getLeft());
-
-                queryNodes.push_back(queryNode->getRight());
-                targetVars.push_back(targetVar->getRight());
+          if (queryNode.isInternal() || targetNode.isInternal()) {
+            /* should we recurse? */
+            targetTree.difference(target, queryTree, query, x);
+            if (K(x) > 0.0) {
+              if (queryNode.isInternal()) {
+                if (targetNode.isInternal()) {
+                  /* split both query and target nodes */
+                  stack.push_back(pair_type(queryTree.getLeft(query),
+                      targetTree.getLeft(target)));
+                  stack.push_back(pair_type(queryTree.getLeft(query),
+                      targetTree.getRight(target)));
+                  stack.push_back(pair_type(queryTree.getRight(query),
+                      targetTree.getLeft(target)));
+                  stack.push_back(pair_type(queryTree.getRight(query),
+                      targetTree.getRight(target)));
+                } else {
+                  /* split query node only */
+                  stack.push_back(pair_type(queryTree.getLeft(query), target));
+                  stack.push_back(pair_type(queryTree.getRight(query), target));
+                }
               } else {
-                /* split query node only */
-                queryNodes.push_back(queryNode->getLeft());
-                targetVars.push_back(targetVar);
-
-                queryNodes.push_back(queryNode->getRight());
-                targetVars.push_back(targetVar);
+                /* split target node only */
+                stack.push_back(pair_type(query, targetTree.getLeft(target)));
+                stack.push_back(pair_type(query, targetTree.getRight(target)));
               }
-            } else {
-              /* split target node only */
-              queryNodes.push_back(queryNode);
-              targetVars.push_back(targetVar->getLeft());
-
-              queryNodes.push_back(queryNode);
-              targetVars.push_back(targetVar->getRight());
-            }
-          }
-        } else {
-          if (queryNode->isLeaf() && targetVar->isLeaf()) {
-            i = queryNode->getIndex();
-            x = queryNode->getValue();
-            axpy(-1.0, targetVar->getValue(), x);
-            q = bi::exp(targetVar->getLogWeight() + K.logDensity(x));
-            P(i, tid) += q;
-          } else if (queryNode->isLeaf() && targetVar->isPrune()) {
-            i = queryNode->getIndex();
-            q = 0.0;
-            for (j = 0; j < targetVar->getCount(); ++j) {
-              x = queryNode->getValue();
-              axpy(-1.0, column(targetVar->getValues(), j), x);
-              q += bi::exp(targetVar->getLogWeights()(j) + K.logDensity(x));
             }
-            P(i, tid) += q;
-          } else if (queryNode->isPrune() && targetVar->isLeaf()) {
-            const std::vector<int>& is = queryNode->getIndices();
-            for (i = 0; i < (int)is.size(); ++i) {
-              x = column(queryNode->getValues(), i);
-              axpy(-1.0, targetVar->getValue(), x);
-              q = bi::exp(targetVar->getLogWeight() + K.logDensity(x));
-              P(is[i], tid) += q;
-            }
-          } else if (queryNode->isPrune() && targetVar->isPrune()) {
-            const std::vector<int>& is = queryNode->getIndices();
-            for (i = 0; i < queryNode->getCount(); ++i) {
-              q = 0.0;
-              for (j = 0; j < targetVar->getCount(); ++j) {
-                x = column(queryNode->getValues(), i);
-                axpy(-1.0, column(targetVar->getValues(), j), x);
-                q += bi::exp(targetVar->getLogWeights()(j) + K.logDensity(x));
-              }
-              P(is[i], tid) += q;
+          } else {
+            /* terminal nodes, samples of each are contiguous */
+            BOOST_AUTO(X, queryTree.getValues(query));
+            BOOST_AUTO(Y, targetTree.getValues(target));
+            BOOST_AUTO(lw, targetTree.getLogWeights(target));
+
+            for (i = 0; i < X.size1(); ++i) {
+              q(queryTree.getIndex(queryNode.getStart() + i)) +=
+                  K.sum(row(X, i), Y, lw);
             }
           }
         }
       }
-
-#if defined(ENABLE_OPENMP) and defined(HAVE_OMP_H)
-      omp_set_lock(&lock);
-      omp_unset_lock(&lock);
-#endif
     }
     sum_columns(P, p);
-#if defined(ENABLE_OPENMP) and defined(HAVE_OMP_H)
-    omp_destroy_lock (&lock);
-#endif
   }
 }
 
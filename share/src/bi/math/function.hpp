@@ -32,6 +32,10 @@ CUDA_FUNC_BOTH double exp(const double x);
 CUDA_FUNC_BOTH float exp(const float x);
 CUDA_FUNC_BOTH double nanexp(const double x);
 CUDA_FUNC_BOTH float nanexp(const float x);
+CUDA_FUNC_BOTH double log1p(const double x);
+CUDA_FUNC_BOTH float log1p(const float x);
+CUDA_FUNC_BOTH double expm1(const double x);
+CUDA_FUNC_BOTH float expm1(const float x);
 CUDA_FUNC_BOTH double max(const double x, const double y);
 CUDA_FUNC_BOTH float max(const float x, const float y);
 CUDA_FUNC_BOTH double min(const double x, const double y);
@@ -155,6 +159,22 @@ inline float bi::nanexp(const float x) {
   return bi::isnan(x) ? 0.0f : bi::exp(x);
 }
 
+inline double bi::log1p(const double x) {
+  return ::log1p(x);
+}
+
+inline float bi::log1p(const float x) {
+  return ::log1pf(x);
+}
+
+inline double bi::expm1(const double x) {
+  return ::expm1(x);
+}
+
+inline float bi::expm1(const float x) {
+  return ::expm1f(x);
+}
+
 inline double bi::max(const double x, const double y) {
   return ::fmax(x, y);
 }
@@ -112,6 +112,9 @@ void multi_matrix_scal(const int P, typename M1::value_type alpha, M1 X);
  * Multiple #condition.
  *
  * @ingroup math_multi_op
+ *
+ * @p x2 may be a single vector, common to all @p P, or a multi-vector of
+ * the same size as @p mu2, with a separate vector for each.
  */
 template<class V1, class M1, class V2, class M2, class M3, class V3>
 void multi_condition(const int P, V1 mu1, M1 U1, const V2 mu2, const M2 U2,
@@ -595,22 +598,32 @@ void bi::multi_chol(const int P, const M1 A, M2 U, char uplo,
     const CholeskyStrategy strat) throw (CholeskyException) {
   BI_ASSERT(A.size1() == U.size1() && A.size2() == U.size2());
 
-  #pragma omp parallel
+  int nerrs = 0;
+
+  #pragma omp parallel reduction(+:nerrs)
   {
     typename sim_temp_matrix<M1>::type A1(A.size1()/P, A.size2());
     typename sim_temp_matrix<M2>::type U1(U.size1()/P, U.size2());
     int p;
 
     #pragma omp for
-    for (int p = 0; p < P; ++p) {
+    for (p = 0; p < P; ++p) {
       multi_get_matrix(P, A, p, A1);
       multi_get_matrix(P, U, p, U1);
 
-      chol(A1, U1, uplo, strat);
+      try {
+        chol(A1, U1, uplo, strat);
+      } catch (CholeskyException e) {
+        ++nerrs;
+      }
 
       multi_set_matrix(P, U, p, U1);
     }
   }
+
+  if (nerrs > 0) {
+    throw CholeskyException(0);
+  }
 }
 
 template<class M1, class M2>
@@ -654,9 +667,10 @@ void bi::multi_condition(const int P, V1 mu1, M1 U1, const V2 mu2, const M2 U2,
   BI_ASSERT(mu1.size() == U1.size1());
   BI_ASSERT(mu2.size() == U2.size1());
   BI_ASSERT(C.size1() == mu1.size() && P*C.size2() == mu2.size());
+  BI_ASSERT(P*x2.size() == mu2.size() || x2.size() == mu2.size());
 
   typename sim_temp_vector<V1>::type z2(mu2.size()), b(mu1.size());
-  typename sim_temp_matrix<M1>::type K(C.size1(), P*C.size2());
+  typename sim_temp_matrix<M1>::type K(C.size1(), C.size2());
 
   /**
    * Compute gain matrix:
@@ -671,7 +685,11 @@ void bi::multi_condition(const int P, V1 mu1, M1 U1, const V2 mu2, const M2 U2,
    *
    * \f[\boldsymbol{\mu}_1 \gets \boldsymbol{\mu}_1 + \mathbf{K}\mathbf{U}_2^{-1}(\mathbf{x}_2 - \boldsymbol{\mu}_2).\f]
    */
-  set_rows(reshape(vector_as_column_matrix(z2), P, z2.size()/P), x2);
+  if (x2.size() == mu2.size()) {
+    z2 = x2;
+  } else {
+    set_rows(reshape(vector_as_column_matrix(z2), P, z2.size()/P), x2);
+  }
   axpy(-1.0, mu2, z2);
   multi_trsv(P, U2, z2, 'U', 'T');
   multi_gemv(P, 1.0, K, z2, 1.0, mu1);
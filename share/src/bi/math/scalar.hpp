@@ -19,6 +19,19 @@ typedef float real;
 typedef double real;
 #endif
 
+/**
+ * Value type for log-weights and their reductions, float or double. This is
+ * the same as #real, except in mixed precision mode, where states and their
+ * dynamics are in single precision but weights are kept in double precision,
+ * as rounding error in their accumulation over long time series otherwise
+ * dominates.
+ */
+#if defined(ENABLE_SINGLE) && !defined(ENABLE_MIXED)
+typedef float wreal;
+#else
+typedef double wreal;
+#endif
+
 /**
  * @def BI_REAL
  *
@@ -0,0 +1,142 @@
+/**
+ * @file
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ */
+#ifndef BI_MISC_THREAD_HPP
+#define BI_MISC_THREAD_HPP
+
+#include "assert.hpp"
+
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+
+namespace bi {
+/**
+ * Background thread for a single task.
+ *
+ * @ingroup misc
+ *
+ * Runs a task concurrently with the calling thread, outside of any OpenMP
+ * team, so that parallel regions entered by the calling thread in the
+ * meantime are unaffected. This is used to overlap disk output with
+ * computation. Without POSIX threads the task is run synchronously in
+ * start().
+ *
+ * The task must not use thread-local resources of the library, such as
+ * pooled allocators, as it does not have a thread id of its own.
+ */
+class Thread {
+public:
+  /**
+   * Constructor.
+   */
+  Thread();
+
+  /**
+   * Destructor. Waits for any running task to complete.
+   */
+  ~Thread();
+
+  /**
+   * Start task.
+   *
+   * @tparam F Functor type, with <tt>void operator()()</tt>.
+   *
+   * @param f Task. Must remain valid until join() returns.
+   *
+   * Waits for any previous task to complete before starting the new task.
+   */
+  template<class F>
+  void start(F& f);
+
+  /**
+   * Wait for task to complete.
+   */
+  void join();
+
+  /**
+   * Is a task running, or has it completed without being joined?
+   */
+  bool joinable() const;
+
+private:
+  /**
+   * Copy constructor (deliberately undefined).
+   */
+  Thread(const Thread& o);
+
+  /**
+   * Assignment operator (deliberately undefined).
+   */
+  Thread& operator=(const Thread& o);
+
+  /**
+   * Entry point of thread.
+   */
+  template<class F>
+  static void* run(void* f);
+
+  #ifdef HAVE_PTHREAD_H
+  /**
+   * Thread handle.
+   */
+  pthread_t thread;
+  #endif
+
+  /**
+   * Has a task been started and not yet joined?
+   */
+  bool started;
+};
+}
+
+inline bi::Thread::Thread() :
+    started(false) {
+  //
+}
+
+inline bi::Thread::~Thread() {
+  join();
+}
+
+template<class F>
+inline void bi::Thread::start(F& f) {
+  join();
+  #ifdef HAVE_PTHREAD_H
+  int err = pthread_create(&thread, NULL, &Thread::run<F>, &f);
+  if (err == 0) {
+    started = true;
+  } else {
+    /* fall back to synchronous execution */
+    f();
+  }
+  #else
+  f();
+  #endif
+}
+
+inline void bi::Thread::join() {
+  #ifdef HAVE_PTHREAD_H
+  if (started) {
+    int err = pthread_join(thread, NULL);
+    BI_ERROR_MSG(err == 0, "could not join background thread");
+    started = false;
+  }
+  #endif
+}
+
+inline bool bi::Thread::joinable() const {
+  return started;
+}
+
+template<class F>
+void* bi::Thread::run(void* f) {
+  (*static_cast<F*>(f))();
+  return NULL;
+}
+
+#endif
@@ -43,6 +43,19 @@
 #define BI_UNUSED
 #endif
 
+/**
+ * @def BI_PREFETCH
+ *
+ * Hint that memory will soon be read, so that it may be brought into cache.
+ *
+ * @arg ptr Address.
+ */
+#if defined(__GNUC__)
+#define BI_PREFETCH(ptr) __builtin_prefetch(ptr)
+#else
+#define BI_PREFETCH(ptr)
+#endif
+
 /**
  * @def BI_THREAD
  *
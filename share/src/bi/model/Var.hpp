@@ -61,6 +61,12 @@ public:
    */
   bool getOutputOnce() const;
 
+  /**
+   * Should only summary statistics of the variable be output, not its value
+   * for each particle?
+   */
+  bool getOutputSummary() const;
+
   /**
    * Get id of the variable.
    *
@@ -143,6 +149,11 @@ protected:
    */
   bool once;
 
+  /**
+   * Output summary statistics only?
+   */
+  bool summary;
+
   /**
    * Type.
    */
@@ -184,6 +195,7 @@ bi::Var::Var(const X& o) {
   this->inputName = o.getInputName();
   this->outputName = o.getOutputName();
   this->once = o.getOutputOnce();
+  this->summary = o.getOutputSummary();
   this->type = var_type<X>::value;
   this->id = var_id<X>::value;
   this->start = var_start<X>::value;
@@ -208,6 +220,10 @@ inline bool bi::Var::getOutputOnce() const {
   return once;
 }
 
+inline bool bi::Var::getOutputSummary() const {
+  return summary;
+}
+
 inline int bi::Var::getId() const {
   return id;
 }
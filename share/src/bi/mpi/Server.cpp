@@ -11,6 +11,9 @@
 
 #include "boost/typeof/typeof.hpp"
 
+#include <algorithm>
+#include <unistd.h>
+
 bi::Server::Server(TreeNetworkNode& node) :
     node(node) {
   //
@@ -35,11 +38,14 @@ void bi::Server::close() throw (boost::mpi::exception) {
 }
 
 void bi::Server::disconnect(boost::mpi::communicator child,
-    boost::mpi::status status) {
+    MPI_Message message) {
   try {
-    child.recv(status.source(), status.tag());
+    int err = MPI_Mrecv(NULL, 0, MPI_BYTE, &message, MPI_STATUS_IGNORE);
+    if (err != MPI_SUCCESS) {
+      boost::throw_exception(boost::mpi::exception("MPI_Mrecv", err));
+    }
     MPI_Comm comm(child);
-    int err = MPI_Comm_disconnect(&comm);
+    err = MPI_Comm_disconnect(&comm);
     if (err != MPI_SUCCESS) {
       boost::throw_exception(
           boost::mpi::exception("MPI_Comm_disconnect", err));
@@ -48,3 +54,36 @@ void bi::Server::disconnect(boost::mpi::communicator child,
     //
   }
 }
+
+void bi::Server::backoff(const int idle) {
+  /* sleep for 1us after the first idle sweep, doubling each sweep
+   * thereafter, up to 1ms */
+  static const int MAX_SHIFT = 10;
+  if (idle > 0) {
+    usleep(1 << std::min(idle - 1, MAX_SHIFT));
+  }
+}
+
+void bi::Server::test() {
+#pragma omp critical(TreeNetworkNode)
+  {
+    BOOST_AUTO(prev, node.requests.before_begin());
+    BOOST_AUTO(iter, node.requests.begin());
+    while (iter != node.requests.end()) {
+      try {
+        if (iter->test()) {
+          iter = node.requests.erase_after(prev);
+        } else {
+          prev = iter++;
+        }
+      } catch (boost::mpi::exception e) {
+        iter = node.requests.erase_after(prev);
+      }
+    }
+
+    /* release serialized messages once no longer needed */
+    if (node.requests.empty()) {
+      node.archives.clear();
+    }
+  }
+}
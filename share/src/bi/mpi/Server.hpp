@@ -13,6 +13,9 @@
 
 #include "boost/typeof/typeof.hpp"
 
+#include <vector>
+#include <algorithm>
+
 namespace bi {
 /**
  * Server.
@@ -22,6 +25,17 @@ namespace bi {
  * Call open() to open a port, getPortName() to recover that port for child
  * processes, and finally run() to run the server, giving an appropriate
  * handler for incoming messages.
+ *
+ * Messages are matched with MPI_Improbe() and dispatched as OpenMP tasks,
+ * so that the remaining threads of the team act as a pool of handler
+ * threads, each receiving its message with MPI_Mrecv(). At most one message
+ * from each child is in flight at any time, preserving the order of
+ * messages from the same child. When no messages are pending, the server
+ * backs off exponentially rather than spinning. If MPI has not been
+ * initialised with @c MPI_THREAD_MULTIPLE, messages are handled
+ * synchronously by the serving thread instead.
+ *
+ * The handler must be safe to call concurrently for different children.
  */
 class Server {
 public:
@@ -84,11 +98,24 @@ private:
    * Disconnect child.
    *
    * @param child The child.
-   * @param status Status from probe that led to disconnect.
+   * @param message Message from matched probe that led to disconnect.
    *
    * Used for a bilateral disconnect.
    */
-  void disconnect(boost::mpi::communicator child, boost::mpi::status status);
+  void disconnect(boost::mpi::communicator child, MPI_Message message);
+
+  /**
+   * Back off while idle.
+   *
+   * @param idle Number of consecutive sweeps over children without
+   * receiving a message.
+   */
+  static void backoff(const int idle);
+
+  /**
+   * Clean up outstanding requests.
+   */
+  void test();
 
   /**
    * Port as written by MPI_Open_port.
@@ -142,8 +169,13 @@ void bi::Server::accept(H& handler) {
 
           boost::mpi::communicator child(comm, boost::mpi::comm_attach);
           handler.init(child);
-          BOOST_AUTO(iter, node.children.push_front(child));
-          if (++iter == node.children.end()) {
+          bool first;
+#pragma omp critical(TreeNetworkNode)
+          {
+            node.children.push_front(child);
+            first = ++node.children.begin() == node.children.end();
+          }
+          if (first) {
 #pragma omp task
             serve(handler);  // start serving children
           }
@@ -157,46 +189,94 @@ void bi::Server::accept(H& handler) {
 
 template<class H>
 void bi::Server::serve(H& handler) {
+  typedef std::pair<boost::mpi::communicator,MPI_Message> disconnect_type;
+
+  std::vector<disconnect_type> disconnects;
+  std::vector<MPI_Comm> dead;
+  MPI_Message message;
   MPI_Status status;
-  int flag, err;
+  int flag, err, level, idle = 0;
+  bool received;
+
+  err = MPI_Query_thread(&level);
+  if (err != MPI_SUCCESS) {
+    boost::throw_exception(boost::mpi::exception("MPI_Query_thread", err));
+  }
+  const bool multithreaded = level == MPI_THREAD_MULTIPLE;
 
   /* service messages */
   while (!node.children.empty()) {
-    BOOST_AUTO(prev, node.children.before_begin());
+    received = false;
+
+    /* match at most one message from each child, dispatching each to a
+     * handler thread */
     BOOST_AUTO(iter, node.children.begin());
-    for (; iter != node.children.end(); prev = iter++) {
+    for (; iter != node.children.end(); ++iter) {
       try {
-        err = MPI_Iprobe(MPI_ANY_SOURCE, MPI_ANY_TAG, *iter, &flag, &status);
-        /* use MPI_Iprobe and not iter->iprobe, as latter can't distinguish
-         * between error and no message */
-        ///@todo Use MPI_Improbe for multithreaded handler
+        /* use MPI_Improbe and not iter->iprobe, as latter can't distinguish
+         * between error and no message, and does not remove the message
+         * from the queue for a later receive by another thread */
+        err = MPI_Improbe(MPI_ANY_SOURCE, MPI_ANY_TAG, *iter, &flag,
+            &message, &status);
         if (err != MPI_SUCCESS) {
-          boost::throw_exception(boost::mpi::exception("MPI_Iprobe", err));
+          boost::throw_exception(boost::mpi::exception("MPI_Improbe", err));
         }
         if (flag) {
+          received = true;
           if (status.MPI_TAG == MPI_TAG_DISCONNECT) {
-            disconnect(*iter, status);
-            node.children.erase_after(prev);
+            disconnects.push_back(std::make_pair(*iter, message));
+          } else if (multithreaded) {
+            boost::mpi::communicator child(*iter);
+#pragma omp task firstprivate(child, message, status)
+            {
+              try {
+                handler.handle(child, message, status);
+              } catch (boost::mpi::exception e) {
+                //
+              }
+            }
           } else {
-            handler.handle(*iter, status);
+            handler.handle(*iter, message, status);
           }
         }
       } catch (boost::mpi::exception e) {
-        node.children.erase_after(prev);
+        dead.push_back(*iter);
       }
     }
+#pragma omp taskwait
 
-    /* clean up outstanding requests */
-    BOOST_AUTO(prevRequests, node.requests.before_begin());
-    BOOST_AUTO(iterRequests, node.requests.begin());
-    for (; iterRequests != node.requests.end(); prevRequests = iterRequests++) {
-      try {
-        if (iterRequests->test()) {
-          node.requests.erase_after(prevRequests);
+    /* disconnect children, only once no handler is using them */
+    BOOST_AUTO(iterDisconnects, disconnects.begin());
+    for (; iterDisconnects != disconnects.end(); ++iterDisconnects) {
+      dead.push_back(iterDisconnects->first);
+      disconnect(iterDisconnects->first, iterDisconnects->second);
+    }
+    disconnects.clear();
+    if (!dead.empty()) {
+#pragma omp critical(TreeNetworkNode)
+      {
+        BOOST_AUTO(prev, node.children.before_begin());
+        BOOST_AUTO(iter, node.children.begin());
+        while (iter != node.children.end()) {
+          if (std::find(dead.begin(), dead.end(), MPI_Comm(*iter))
+              != dead.end()) {
+            iter = node.children.erase_after(prev);
+          } else {
+            prev = iter++;
+          }
         }
-      } catch (boost::mpi::exception e) {
-        node.requests.erase_after(prevRequests);
       }
+      dead.clear();
+    }
+
+    /* clean up outstanding requests */
+    test();
+
+    /* back off if idle */
+    if (received) {
+      idle = 0;
+    } else {
+      backoff(idle++);
     }
   }
 }
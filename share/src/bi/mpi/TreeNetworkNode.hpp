@@ -11,6 +11,8 @@
 #include "mpi.hpp"
 #include "../primitive/forward_list.hpp"
 
+#include "boost/shared_ptr.hpp"
+
 namespace bi {
 /**
  * Node of a tree-structure network.
@@ -41,6 +43,15 @@ struct TreeNetworkNode {
    * @todo Thread-safe forward list implementation.
    */
   forward_list<boost::mpi::request> requests;
+
+  /**
+   * Serialized messages of outstanding requests. A message sent to several
+   * processes is serialized once and shared between their requests. These
+   * are released once all outstanding requests have completed.
+   *
+   * @todo Thread-safe forward list implementation.
+   */
+  forward_list<boost::shared_ptr<boost::mpi::packed_oarchive> > archives;
 };
 }
 
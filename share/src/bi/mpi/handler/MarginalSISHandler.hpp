@@ -20,6 +20,10 @@ namespace bi {
  * @tparam B Model type.
  * @tparam A Adapter type.
  * @tparam S Stopper type.
+ *
+ * Messages from different children may be handled concurrently. Each
+ * message is received by the calling thread, while updates to the adapter,
+ * stopper and network node are serialised.
  */
 template<class B, class A, class S>
 class MarginalSISHandler {
@@ -52,18 +56,39 @@ public:
    * Handle message from a child.
    *
    * @param child Intercommunicator associated with the child.
-   * @param status Status of the probe that detected the message.
+   * @param message Message from the matched probe that detected it.
+   * @param status Status of the matched probe that detected the message.
    */
-  void handle(boost::mpi::communicator child, boost::mpi::status status);
+  void handle(boost::mpi::communicator child, MPI_Message message,
+      MPI_Status status);
 
 private:
   /*
    * Handlers for specific events.
    */
   void handleStopperLogWeights(boost::mpi::communicator child,
-      boost::mpi::status status);
+      MPI_Message message, MPI_Status status);
   void handleAdapterSamples(boost::mpi::communicator child,
-      boost::mpi::status status);
+      MPI_Message message, MPI_Status status);
+
+  /**
+   * Receive message of reals.
+   *
+   * @tparam V1 Vector type.
+   *
+   * @param message Message from matched probe.
+   * @param status Status of matched probe.
+   * @param[out] x Vector into which to receive. Resized as required.
+   */
+  template<class V1>
+  static void recv(MPI_Message message, MPI_Status status, V1& x);
+
+  /**
+   * Serialize the current proposal of the adapter.
+   *
+   * @param comm Communicator for which to serialize.
+   */
+  void pack(boost::mpi::communicator comm);
 
   /**
    * Model.
@@ -94,6 +119,12 @@ private:
    * Network node.
    */
   TreeNetworkNode& node;
+
+  /**
+   * Current proposal of the adapter, serialized once for sending to all
+   * children.
+   */
+  boost::shared_ptr<boost::mpi::packed_oarchive> proposal;
 };
 }
 
@@ -113,79 +144,132 @@ bool bi::MarginalSISHandler<B,A,S>::done() const {
 
 template<class B, class A, class S>
 void bi::MarginalSISHandler<B,A,S>::init(boost::mpi::communicator child) {
-  BOOST_AUTO(q, adapter.get(t));
-  node.requests.push_front(child.isend(0, MPI_TAG_ADAPTER_PROPOSAL, q));
+#pragma omp critical(MarginalSISHandler)
+  {
+    if (!proposal) {
+      pack(child);
+    }
+#pragma omp critical(TreeNetworkNode)
+    {
+      node.archives.push_front(proposal);
+      node.requests.push_front(
+          child.isend(0, MPI_TAG_ADAPTER_PROPOSAL, *proposal));
+    }
+  }
 }
 
 template<class B, class A, class S>
 void bi::MarginalSISHandler<B,A,S>::handle(boost::mpi::communicator child,
-    boost::mpi::status status) {
-  switch (status.tag()) {
+    MPI_Message message, MPI_Status status) {
+  switch (status.MPI_TAG) {
   case MPI_TAG_STOPPER_LOGWEIGHTS:
-    handleStopperLogWeights(child, status);
+    handleStopperLogWeights(child, message, status);
     break;
   case MPI_TAG_ADAPTER_SAMPLES:
-    handleAdapterSamples(child, status);
+    handleAdapterSamples(child, message, status);
     break;
   default:
     BI_WARN_MSG(false,
-        "Misbehaving child, out-of-sequence tag " << status.tag());
+        "Misbehaving child, out-of-sequence tag " << status.MPI_TAG);
   }
 }
 
 template<class B, class A, class S>
 void bi::MarginalSISHandler<B,A,S>::handleStopperLogWeights(
-    boost::mpi::communicator child, boost::mpi::status status) {
+    boost::mpi::communicator child, MPI_Message message, MPI_Status status) {
   typedef typename temp_host_vector<real>::type vector_type;
 
   double maxlw = BI_INF;
 
-  /* add weights */
-  boost::optional<int> n = status.template count<real>();
-  if (n) {
-    vector_type lws(*n);
-    child.recv(status.source(), status.tag(), lws.buf(), *n);
-    stopper.add(lws, maxlw);
-  }
+  /* receive weights */
+  vector_type lws(0);
+  recv(message, status, lws);
+
+#pragma omp critical(MarginalSISHandler)
+  {
+    /* add weights */
+    if (lws.size() > 0) {
+      stopper.add(lws, maxlw);
+    }
 
-  /* signal stop if necessary */
-  if (stopper.stop()) {
-    BOOST_AUTO(iter, node.children.begin());
-    for (; iter != node.children.end(); ++iter) {
-      node.requests.push_front(iter->isend(0, MPI_TAG_STOPPER_STOP));
+    /* signal stop if necessary */
+    if (stopper.stop()) {
+#pragma omp critical(TreeNetworkNode)
+      {
+        BOOST_AUTO(iter, node.children.begin());
+        for (; iter != node.children.end(); ++iter) {
+          node.requests.push_front(iter->isend(0, MPI_TAG_STOPPER_STOP));
+        }
+      }
     }
   }
 }
 
 template<class B, class A, class S>
 void bi::MarginalSISHandler<B,A,S>::handleAdapterSamples(
-    boost::mpi::communicator child, boost::mpi::status status) {
-  typedef typename temp_host_matrix<real>::type matrix_type;
+    boost::mpi::communicator child, MPI_Message message, MPI_Status status) {
+  typedef typename temp_host_vector<real>::type vector_type;
 
   static const int N = B::NP;
 
-  /* add samples */
-  boost::optional<int> n = status.template count<real>();
-  if (n) {
-    matrix_type Z(N + T, *n / (N + T));
-    child.recv(status.source(), status.tag(), Z.buf(), *n);
+  /* receive samples */
+  vector_type z(0);
+  recv(message, status, z);
+  BOOST_AUTO(Z,
+      reshape(vector_as_column_matrix(z), N + T, z.size() / (N + T)));
 
+#pragma omp critical(MarginalSISHandler)
+  {
+    /* add samples */
     for (int j = 0; j < Z.size2(); ++j) {
       adapter.add(subrange(column(Z,j), 0, N), subrange(column(Z,j), N, T));
     }
-  }
 
-  /* send new proposal if necessary */
-  if (adapter.stop(t)) {
-    adapter.adapt(t);
-    BOOST_AUTO(q, adapter.get(t));
-    BOOST_AUTO(iter, node.children.begin());
-    for (; iter != node.children.end(); ++iter) {
-      node.requests.push_front(iter->isend(0, MPI_TAG_ADAPTER_PROPOSAL, q));
+    /* send new proposal if necessary */
+    if (adapter.stop(t)) {
+      adapter.adapt(t);
+      pack(child);
+#pragma omp critical(TreeNetworkNode)
+      {
+        node.archives.push_front(proposal);
+        BOOST_AUTO(iter, node.children.begin());
+        for (; iter != node.children.end(); ++iter) {
+          node.requests.push_front(
+              iter->isend(0, MPI_TAG_ADAPTER_PROPOSAL, *proposal));
+        }
+      }
     }
-    ///@todo Serialize q into archive just once, then send to all. This may
-    ///be how broadcast is already implemented in Boost.MPI.
   }
 }
 
+template<class B, class A, class S>
+template<class V1>
+void bi::MarginalSISHandler<B,A,S>::recv(MPI_Message message,
+    MPI_Status status, V1& x) {
+  MPI_Datatype type = boost::mpi::get_mpi_datatype<real>();
+  int n, err;
+
+  err = MPI_Get_count(&status, type, &n);
+  if (err != MPI_SUCCESS) {
+    boost::throw_exception(boost::mpi::exception("MPI_Get_count", err));
+  }
+  if (n == MPI_UNDEFINED) {
+    n = 0;
+  }
+  x.resize(n);
+  err = MPI_Mrecv(x.buf(), n, type, &message, MPI_STATUS_IGNORE);
+  if (err != MPI_SUCCESS) {
+    boost::throw_exception(boost::mpi::exception("MPI_Mrecv", err));
+  }
+}
+
+template<class B, class A, class S>
+void bi::MarginalSISHandler<B,A,S>::pack(boost::mpi::communicator comm) {
+  /* a new archive rather than clearing the old, which may still be in use
+   * by outstanding requests */
+  BOOST_AUTO(q, adapter.get(t));
+  proposal.reset(new boost::mpi::packed_oarchive(comm));
+  *proposal << q;
+}
+
 #endif
@@ -64,6 +64,11 @@ enum MPITag {
   MPI_TAG_ADAPTER_PROPOSAL,
   MPI_TAG_ADAPTER_SAMPLES,
 
+  /*
+   * Sampler tags.
+   */
+  MPI_TAG_SAMPLER_SWAP,
+
   /*
    * Base tag index when redistributing particles.
    */
@@ -153,14 +153,14 @@ bool bi::DistributedResampler<R>::resample(Random& rng,
     TicToc clock;
 #endif
 
-    typename temp_host_matrix<real>::type Lws(P, size);
+    typename temp_host_matrix<wreal>::type Lws(P, size);
     typename temp_host_matrix<int>::type O(P, size);
     typename temp_host_vector<int>::type as1(P);
 
     /* gather weights to root */
     if (S1::on_device) {
       /* gather takes raw pointer, so need to copy to host */
-      typename temp_host_vector<real>::type lws1(P);
+      typename temp_host_vector<wreal>::type lws1(P);
       lws1 = s.logWeights();
       synchronize();
       boost::mpi::gather(world, lws1.buf(), P, vec(Lws).buf(), 0);
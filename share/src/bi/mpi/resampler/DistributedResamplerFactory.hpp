@@ -46,7 +46,8 @@ public:
    * Create Metropolis resampler.
    */
   static boost::shared_ptr<DistributedResampler<MetropolisResampler> > createMetropolisResampler(
-      const int B, const double essRel = 0.5, const bool anytime = false);
+      const int B, const double essRel = 0.5, const bool anytime = false,
+      const double bias = 0.01);
 
   /**
    * Create rejection resampler.
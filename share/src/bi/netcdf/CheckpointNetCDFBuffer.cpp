@@ -0,0 +1,141 @@
+/**
+ * @file
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ */
+#include "CheckpointNetCDFBuffer.hpp"
+
+bi::CheckpointNetCDFBuffer::CheckpointNetCDFBuffer(const Model& m,
+    const std::string& file, const FileMode mode) :
+    NetCDFBuffer(file, mode), m(m), npDim(-1), ndynDim(-1), ncommonDim(-1), nobsDim(
+        -1), nrngDim(-1), nwordDim(-1), dynVar(-1), commonVar(-1), lwVar(-1), liVar(
+        -1), tVar(-1), tInputVar(-1), tObsVar(-1), kVar(-1), kObsVar(-1), kOutputVar(
+        -1), llVar(-1), lpVar(-1), lqVar(-1), essVar(-1), rngVar(-1) {
+  //
+}
+
+void bi::CheckpointNetCDFBuffer::create(const size_t P, const size_t Y) {
+  /* pre-condition */
+  BI_ASSERT(P > 0);
+
+  const size_t ndyn = m.getNetSize(R_VAR) + m.getNetSize(D_VAR)
+      + m.getNetSize(DX_VAR);
+  const size_t ncommon = m.getNetSize(P_VAR) + m.getNetSize(PX_VAR)
+      + m.getNetSize(F_VAR) + m.getNetSize(O_VAR);
+
+  nc_redef(ncid);
+
+  nc_put_att(ncid, "libbi_schema", "Checkpoint");
+  nc_put_att(ncid, "libbi_schema_version", 1);
+  nc_put_att(ncid, "libbi_version", PACKAGE_VERSION);
+
+  /* dimensions, those of zero size omitted, as they would be unlimited */
+  npDim = nc_def_dim(ncid, "np", P);
+  if (ndyn > 0) {
+    ndynDim = nc_def_dim(ncid, "ndyn", ndyn);
+  }
+  if (ncommon > 0) {
+    ncommonDim = nc_def_dim(ncid, "ncommon", ncommon);
+  }
+  if (Y > 0) {
+    nobsDim = nc_def_dim(ncid, "nobs", Y);
+  }
+  nrngDim = nc_def_dim(ncid, "nrng", bi_omp_max_threads);
+  nwordDim = nc_def_dim(ncid, "nword", MersenneTwister::STATE_SIZE);
+
+  /* variables */
+  if (ndynDim >= 0) {
+    dynVar = nc_def_var(ncid, "dyn", NC_REAL, ndynDim, npDim);
+  }
+  if (ncommonDim >= 0) {
+    commonVar = nc_def_var(ncid, "common", NC_REAL, ncommonDim);
+  }
+  lwVar = nc_def_var(ncid, "logweight", NC_REAL, npDim);
+  if (nobsDim >= 0) {
+    liVar = nc_def_var(ncid, "logincrement", NC_DOUBLE, nobsDim);
+  }
+  tVar = nc_def_var(ncid, "time", NC_REAL);
+  tInputVar = nc_def_var(ncid, "time_input", NC_REAL);
+  tObsVar = nc_def_var(ncid, "time_obs", NC_REAL);
+  kVar = nc_def_var(ncid, "index_time", NC_INT);
+  kObsVar = nc_def_var(ncid, "index_obs", NC_INT);
+  kOutputVar = nc_def_var(ncid, "index_output", NC_INT);
+  llVar = nc_def_var(ncid, "loglikelihood", NC_DOUBLE);
+  lpVar = nc_def_var(ncid, "logprior", NC_DOUBLE);
+  lqVar = nc_def_var(ncid, "logproposal", NC_DOUBLE);
+  essVar = nc_def_var(ncid, "ess", NC_DOUBLE);
+  rngVar = nc_def_var(ncid, "rng", NC_INT, nrngDim, nwordDim);
+
+  nc_enddef(ncid);
+}
+
+void bi::CheckpointNetCDFBuffer::map() {
+  const size_t ndyn = m.getNetSize(R_VAR) + m.getNetSize(D_VAR)
+      + m.getNetSize(DX_VAR);
+  const size_t ncommon = m.getNetSize(P_VAR) + m.getNetSize(PX_VAR)
+      + m.getNetSize(F_VAR) + m.getNetSize(O_VAR);
+
+  /* dimensions */
+  npDim = nc_inq_dimid(ncid, "np");
+  BI_ERROR_MSG(npDim >= 0, "No dimension np in file " << file);
+  if (ndyn > 0) {
+    ndynDim = nc_inq_dimid(ncid, "ndyn");
+    BI_ERROR_MSG(ndynDim >= 0, "No dimension ndyn in file " << file);
+    BI_ERROR_MSG(nc_inq_dimlen(ncid, ndynDim) == ndyn,
+        "Dimension ndyn has length " << nc_inq_dimlen(ncid, ndynDim) << ", should be of length " << ndyn << ", in file " << file);
+  }
+  if (ncommon > 0) {
+    ncommonDim = nc_inq_dimid(ncid, "ncommon");
+    BI_ERROR_MSG(ncommonDim >= 0, "No dimension ncommon in file " << file);
+    BI_ERROR_MSG(nc_inq_dimlen(ncid, ncommonDim) == ncommon,
+        "Dimension ncommon has length " << nc_inq_dimlen(ncid, ncommonDim) << ", should be of length " << ncommon << ", in file " << file);
+  }
+  nobsDim = nc_inq_dimid(ncid, "nobs");
+  nrngDim = nc_inq_dimid(ncid, "nrng");
+  BI_ERROR_MSG(nrngDim >= 0, "No dimension nrng in file " << file);
+  nwordDim = nc_inq_dimid(ncid, "nword");
+  BI_ERROR_MSG(nwordDim >= 0, "No dimension nword in file " << file);
+  BI_ERROR_MSG(nc_inq_dimlen(ncid, nwordDim) ==
+      static_cast<size_t>(MersenneTwister::STATE_SIZE),
+      "Dimension nword has length " << nc_inq_dimlen(ncid, nwordDim) << ", should be of length " << MersenneTwister::STATE_SIZE << ", in file " << file);
+
+  /* variables */
+  if (ndynDim >= 0) {
+    dynVar = nc_inq_varid(ncid, "dyn");
+    BI_ERROR_MSG(dynVar >= 0, "No variable dyn in file " << file);
+  }
+  if (ncommonDim >= 0) {
+    commonVar = nc_inq_varid(ncid, "common");
+    BI_ERROR_MSG(commonVar >= 0, "No variable common in file " << file);
+  }
+  lwVar = nc_inq_varid(ncid, "logweight");
+  BI_ERROR_MSG(lwVar >= 0, "No variable logweight in file " << file);
+  if (nobsDim >= 0) {
+    liVar = nc_inq_varid(ncid, "logincrement");
+    BI_ERROR_MSG(liVar >= 0, "No variable logincrement in file " << file);
+  }
+  tVar = nc_inq_varid(ncid, "time");
+  BI_ERROR_MSG(tVar >= 0, "No variable time in file " << file);
+  tInputVar = nc_inq_varid(ncid, "time_input");
+  BI_ERROR_MSG(tInputVar >= 0, "No variable time_input in file " << file);
+  tObsVar = nc_inq_varid(ncid, "time_obs");
+  BI_ERROR_MSG(tObsVar >= 0, "No variable time_obs in file " << file);
+  kVar = nc_inq_varid(ncid, "index_time");
+  BI_ERROR_MSG(kVar >= 0, "No variable index_time in file " << file);
+  kObsVar = nc_inq_varid(ncid, "index_obs");
+  BI_ERROR_MSG(kObsVar >= 0, "No variable index_obs in file " << file);
+  kOutputVar = nc_inq_varid(ncid, "index_output");
+  BI_ERROR_MSG(kOutputVar >= 0, "No variable index_output in file " << file);
+  llVar = nc_inq_varid(ncid, "loglikelihood");
+  BI_ERROR_MSG(llVar >= 0, "No variable loglikelihood in file " << file);
+  lpVar = nc_inq_varid(ncid, "logprior");
+  BI_ERROR_MSG(lpVar >= 0, "No variable logprior in file " << file);
+  lqVar = nc_inq_varid(ncid, "logproposal");
+  BI_ERROR_MSG(lqVar >= 0, "No variable logproposal in file " << file);
+  essVar = nc_inq_varid(ncid, "ess");
+  BI_ERROR_MSG(essVar >= 0, "No variable ess in file " << file);
+  rngVar = nc_inq_varid(ncid, "rng");
+  BI_ERROR_MSG(rngVar >= 0, "No variable rng in file " << file);
+}
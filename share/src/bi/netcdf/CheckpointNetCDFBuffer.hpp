@@ -0,0 +1,378 @@
+/**
+ * @file
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ */
+#ifndef BI_NETCDF_CHECKPOINTNETCDFBUFFER_HPP
+#define BI_NETCDF_CHECKPOINTNETCDFBUFFER_HPP
+
+#include "NetCDFBuffer.hpp"
+#include "../model/Model.hpp"
+#include "../state/Schedule.hpp"
+#include "../random/Random.hpp"
+
+namespace bi {
+/**
+ * Buffer for saving and restoring the state of a particle filter, so that
+ * filtering may be resumed later, when more observations are available.
+ *
+ * @ingroup io_netcdf
+ *
+ * The file holds the particles and their log-weights, the marginal
+ * log-likelihood and its increments, the position in the time schedule,
+ * and the state of the random number generators on host. Those on device
+ * are not saved, and are seeded afresh on resumption.
+ */
+class CheckpointNetCDFBuffer: public NetCDFBuffer {
+public:
+  /**
+   * Constructor.
+   *
+   * @param m Model.
+   * @param file NetCDF file name.
+   * @param mode File open mode.
+   */
+  CheckpointNetCDFBuffer(const Model& m, const std::string& file = "",
+      const FileMode mode = READ_ONLY);
+
+  /**
+   * Write checkpoint.
+   *
+   * @tparam S1 State type.
+   *
+   * @param now Current position in time schedule.
+   * @param s State.
+   * @param rng Random number generator.
+   */
+  template<class S1>
+  void write(const ScheduleElement now, const S1& s, Random& rng);
+
+  /**
+   * Read checkpoint.
+   *
+   * @tparam S1 State type.
+   *
+   * @param sched Time schedule.
+   * @param[out] s State.
+   * @param[out] rng Random number generator.
+   *
+   * @return Position in @p sched at which the checkpoint was written.
+   *
+   * The schedule must agree with that of the run that wrote the checkpoint
+   * up to that position, in particular in the observations and outputs that
+   * precede it.
+   */
+  template<class S1>
+  ScheduleIterator read(const Schedule& sched, S1& s, Random& rng);
+
+private:
+  /**
+   * Set up structure of NetCDF file.
+   *
+   * @param P Number of particles.
+   * @param Y Number of observation times.
+   */
+  void create(const size_t P, const size_t Y);
+
+  /**
+   * Map structure of existing NetCDF file.
+   */
+  void map();
+
+  /**
+   * Write block of variables of one type.
+   *
+   * @tparam M1 Matrix type.
+   *
+   * @param varid Variable id.
+   * @param start Starting index of block in variable.
+   * @param X Block, one row per particle.
+   */
+  template<class M1>
+  void writeBlock(const int varid, const size_t start, const M1 X);
+
+  /**
+   * Read block of variables of one type.
+   *
+   * @tparam M1 Matrix type.
+   *
+   * @param varid Variable id.
+   * @param start Starting index of block in variable.
+   * @param[out] X Block, one row per particle.
+   */
+  template<class M1>
+  void readBlock(const int varid, const size_t start, M1 X);
+
+  /**
+   * Model.
+   */
+  const Model& m;
+
+  /**
+   * Particle dimension id.
+   */
+  int npDim;
+
+  /**
+   * Dimension ids of dynamic variables, common variables and observation
+   * times. Each is -1 if of zero size.
+   */
+  int ndynDim, ncommonDim, nobsDim;
+
+  /**
+   * Dimension ids of random number generators, and words of their state.
+   */
+  int nrngDim, nwordDim;
+
+  /**
+   * Variable ids of state blocks.
+   */
+  int dynVar, commonVar;
+
+  /**
+   * Variable ids of log-weights and log-likelihood increments.
+   */
+  int lwVar, liVar;
+
+  /**
+   * Variable ids of scalars.
+   */
+  int tVar, tInputVar, tObsVar, kVar, kObsVar, kOutputVar, llVar, lpVar,
+      lqVar, essVar;
+
+  /**
+   * Variable id of random number generator state.
+   */
+  int rngVar;
+};
+}
+
+#include "../math/view.hpp"
+#include "../math/temp_matrix.hpp"
+#include "../math/temp_vector.hpp"
+#include "../misc/omp.hpp"
+
+#include <algorithm>
+#include <vector>
+
+template<class S1>
+void bi::CheckpointNetCDFBuffer::write(const ScheduleElement now,
+    const S1& s, Random& rng) {
+  typedef typename temp_host_vector<real>::type temp_vector_type;
+
+  const size_t P = s.size();
+  const size_t Y = s.logIncrements.size();
+  const int W = MersenneTwister::STATE_SIZE;
+  std::vector<MersenneTwister::result_type> words(W);
+  std::vector<int> words1(W);
+  size_t start;
+  int i, k;
+  real t;
+
+  create(P, Y);
+
+  /* state */
+  start = 0;
+  writeBlock(dynVar, start, s.get(R_VAR));
+  start += m.getNetSize(R_VAR);
+  writeBlock(dynVar, start, s.get(D_VAR));
+  start += m.getNetSize(D_VAR);
+  writeBlock(dynVar, start, s.get(DX_VAR));
+
+  start = 0;
+  writeBlock(commonVar, start, s.get(P_VAR));
+  start += m.getNetSize(P_VAR);
+  writeBlock(commonVar, start, s.get(PX_VAR));
+  start += m.getNetSize(PX_VAR);
+  writeBlock(commonVar, start, s.get(F_VAR));
+  start += m.getNetSize(F_VAR);
+  writeBlock(commonVar, start, s.get(O_VAR));
+
+  /* weights */
+  temp_vector_type lws(P);
+  lws = s.logWeights();
+  synchronize(S1::on_device);
+  nc_put_vara(ncid, lwVar, 0, P, lws.buf());
+  if (Y > 0) {
+    nc_put_vara(ncid, liVar, 0, Y, s.logIncrements.buf());
+  }
+
+  /* scalars */
+  t = now.getTime();
+  nc_put_var(ncid, tVar, &t);
+  t = s.getLastInputTime();
+  nc_put_var(ncid, tInputVar, &t);
+  t = s.getNextObsTime();
+  nc_put_var(ncid, tObsVar, &t);
+  k = now.indexTime();
+  nc_put_var(ncid, kVar, &k);
+  k = now.indexObs();
+  nc_put_var(ncid, kObsVar, &k);
+  k = now.indexOutput();
+  nc_put_var(ncid, kOutputVar, &k);
+  nc_put_var(ncid, llVar, &s.logLikelihood);
+  nc_put_var(ncid, lpVar, &s.logPrior);
+  nc_put_var(ncid, lqVar, &s.logProposal);
+  nc_put_var(ncid, essVar, &s.ess);
+
+  /* random number generators, bit patterns stored as signed integers */
+  std::vector<size_t> offsets(2, 0), counts(2);
+  counts[0] = 1;
+  counts[1] = W;
+  for (k = 0; k < bi_omp_max_threads; ++k) {
+    rng.hostRngs[k].rng.getState(&words[0]);
+    for (i = 0; i < W; ++i) {
+      words1[i] = static_cast<int>(words[i]);
+    }
+    offsets[0] = k;
+    nc_put_vara(ncid, rngVar, offsets, counts, &words1[0]);
+  }
+  nc_sync(ncid);
+}
+
+template<class S1>
+bi::ScheduleIterator bi::CheckpointNetCDFBuffer::read(const Schedule& sched,
+    S1& s, Random& rng) {
+  typedef typename temp_host_vector<real>::type temp_vector_type;
+
+  const int W = MersenneTwister::STATE_SIZE;
+  std::vector<MersenneTwister::result_type> words(W);
+  std::vector<int> words1(W);
+  size_t P, Y, R, start;
+  int i, k, kObs, kOutput;
+  real t, t1;
+  ScheduleIterator iter;
+
+  map();
+
+  /* position in schedule */
+  nc_get_var(ncid, tVar, &t);
+  nc_get_var(ncid, kVar, &k);
+  nc_get_var(ncid, kObsVar, &kObs);
+  nc_get_var(ncid, kOutputVar, &kOutput);
+  BI_ERROR_MSG(k >= 0 && k < std::distance(sched.begin(), sched.end()),
+      "Checkpoint in file " << file << " is beyond the end of the time schedule");
+  iter = sched.begin() + k;
+  BI_ERROR_MSG(iter->getTime() == t && iter->indexObs() == kObs &&
+      iter->indexOutput() == kOutput, "Time schedule does not agree with checkpoint in file " << file << ", the times of observations and outputs up to time " << t << " must be unchanged");
+
+  /* state */
+  P = nc_inq_dimlen(ncid, npDim);
+  BI_ERROR_MSG(P == static_cast<size_t>(s.size()),
+      "Checkpoint in file " << file << " has " << P << " particles, should have " << s.size());
+
+  start = 0;
+  readBlock(dynVar, start, s.get(R_VAR));
+  start += m.getNetSize(R_VAR);
+  readBlock(dynVar, start, s.get(D_VAR));
+  start += m.getNetSize(D_VAR);
+  readBlock(dynVar, start, s.get(DX_VAR));
+
+  start = 0;
+  readBlock(commonVar, start, s.get(P_VAR));
+  start += m.getNetSize(P_VAR);
+  readBlock(commonVar, start, s.get(PX_VAR));
+  start += m.getNetSize(PX_VAR);
+  readBlock(commonVar, start, s.get(F_VAR));
+  start += m.getNetSize(F_VAR);
+  readBlock(commonVar, start, s.get(O_VAR));
+
+  /* weights */
+  temp_vector_type lws(P);
+  nc_get_vara(ncid, lwVar, 0, P, lws.buf());
+  s.logWeights() = lws;
+  s.logIncrements.clear();
+  Y = (nobsDim >= 0) ? nc_inq_dimlen(ncid, nobsDim) : 0;
+  Y = std::min(Y, static_cast<size_t>(s.logIncrements.size()));
+  if (Y > 0) {
+    nc_get_vara(ncid, liVar, 0, Y, s.logIncrements.buf());
+  }
+
+  /* scalars */
+  s.setTime(t);
+  nc_get_var(ncid, tInputVar, &t1);
+  s.setLastInputTime(t1);
+  nc_get_var(ncid, tObsVar, &t1);
+  s.setNextObsTime(t1);
+  nc_get_var(ncid, llVar, &s.logLikelihood);
+  nc_get_var(ncid, lpVar, &s.logPrior);
+  nc_get_var(ncid, lqVar, &s.logProposal);
+  nc_get_var(ncid, essVar, &s.ess);
+
+  /* random number generators; any threads beyond those saved keep their
+   * seeded state */
+  std::vector<size_t> offsets(2, 0), counts(2);
+  counts[0] = 1;
+  counts[1] = W;
+  R = nc_inq_dimlen(ncid, nrngDim);
+  for (k = 0; k < bi_omp_max_threads && k < static_cast<int>(R); ++k) {
+    offsets[0] = k;
+    nc_get_vara(ncid, rngVar, offsets, counts, &words1[0]);
+    for (i = 0; i < W; ++i) {
+      words[i] = static_cast<MersenneTwister::result_type>(words1[i]);
+    }
+    rng.hostRngs[k].rng.setState(&words[0]);
+  }
+  synchronize(S1::on_device);
+
+  return iter;
+}
+
+template<class M1>
+void bi::CheckpointNetCDFBuffer::writeBlock(const int varid,
+    const size_t start, const M1 X) {
+  typedef typename temp_host_matrix<real>::type temp_matrix_type;
+
+  std::vector<size_t> offsets, counts;
+
+  if (X.size2() > 0) {
+    if (nc_inq_varndims(ncid, varid) == 2) {
+      offsets.push_back(start);
+      offsets.push_back(0);
+      counts.push_back(X.size2());
+      counts.push_back(X.size1());
+    } else {
+      /* pre-condition */
+      BI_ASSERT(X.size1() == 1);
+
+      offsets.push_back(start);
+      counts.push_back(X.size2());
+    }
+
+    temp_matrix_type X1(X.size1(), X.size2());
+    X1 = X;
+    synchronize(M1::on_device);
+    nc_put_vara(ncid, varid, offsets, counts, X1.buf());
+  }
+}
+
+template<class M1>
+void bi::CheckpointNetCDFBuffer::readBlock(const int varid,
+    const size_t start, M1 X) {
+  typedef typename temp_host_matrix<real>::type temp_matrix_type;
+
+  std::vector<size_t> offsets, counts;
+
+  if (X.size2() > 0) {
+    if (nc_inq_varndims(ncid, varid) == 2) {
+      offsets.push_back(start);
+      offsets.push_back(0);
+      counts.push_back(X.size2());
+      counts.push_back(X.size1());
+    } else {
+      /* pre-condition */
+      BI_ASSERT(X.size1() == 1);
+
+      offsets.push_back(start);
+      counts.push_back(X.size2());
+    }
+
+    temp_matrix_type X1(X.size1(), X.size2());
+    nc_get_vara(ncid, varid, offsets, counts, X1.buf());
+    X = X1;
+  }
+}
+
+#endif
@@ -12,7 +12,7 @@
 bi::KalmanFilterNetCDFBuffer::KalmanFilterNetCDFBuffer(const Model& m,
     const size_t P, const size_t T, const std::string& file,
     const FileMode mode, const SchemaMode schema) :
-    SimulatorNetCDFBuffer(m, P, T, file, mode, schema) {
+    SimulatorNetCDFBuffer(m, P, T, file, mode, schema, false) {
   if (mode == NEW || mode == REPLACE) {
     create(T);  // set up structure of new file
   } else {
@@ -10,7 +10,8 @@
 bi::MCMCNetCDFBuffer::MCMCNetCDFBuffer(const Model& m, const size_t P,
     const size_t T, const std::string& file, const FileMode mode,
     const SchemaMode schema) :
-    SimulatorNetCDFBuffer(m, P, T, file, mode, schema) {
+    SimulatorNetCDFBuffer(m, P, T, file, mode, schema, false), llVar(-1), lpVar(
+        -1), ndiagDim(-1), diagSampleVar(-1), diagAcceptanceVar(-1), ndiag(0) {
   if (mode == NEW || mode == REPLACE) {
     create();
   } else {
@@ -50,3 +51,77 @@ void bi::MCMCNetCDFBuffer::map() {
   BI_ERROR_MSG(dimids[0] == npDim,
       "Only dimension of variable logprior should be np, in file " << file);
 }
+
+void bi::MCMCNetCDFBuffer::writeDiagnostics(const MCMCDiagnostics& diag) {
+  const int sample = diag.size();
+  const double rate = diag.getAcceptanceRate();
+
+  if (ndiagDim < 0) {
+    createDiagnostics();
+  }
+  nc_put_var1(ncid, diagSampleVar, ndiag, &sample);
+  nc_put_var1(ncid, diagAcceptanceVar, ndiag, &rate);
+  writeDiagnosticVars(essVars, ndiag, diag.getESS());
+  writeDiagnosticVars(rhatVars, ndiag, diag.getRHat());
+  ++ndiag;
+  nc_sync(ncid);
+}
+
+void bi::MCMCNetCDFBuffer::createDiagnostics() {
+  const int N = m.getNumVars(P_VAR);
+  Var* var;
+  int id;
+
+  nc_redef(ncid);
+
+  ndiagDim = nc_def_dim(ncid, "ndiag");
+  diagSampleVar = nc_def_var(ncid, "diag_sample", NC_INT, ndiagDim);
+  diagAcceptanceVar = nc_def_var(ncid, "diag_acceptance", NC_REAL, ndiagDim);
+  essVars.resize(N, -1);
+  rhatVars.resize(N, -1);
+  for (id = 0; id < N; ++id) {
+    var = m.getVar(P_VAR, id);
+    essVars[id] = createDiagnosticVar(var, "ess");
+    rhatVars[id] = createDiagnosticVar(var, "rhat");
+  }
+
+  nc_enddef(ncid);
+}
+
+int bi::MCMCNetCDFBuffer::createDiagnosticVar(Var* var,
+    const std::string& suffix) {
+  /* pre-condition */
+  BI_ASSERT(var != NULL);
+
+  std::vector<int> dims;
+  int i;
+
+  dims.push_back(ndiagDim);
+  for (i = var->getNumDims() - 1; i >= 0; --i) {
+    dims.push_back(nc_inq_dimid(ncid, var->getDim(i)->getName()));
+  }
+  return nc_def_var(ncid, var->getOutputName() + "_" + suffix, NC_REAL, dims);
+}
+
+void bi::MCMCNetCDFBuffer::writeDiagnosticVars(
+    const std::vector<int>& varids, const size_t k,
+    const std::vector<double>& x) {
+  /* pre-condition */
+  BI_ASSERT(static_cast<int>(varids.size()) == m.getNumVars(P_VAR));
+
+  std::vector<size_t> offsets, counts;
+  Var* var;
+  int id, i;
+
+  for (id = 0; id < m.getNumVars(P_VAR); ++id) {
+    var = m.getVar(P_VAR, id);
+    offsets.assign(var->getNumDims() + 1, 0);
+    counts.resize(var->getNumDims() + 1);
+    offsets[0] = k;
+    counts[0] = 1;
+    for (i = 0; i < var->getNumDims(); ++i) {
+      counts[var->getNumDims() - i] = var->getDim(i)->getSize();
+    }
+    nc_put_vara(ncid, varids[id], offsets, counts, &x[var->getStart()]);
+  }
+}
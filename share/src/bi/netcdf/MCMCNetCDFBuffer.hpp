@@ -10,6 +10,7 @@
 
 #include "SimulatorNetCDFBuffer.hpp"
 #include "../state/State.hpp"
+#include "../pdf/MCMCDiagnostics.hpp"
 
 #include <vector>
 
@@ -52,6 +53,21 @@ public:
   template<class V1>
   void writeLogPriors(const size_t p, const V1 lp);
 
+  /**
+   * Write convergence diagnostics.
+   *
+   * @param diag Diagnostics.
+   *
+   * Each call appends a record along the @c ndiag dimension: the number of
+   * samples at the time, the acceptance rate over the window since the
+   * previous record, and, for each parameter, the effective sample size
+   * and split-\f$\hat{R}\f$ in variables suffixed @c _ess and @c _rhat.
+   * These are defined on the first call, so that files without diagnostics
+   * are unchanged. The file is synced after each record, so that progress
+   * may be monitored while sampling.
+   */
+  void writeDiagnostics(const MCMCDiagnostics& diag);
+
 protected:
   /**
    * Set up structure of NetCDF file.
@@ -63,6 +79,31 @@ protected:
    */
   void map();
 
+  /**
+   * Set up structure of diagnostics in NetCDF file.
+   */
+  void createDiagnostics();
+
+  /**
+   * Create variable for diagnostic of parameter.
+   *
+   * @param var Parameter.
+   * @param suffix Suffix for name.
+   *
+   * @return Id of the variable.
+   */
+  int createDiagnosticVar(Var* var, const std::string& suffix);
+
+  /**
+   * Write diagnostic of parameters.
+   *
+   * @param varids Ids of variables, one per parameter.
+   * @param k Index of record.
+   * @param x Diagnostic of each component of the parameters.
+   */
+  void writeDiagnosticVars(const std::vector<int>& varids, const size_t k,
+      const std::vector<double>& x);
+
   /**
    * Log-likelihoods variable.
    */
@@ -72,6 +113,36 @@ protected:
    * Prior log-densities variable.
    */
   int lpVar;
+
+  /**
+   * Diagnostics dimension.
+   */
+  int ndiagDim;
+
+  /**
+   * Sample count of diagnostics variable.
+   */
+  int diagSampleVar;
+
+  /**
+   * Acceptance rate of diagnostics variable.
+   */
+  int diagAcceptanceVar;
+
+  /**
+   * Effective sample size variables, indexed by parameter id.
+   */
+  std::vector<int> essVars;
+
+  /**
+   * Split-\f$\hat{R}\f$ variables, indexed by parameter id.
+   */
+  std::vector<int> rhatVars;
+
+  /**
+   * Number of diagnostics records written.
+   */
+  size_t ndiag;
 };
 }
 
@@ -12,7 +12,7 @@
 bi::OptimiserNetCDFBuffer::OptimiserNetCDFBuffer(const Model& m,
     const size_t T, const std::string& file, const FileMode mode,
     const SchemaMode schema) :
-    SimulatorNetCDFBuffer(m, 0, T, file, mode, schema) {
+    SimulatorNetCDFBuffer(m, 0, T, file, mode, schema, false) {
   if (mode == NEW || mode == REPLACE) {
     create();
   } else {
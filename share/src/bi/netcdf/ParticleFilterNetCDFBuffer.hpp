@@ -52,6 +52,9 @@ public:
    *
    * @param k Time index.
    * @param lws Log-weights.
+   *
+   * Log-weights and ancestors are omitted from the file if all dynamic
+   * variables are summarised (see writeSummary()).
    */
   template<class V1>
   void writeLogWeights(const size_t k, const V1 lws);
@@ -112,7 +115,9 @@ void bi::ParticleFilterNetCDFBuffer::writeState(const size_t k, const M1 X,
 template<class V1>
 void bi::ParticleFilterNetCDFBuffer::writeLogWeights(const size_t k,
     const V1 lws) {
-  if (schema == FLEXI) {
+  if (lwVar < 0) {
+    /* all variables summarised, so not output */
+  } else if (schema == FLEXI) {
     BI_ERROR(lws.size() == this->len);
     writeRange(lwVar, this->start, lws);
   } else {
@@ -123,7 +128,9 @@ void bi::ParticleFilterNetCDFBuffer::writeLogWeights(const size_t k,
 template<class V1>
 void bi::ParticleFilterNetCDFBuffer::writeAncestors(const size_t k,
     const V1 as) {
-  if (schema == FLEXI) {
+  if (aVar < 0) {
+    /* all variables summarised, so not output */
+  } else if (schema == FLEXI) {
     BI_ERROR(as.size() == this->len);
     writeRange(aVar, this->start, as);
   } else {
@@ -11,10 +11,16 @@
 
 bi::SimulatorNetCDFBuffer::SimulatorNetCDFBuffer(const Model& m,
     const size_t P, const size_t T, const std::string& file,
-    const FileMode mode, const SchemaMode schema) :
-    NetCDFBuffer(file, mode), m(m), schema(schema), nsDim(-1), nrDim(-1), npDim(
-        -1), nrpDim(-1), tVar(-1), startVar(-1), lenVar(-1), k(-1), start(0), len(
-        0), vars(NUM_VAR_TYPES) {
+    const FileMode mode, const SchemaMode schema, const bool summaries) :
+    NetCDFBuffer(file, mode), m(m), schema(schema), summaries(summaries), nsDim(
+        -1), nrDim(-1), npDim(-1), nrpDim(-1), nqDim(-1), tVar(-1), qVar(-1), startVar(
+        -1), lenVar(-1), k(-1), start(0), len(0), vars(NUM_VAR_TYPES), meanVars(
+        NUM_VAR_TYPES), varianceVars(NUM_VAR_TYPES), quantileVars(
+        NUM_VAR_TYPES) {
+  /* quantile levels of summaries */
+  static const real levels[] = { 0.025, 0.25, 0.5, 0.75, 0.975 };
+  qs.assign(levels, levels + sizeof(levels)/sizeof(real));
+
   if (mode == NEW || mode == REPLACE) {
     create(P, T);
   } else {
@@ -73,12 +79,23 @@ void bi::SimulatorNetCDFBuffer::create(const size_t P, const size_t T) {
   for (i = 0; i < NUM_VAR_TYPES; ++i) {
     type = static_cast<VarType>(i);
     vars[type].resize(m.getNumVars(type), -1);
+    meanVars[type].resize(m.getNumVars(type), -1);
+    varianceVars[type].resize(m.getNumVars(type), -1);
+    quantileVars[type].resize(m.getNumVars(type), -1);
 
     if (((type == D_VAR || type == R_VAR) && schema != PARAM_ONLY)
         || type == P_VAR) {
       for (id = 0; id < (int)vars[type].size(); ++id) {
         var = m.getVar(type, id);
-        if (var->hasOutput()) {
+        if (var->hasOutput() && isSummarised(var)) {
+          if (nqDim < 0) {
+            nqDim = nc_def_dim(ncid, "nq", qs.size());
+            qVar = nc_def_var(ncid, "quantile", NC_REAL, nqDim);
+          }
+          meanVars[type][id] = createSummaryVar(var, "mean");
+          varianceVars[type][id] = createSummaryVar(var, "var");
+          quantileVars[type][id] = createSummaryVar(var, "quantile", true);
+        } else if (var->hasOutput()) {
           vars[type][id] = createVar(var);
         }
       }
@@ -88,6 +105,11 @@ void bi::SimulatorNetCDFBuffer::create(const size_t P, const size_t T) {
 
   /* execution time variable */
   nc_enddef(ncid);
+
+  /* quantile levels */
+  if (qVar >= 0) {
+    nc_put_vara(ncid, qVar, 0, qs.size(), &qs[0]);
+  }
 }
 
 void bi::SimulatorNetCDFBuffer::map(const size_t P, const size_t T) {
@@ -100,7 +122,7 @@ void bi::SimulatorNetCDFBuffer::map(const size_t P, const size_t T) {
   /* dimensions */
   nrDim = nc_inq_dimid(ncid, "nr");
   BI_ERROR_MSG(nrDim >= 0, "No dimension nr in file " << file);
-  BI_ERROR_MSG(T < 0 || nc_inq_dimlen(ncid, nrDim) == T,
+  BI_ERROR_MSG(T == 0 || nc_inq_dimlen(ncid, nrDim) == T,
       "Dimension nr has length " << nc_inq_dimlen(ncid, nrDim) << ", should be of length " << T << ", in file " << file);
   for (i = 0; i < m.getNumDims(); ++i) {
     dims.push_back(mapDim(m.getDim(i)));
@@ -111,7 +133,7 @@ void bi::SimulatorNetCDFBuffer::map(const size_t P, const size_t T) {
   } else {
     npDim = nc_inq_dimid(ncid, "np");
     BI_ERROR_MSG(npDim >= 0, "No dimension np or nrp in file " << file);
-    BI_ERROR_MSG(P < 0 || nc_inq_dimlen(ncid, npDim) == P,
+    BI_ERROR_MSG(P == 0 || nc_inq_dimlen(ncid, npDim) == P,
         "Dimension np has length " << nc_inq_dimlen(ncid, npDim) << ", should be of length " << P << ", in file " << file);
   }
 
@@ -151,13 +173,31 @@ void bi::SimulatorNetCDFBuffer::map(const size_t P, const size_t T) {
     if (((type == D_VAR || type == R_VAR) && schema != PARAM_ONLY)
         || type == P_VAR) {
       vars[type].resize(m.getNumVars(type), -1);
+      meanVars[type].resize(m.getNumVars(type), -1);
+      varianceVars[type].resize(m.getNumVars(type), -1);
+      quantileVars[type].resize(m.getNumVars(type), -1);
       for (id = 0; id < m.getNumVars(type); ++id) {
         var = m.getVar(type, id);
-        vars[type][id] = mapVar(var);
+        if (var->hasOutput() && isSummarised(var)) {
+          meanVars[type][id] = mapSummaryVar(var, "mean");
+          varianceVars[type][id] = mapSummaryVar(var, "var");
+          quantileVars[type][id] = mapSummaryVar(var, "quantile");
+        } else {
+          vars[type][id] = mapVar(var);
+        }
       }
     }
   }
 
+  /* quantile levels */
+  nqDim = nc_inq_dimid(ncid, "nq");
+  if (nqDim >= 0) {
+    BI_ERROR_MSG(nc_inq_dimlen(ncid, nqDim) == qs.size(),
+        "Dimension nq has length " << nc_inq_dimlen(ncid, nqDim) << ", should be of length " << qs.size() << ", in file " << file);
+    qVar = nc_inq_varid(ncid, "quantile");
+    BI_ERROR_MSG(qVar >= 0, "No variable quantile in file " << file);
+  }
+
   /* execution time variable */
   clockVar = nc_inq_varid(ncid, "clock");
   BI_ERROR_MSG(clockVar >= 0, "No variable clock in file " << file);
@@ -203,6 +243,26 @@ int bi::SimulatorNetCDFBuffer::createVar(Var* var) {
   return nc_def_var(ncid, var->getOutputName(), NC_REAL, dims);
 }
 
+int bi::SimulatorNetCDFBuffer::createSummaryVar(Var* var,
+    const std::string& suffix, const bool quantiles) {
+  /* pre-condition */
+  BI_ASSERT(var != NULL);
+
+  std::vector<int> dims;
+  int i;
+
+  if (!var->getOutputOnce()) {
+    dims.push_back(nrDim);
+  }
+  for (i = var->getNumDims() - 1; i >= 0; --i) {
+    dims.push_back(nc_inq_dimid(ncid, var->getDim(i)->getName()));
+  }
+  if (quantiles) {
+    dims.push_back(nqDim);
+  }
+  return nc_def_var(ncid, var->getOutputName() + "_" + suffix, NC_REAL, dims);
+}
+
 int bi::SimulatorNetCDFBuffer::mapVar(Var* var) {
   /* pre-condition */
   BI_ASSERT(var != NULL);
@@ -249,6 +309,40 @@ int bi::SimulatorNetCDFBuffer::mapVar(Var* var) {
   return varid;
 }
 
+int bi::SimulatorNetCDFBuffer::mapSummaryVar(Var* var,
+    const std::string& suffix) {
+  /* pre-condition */
+  BI_ASSERT(var != NULL);
+
+  const std::string name = var->getOutputName() + "_" + suffix;
+  int varid = nc_inq_varid(ncid, name);
+  BI_ERROR_MSG(varid >= 0, "No variable " << name << " in file " << file);
+
+  return varid;
+}
+
+bool bi::SimulatorNetCDFBuffer::isSummarised(const Var* var) const {
+  return summaries && var->getOutputSummary()
+      && (var->getType() == D_VAR || var->getType() == R_VAR)
+      && schema != PARAM_ONLY;
+}
+
+bool bi::SimulatorNetCDFBuffer::hasFullState() const {
+  static const VarType types[] = { R_VAR, D_VAR };
+  Var* var;
+  int i, id;
+
+  for (i = 0; i < 2; ++i) {
+    for (id = 0; id < m.getNumVars(types[i]); ++id) {
+      var = m.getVar(types[i], id);
+      if (var->hasOutput() && !isSummarised(var)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
 int bi::SimulatorNetCDFBuffer::createDim(Dim* dim) {
   return nc_def_dim(ncid, dim->getName(), dim->getSize());
 }
@@ -30,10 +30,15 @@ public:
    * @param T Number of times to hold in file.
    * @param file NetCDF file name.
    * @param mode File open mode.
+   * @param schema Schema mode.
+   * @param summaries Output only summary statistics of those variables that
+   * request it (see writeSummary())? Otherwise all variables are output in
+   * full.
    */
   SimulatorNetCDFBuffer(const Model& m, const size_t P = 0,
       const size_t T = 0, const std::string& file = "", const FileMode mode =
-          READ_ONLY, const SchemaMode schema = DEFAULT);
+          READ_ONLY, const SchemaMode schema = DEFAULT,
+      const bool summaries = true);
 
   /**
    * Write time.
@@ -129,6 +134,67 @@ public:
   void writeStateVar(const VarType type, const int id, const size_t k,
       const size_t p, const M1 X);
 
+  /**
+   * Write state variable for a range of consecutive times, as a single
+   * hyperslab where the schema permits.
+   *
+   * @param type Variable type.
+   * @param id Variable id.
+   * @param k First time index.
+   * @param p First sample index.
+   * @param X State. Rows index samples, columns index the components of the
+   * variable at time @p k, followed by those at time <tt>k + 1</tt>, and so
+   * on.
+   */
+  template<class M1>
+  void writeStateVarRange(const VarType type, const int id, const size_t k,
+      const size_t p, const M1 X);
+
+  /**
+   * Write summary statistics of dynamic state, with all samples weighted
+   * equally.
+   *
+   * @tparam M1 Matrix type.
+   *
+   * @param k Time index.
+   * @param X State. Rows index samples, columns variables.
+   */
+  template<class M1>
+  void writeSummary(const size_t k, const M1 X);
+
+  /**
+   * Write summary statistics of dynamic state.
+   *
+   * @tparam M1 Matrix type.
+   * @tparam V1 Vector type.
+   *
+   * @param k Time index.
+   * @param X State. Rows index samples, columns variables.
+   * @param lws Log-weights of samples.
+   *
+   * For each variable with the @c output_summary attribute, writes the
+   * weighted mean, variance and quantiles across samples (see summarise())
+   * in place of the value of each sample, which writeState() then omits.
+   */
+  template<class M1, class V1>
+  void writeSummary(const size_t k, const M1 X, const V1 lws);
+
+  /**
+   * Write summary statistics of state variable.
+   *
+   * @tparam M1 Matrix type.
+   * @tparam V1 Vector type.
+   *
+   * @param type Variable type.
+   * @param id Variable id.
+   * @param k Time index.
+   * @param X State. Rows index samples, columns variables.
+   * @param lws Log-weights of samples.
+   */
+  template<class M1, class V1>
+  void writeSummaryVar(const VarType type, const int id, const size_t k,
+      const M1 X, const V1 lws);
+
   /**
    * Write offset along @c nrp dimension for time. Flexi schema only.
    *
@@ -178,6 +244,18 @@ protected:
    */
   int createVar(Var* var);
 
+  /**
+   * Create variable for summary statistic.
+   *
+   * @param var Variable.
+   * @param suffix Suffix on output name of variable.
+   * @param quantiles Add quantile dimension?
+   *
+   * @return Variable id.
+   */
+  int createSummaryVar(Var* var, const std::string& suffix,
+      const bool quantiles = false);
+
   /**
    * Map variable.
    *
@@ -187,6 +265,28 @@ protected:
    */
   int mapVar(Var* var);
 
+  /**
+   * Map variable for summary statistic.
+   *
+   * @param var Variable.
+   * @param suffix Suffix on output name of variable.
+   *
+   * @return Variable id.
+   */
+  int mapSummaryVar(Var* var, const std::string& suffix);
+
+  /**
+   * Is only a summary of a variable output?
+   *
+   * @param var Variable.
+   */
+  bool isSummarised(const Var* var) const;
+
+  /**
+   * Is any dynamic variable output in full, with a value for each sample?
+   */
+  bool hasFullState() const;
+
   /**
    * Create dimension.
    *
@@ -251,6 +351,11 @@ protected:
    */
   unsigned schema;
 
+  /**
+   * Output summaries of variables that request it?
+   */
+  bool summaries;
+
   /**
    * Record dimension.
    */
@@ -271,6 +376,11 @@ protected:
    */
   int nrpDim;
 
+  /**
+   * Quantile dimension.
+   */
+  int nqDim;
+
   /**
    * Time variable.
    */
@@ -281,6 +391,11 @@ protected:
    */
   int clockVar;
 
+  /**
+   * Quantile levels variable.
+   */
+  int qVar;
+
   /**
    * Variable holding starting index into nrp dimension for each time, flexi
    * schema only.
@@ -317,12 +432,35 @@ protected:
    * Model variables, indexed by type.
    */
   std::vector<std::vector<int> > vars;
+
+  /**
+   * Means of summarised model variables, indexed by type.
+   */
+  std::vector<std::vector<int> > meanVars;
+
+  /**
+   * Variances of summarised model variables, indexed by type.
+   */
+  std::vector<std::vector<int> > varianceVars;
+
+  /**
+   * Quantiles of summarised model variables, indexed by type.
+   */
+  std::vector<std::vector<int> > quantileVars;
+
+  /**
+   * Quantile levels.
+   */
+  std::vector<real> qs;
 };
 }
 
 #include "../math/view.hpp"
 #include "../math/sim_temp_vector.hpp"
 #include "../math/sim_temp_matrix.hpp"
+#include "../math/temp_vector.hpp"
+#include "../math/temp_matrix.hpp"
+#include "../pdf/misc.hpp"
 
 template<class V1>
 void bi::SimulatorNetCDFBuffer::writeTimes(const size_t k, const V1 ts) {
@@ -392,7 +530,7 @@ void bi::SimulatorNetCDFBuffer::writeStateVar(const VarType type,
   std::vector<int> dimids;
   int i, j, varid;
 
-  if (var->hasOutput()) {
+  if (var->hasOutput() && !isSummarised(var)) {
     varid = vars[type][id];
     BI_ASSERT(varid >= 0);
 
@@ -432,6 +570,149 @@ void bi::SimulatorNetCDFBuffer::writeStateVar(const VarType type,
   }
 }
 
+template<class M1>
+void bi::SimulatorNetCDFBuffer::writeStateVarRange(const VarType type,
+    const int id, const size_t k, const size_t p, const M1 X) {
+  typedef typename sim_temp_host_matrix<M1>::type temp_matrix_type;
+
+  Var* var = m.getVar(type, id);
+  const int size = var->getSize();
+  const int K = X.size2() / size;
+  std::vector<size_t> offsets, counts;
+  std::vector<int> dimids;
+  int i, j, varid;
+
+  /* pre-condition */
+  BI_ASSERT(X.size2() % size == 0);
+
+  if (var->hasOutput() && !isSummarised(var)) {
+    varid = vars[type][id];
+    BI_ASSERT(varid >= 0);
+
+    dimids = nc_inq_vardimid(ncid, varid);
+    if (dimids.empty() || dimids[0] != nrDim || dimids.back() == nrpDim) {
+      /* no time dimension, or flexi schema, so one time at a time */
+      for (i = 0; i < K; ++i) {
+        writeStateVar(type, id, k + i, p, columns(X, i*size, size));
+      }
+    } else {
+      j = 0;
+      offsets.resize(dimids.size());
+      counts.resize(dimids.size());
+
+      offsets[j] = k;
+      counts[j] = K;
+      ++j;
+      for (i = var->getNumDims() - 1; i >= 0; --i) {
+        offsets[j] = 0;
+        counts[j] = nc_inq_dimlen(ncid, dimids[j]);
+        ++j;
+      }
+      if (j < static_cast<int>(dimids.size()) && dimids[j] == npDim) {
+        offsets[j] = p;
+        counts[j] = X.size1();
+        ++j;
+      }
+
+      if (M1::on_device || !X.contiguous()) {
+        temp_matrix_type X1(X.size1(), X.size2());
+        X1 = X;
+        synchronize(M1::on_device);
+        nc_put_vara(ncid, varid, offsets, counts, X1.buf());
+      } else {
+        nc_put_vara(ncid, varid, offsets, counts, X.buf());
+      }
+    }
+  }
+}
+
+template<class M1>
+void bi::SimulatorNetCDFBuffer::writeSummary(const size_t k, const M1 X) {
+  typename temp_host_vector<real>::type lws(X.size1());
+  lws.clear();
+  writeSummary(k, X, lws);
+}
+
+template<class M1, class V1>
+void bi::SimulatorNetCDFBuffer::writeSummary(const size_t k, const M1 X,
+    const V1 lws) {
+  static const VarType types[] = { R_VAR, D_VAR };
+  VarType type;
+  Var* var;
+  int i, id, offset = 0;
+
+  for (i = 0; i < 2; ++i) {
+    type = types[i];
+    for (id = 0; id < m.getNumVars(type); ++id) {
+      var = m.getVar(type, id);
+      if (var->hasOutput() && isSummarised(var)) {
+        writeSummaryVar(type, id, k,
+            columns(X, offset + var->getStart(), var->getSize()), lws);
+      }
+    }
+    offset += m.getNetSize(type);
+  }
+}
+
+template<class M1, class V1>
+void bi::SimulatorNetCDFBuffer::writeSummaryVar(const VarType type,
+    const int id, const size_t k, const M1 X, const V1 lws) {
+  typedef typename temp_host_matrix<real>::type temp_matrix_type;
+  typedef typename temp_host_vector<real>::type temp_vector_type;
+
+  Var* var = m.getVar(type, id);
+  const int size = var->getSize();
+  const int NQ = qs.size();
+  temp_vector_type qs1(NQ), mu(size), sigma(size);
+  temp_matrix_type Q(NQ, size);
+  std::vector<size_t> offsets, counts;
+  std::vector<int> dimids;
+  int i, j;
+
+  /* pre-conditions */
+  BI_ASSERT(X.size2() == size);
+  BI_ASSERT(X.size1() == lws.size());
+  BI_ASSERT(isSummarised(var));
+
+  for (i = 0; i < NQ; ++i) {
+    qs1(i) = qs[i];
+  }
+  if (M1::on_device || V1::on_device) {
+    temp_matrix_type X1(X.size1(), X.size2());
+    temp_vector_type lws1(lws.size());
+    X1 = X;
+    lws1 = lws;
+    synchronize(M1::on_device || V1::on_device);
+    summarise(X1, lws1, qs1, mu, sigma, Q);
+  } else {
+    summarise(X, lws, qs1, mu, sigma, Q);
+  }
+
+  /* mean and variance have the same dimensions, quantiles one more */
+  j = 0;
+  dimids = nc_inq_vardimid(ncid, meanVars[type][id]);
+  offsets.resize(dimids.size() + 1);
+  counts.resize(dimids.size() + 1);
+  if (j < static_cast<int>(dimids.size()) && dimids[j] == nrDim) {
+    offsets[j] = k;
+    counts[j] = 1;
+    ++j;
+  }
+  for (i = var->getNumDims() - 1; i >= 0; --i) {
+    offsets[j] = 0;
+    counts[j] = nc_inq_dimlen(ncid, dimids[j]);
+    ++j;
+  }
+  offsets[j] = 0;
+  counts[j] = NQ;
+
+  nc_put_vara(ncid, quantileVars[type][id], offsets, counts, Q.buf());
+  offsets.resize(j);
+  counts.resize(j);
+  nc_put_vara(ncid, meanVars[type][id], offsets, counts, mu.buf());
+  nc_put_vara(ncid, varianceVars[type][id], offsets, counts, sigma.buf());
+}
+
 template<class V1>
 void bi::SimulatorNetCDFBuffer::writeRange(const int varid, const size_t k,
     const V1 x) {
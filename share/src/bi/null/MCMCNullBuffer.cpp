@@ -13,3 +13,7 @@ bi::MCMCNullBuffer::MCMCNullBuffer(const Model& m, const size_t P,
     SimulatorNullBuffer(m, P, T, file, mode, schema) {
   //
 }
+
+void bi::MCMCNullBuffer::writeDiagnostics(const MCMCDiagnostics& diag) {
+  //
+}
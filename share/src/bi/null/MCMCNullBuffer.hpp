@@ -9,6 +9,7 @@
 #define BI_NULL_MCMCNULLBUFFER_HPP
 
 #include "SimulatorNullBuffer.hpp"
+#include "../pdf/MCMCDiagnostics.hpp"
 
 namespace bi {
 /**
@@ -36,6 +37,11 @@ public:
    */
   template<class V1>
   void writeLogPriors(const size_t p, const V1 lp);
+
+  /**
+   * @copydoc MCMCNetCDFBuffer::writeDiagnostics()
+   */
+  void writeDiagnostics(const MCMCDiagnostics& diag);
 };
 }
 
@@ -76,6 +76,25 @@ public:
   void writeStateVar(const VarType type, const int id, const size_t k,
       const size_t p, const M1 X);
 
+  /**
+   * @copydoc SimulatorNetCDFBuffer::writeStateVarRange()
+   */
+  template<class M1>
+  void writeStateVarRange(const VarType type, const int id, const size_t k,
+      const size_t p, const M1 X);
+
+  /**
+   * @copydoc SimulatorNetCDFBuffer::writeSummary(const size_t, const M1)
+   */
+  template<class M1>
+  void writeSummary(const size_t k, const M1 X);
+
+  /**
+   * @copydoc SimulatorNetCDFBuffer::writeSummary(const size_t, const M1, const V1)
+   */
+  template<class M1, class V1>
+  void writeSummary(const size_t k, const M1 X, const V1 lws);
+
   /**
    * @copydoc SimulatorNetCDFBuffer::writeStart()
    */
@@ -133,4 +152,21 @@ void bi::SimulatorNullBuffer::writeStateVar(const VarType type, const int id,
   //
 }
 
+template<class M1>
+void bi::SimulatorNullBuffer::writeStateVarRange(const VarType type,
+    const int id, const size_t k, const size_t p, const M1 X) {
+  //
+}
+
+template<class M1>
+void bi::SimulatorNullBuffer::writeSummary(const size_t k, const M1 X) {
+  //
+}
+
+template<class M1, class V1>
+void bi::SimulatorNullBuffer::writeSummary(const size_t k, const M1 X,
+    const V1 lws) {
+  //
+}
+
 #endif
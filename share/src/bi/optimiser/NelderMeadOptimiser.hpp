@@ -13,6 +13,7 @@
 #include "../math/gsl.hpp"
 
 #include <gsl/gsl_multimin.h>
+#include <climits>
 
 namespace bi {
 /**
@@ -81,6 +82,46 @@ struct NelderMeadOptimiserParams {
   IO1* out;
   IO2* in;
   ScheduleIterator first, last;
+
+  /**
+   * Use common random numbers across evaluations?
+   */
+  bool crn;
+
+  /**
+   * Seed for common random numbers.
+   */
+  unsigned seed;
+};
+
+/**
+ * @internal
+ *
+ * Adapter that proposes the parameters at which NelderMeadOptimiser is
+ * evaluating its cost function.
+ */
+struct NelderMeadOptimiserAdapter {
+  /**
+   * Constructor.
+   *
+   * @param x Parameters.
+   */
+  NelderMeadOptimiserAdapter(const gsl_vector* x) : x(x) {
+    //
+  }
+
+  /**
+   * Propose.
+   */
+  template<class S1, class S2>
+  void propose(Random& rng, S1& s1, S2& s2) {
+    vec(s2.get(P_VAR)) = gsl_vector_reference(x);
+  }
+
+  /**
+   * Parameters.
+   */
+  const gsl_vector* x;
 };
 
 /**
@@ -135,14 +176,30 @@ public:
    * @param simplexSizeRel Size of simplex relative to each dimension.
    * @param stopSteps Maximum number of steps to take.
    * @param stopSize Size for stopping criterion.
+   * @param restarts Number of starts. The first starts from the
+   * initialisation file, if given, otherwise from the prior, and the
+   * remainder from the prior.
+   * @param crn Use common random numbers across evaluations?
    *
    * Note that @p s should be initialised with a starting state.
+   *
+   * Under MPI, the starts are shared between processes in round-robin
+   * fashion, and run concurrently. Once all are complete, the best optimum
+   * over all starts and processes is found, left in the parameters of
+   * @p s, and written as the last record of @p out on every process.
+   *
+   * With common random numbers, the random number generator is reseeded
+   * identically before each evaluation of the cost function, so that the
+   * noise of a particle filter estimate of the likelihood is the same at
+   * all vertices of the simplex, and comparisons between them are not
+   * swamped by it.
    */
   template<class S, class IO1, class IO2>
   void optimise(Random& rng, const ScheduleIterator first,
       const ScheduleIterator last, S& s, IO1& out, IO2& inInit,
       const real simplexSizeRel = 0.1, const int stopSteps = 100,
-      const real stopSize = 1.0e-4);
+      const real stopSize = 1.0e-4, const int restarts = 1,
+      const bool crn = true);
   //@}
 
   /**
@@ -166,11 +223,16 @@ public:
    * @param[in,out] out Output buffer;
    * @param inInit Initialisation file.
    * @param simplexSizeRel Size of simplex relative to each dimension.
+   * @param restart Start from the prior rather than the initialisation
+   * file?
+   * @param crn Use common random numbers across evaluations?
+   * @param seed Seed for common random numbers.
    */
   template<class S, class IO1, class IO2>
   void init(Random& rng, const ScheduleIterator first,
       const ScheduleIterator last, S& s, IO1& out, IO2& inInit,
-      const real simplexSizeRel = 0.1);
+      const real simplexSizeRel = 0.1, const bool restart = false,
+      const bool crn = false, const unsigned seed = 0);
 
   /**
    * Perform one iteration step of optimiser.
@@ -231,6 +293,14 @@ private:
    */
   NelderMeadOptimiserState state;
 
+  /**
+   * Evaluate negative log-likelihood, or negative log-posterior if @p prior
+   * is true.
+   */
+  template <class S, class IO1, class IO2>
+  static double evaluate(const gsl_vector* x, void* params,
+      const bool prior);
+
   /**
    * Cost function for maximum likelihood.
    */
@@ -276,6 +346,10 @@ struct NelderMeadOptimiserFactory {
 #include "../misc/exception.hpp"
 
 #include "../misc/TicToc.hpp"
+#include "../mpi/mpi.hpp"
+
+#include <vector>
+#include <algorithm>
 
 template<class B, class F>
 bi::NelderMeadOptimiser<B,F>::NelderMeadOptimiser(B& m, F& filter,
@@ -289,28 +363,94 @@ template<class S, class IO1, class IO2>
 void bi::NelderMeadOptimiser<B,F>::optimise(Random& rng,
     const ScheduleIterator first, const ScheduleIterator last, S& s,
     IO1& out, IO2& inInit, const real simplexSizeRel, const int stopSteps,
-    const real stopSize) {
+    const real stopSize, const int restarts, const bool crn) {
+  /* pre-condition */
+  BI_ASSERT(restarts > 0);
+
   TicToc clock;
-  int k = 0;
-  init(rng, first, last, s.s, s.out, inInit, simplexSizeRel);
-  while (k < stopSteps && !hasConverged(stopSize)) {
-    step();
-    report(k);
-    output(k, s.s, out);
-    ++k;
+  int k = 0, j, r;
+  int rank = 0, size = 1;
+  double best = BI_INF, bestSize = 0.0;
+  std::vector<double> bestX(B::NP, 0.0);
+
+  /* seeds for common random numbers and for starting points, the latter
+   * kept separate so that restarts do not all start from the same draw;
+   * each start reseeds by its index, so that it is the same whichever
+   * process runs it */
+  unsigned seed = rng.uniformInt(0, INT_MAX - restarts);
+
+  #ifdef ENABLE_MPI
+  boost::mpi::communicator world;
+  rank = world.rank();
+  size = world.size();
+  boost::mpi::broadcast(world, seed, 0);
+  #endif
+
+  for (r = rank; r < restarts; r += size) {
+    rng.seeds(seed + 1 + r);
+    init(rng, first, last, s.s, s.out, inInit, simplexSizeRel, r > 0, crn,
+        seed);
+    j = 0;
+    while (j < stopSteps && !hasConverged(stopSize)) {
+      step();
+      report(k);
+      output(k, s.s, out);
+      ++j;
+      ++k;
+    }
+    term();
+
+    /* keep the best optimum, NaN never being best */
+    if (state.minimizer->fval < best) {
+      best = state.minimizer->fval;
+      bestSize = state.size;
+      const gsl_vector* x = gsl_multimin_fminimizer_x(state.minimizer);
+      for (int i = 0; i < B::NP; ++i) {
+        bestX[i] = gsl_vector_get(x, i);
+      }
+    }
+  }
+
+  /* best optimum over all processes */
+  #ifdef ENABLE_MPI
+  std::vector<double> bests;
+  boost::mpi::all_gather(world, best, bests);
+  const int root = std::min_element(bests.begin(), bests.end())
+      - bests.begin();
+  best = bests[root];
+  boost::mpi::broadcast(world, bestSize, root);
+  boost::mpi::broadcast(world, &bestX[0], B::NP, root);
+  #endif
+
+  if (bi::is_finite(best)) {
+    typename temp_host_vector<real>::type x(B::NP);
+    std::copy(bestX.begin(), bestX.end(), x.begin());
+    vec(s.s.get(P_VAR)) = x;
+    out.writeParameters(k, s.s.get(P_VAR));
+    out.writeValue(k, -best);
+    out.writeSize(k, bestSize);
+    if (rank == 0) {
+      std::cerr << "best:\t";
+      std::cerr << "value=" << -best;
+      std::cerr << '\t';
+      std::cerr << "size=" << bestSize;
+      std::cerr << std::endl;
+    }
   }
   s.clock = clock.toc();
   out.writeClock(s.clock);
-  term();
 }
 
 template<class B, class F>
 template<class S, class IO1, class IO2>
 void bi::NelderMeadOptimiser<B,F>::init(Random& rng,
     const ScheduleIterator first, const ScheduleIterator last, S& s,
-    IO1& out, IO2& inInit, const real simplexSizeRel) {
+    IO1& out, IO2& inInit, const real simplexSizeRel, const bool restart,
+    const bool crn, const unsigned seed) {
   filter.init(rng, *first, s, out, inInit);
-  filter.filter(rng, first, last, s, out);
+  if (restart) {
+    m.parameterSample(rng, s);
+  }
 
   /* initialise state vector */
   BOOST_AUTO(x, gsl_vector_reference(state.x));
@@ -329,6 +469,8 @@ void bi::NelderMeadOptimiser<B,F>::init(Random& rng,
   params->in = &inInit;
   params->first = first;
   params->last = last;
+  params->crn = crn;
+  params->seed = seed;
 
   /* function */
   gsl_multimin_function* f = new gsl_multimin_function();  ///@todo Leaks
@@ -380,16 +522,29 @@ void bi::NelderMeadOptimiser<B,F>::term() {
 
 template<class B, class F>
 template<class S, class IO1, class IO2>
-double bi::NelderMeadOptimiser<B,F>::ml(const gsl_vector* x,
-    void* params) {
+double bi::NelderMeadOptimiser<B,F>::evaluate(const gsl_vector* x,
+    void* params, const bool prior) {
   typedef NelderMeadOptimiserParams<B,F,S,IO1,IO2> param_type;
   param_type* p = reinterpret_cast<param_type*>(params);
+  NelderMeadOptimiserAdapter adapter(x);
+
+  if (p->crn) {
+    p->rng->seeds(p->seed);
+  }
+
+  /* initialise at given parameters */
+  p->filter->propose(*p->rng, *(p->first), *p->s, *p->s, *p->out, adapter);
+  if (prior && !bi::is_finite(p->s->logPrior)) {
+    return GSL_NAN;
+  }
 
   /* evaluate */
   try {
-    p->filter->init(*p->rng, *(p->first), *p->s, *p->out, *p->in);
     p->filter->filter(*p->rng, p->first, p->last, *p->s, *p->out);
-    real ll = (*p->s).logLikelihood;
+    real ll = p->s->logLikelihood;
+    if (prior) {
+      ll += p->s->logPrior;
+    }
     return -ll;
   } catch (CholeskyException e) {
     return GSL_NAN;
@@ -400,32 +555,16 @@ double bi::NelderMeadOptimiser<B,F>::ml(const gsl_vector* x,
 
 template<class B, class F>
 template<class S, class IO1, class IO2>
-double bi::NelderMeadOptimiser<B,F>::map(const gsl_vector* x,
+double bi::NelderMeadOptimiser<B,F>::ml(const gsl_vector* x,
     void* params) {
-  typedef NelderMeadOptimiserParams<B,F,S,IO1,IO2> param_type;
-  param_type* p = reinterpret_cast<param_type*>(params);
-
-  int P = p->s->size();
-  p->s->resizeMax(1, true);
-
-  /* initialise */
-  vec(p->s->get(PY_VAR)) = gsl_vector_reference(x);
-  real lp = p->m->parameterLogDensity(*p->s);
-  p->s->resizeMax(P, true);
+  return evaluate<S,IO1,IO2>(x, params, false);
+}
 
-  /* evaluate */
-  if (bi::is_finite(lp)) {
-    try {
-      p->filter->init(*p->rng, *(p->first), *p->s, *p->out, *p->in);
-      p->filter->filter(*p->rng, p->first, p->last, *p->s, *p->out);
-      real ll = (*p->s).logLikelihood;
-      return -(ll + lp);
-    } catch (CholeskyException e) {
-      return GSL_NAN;
-    }
-  } else {
-    return GSL_NAN;
-  }
+template<class B, class F>
+template<class S, class IO1, class IO2>
+double bi::NelderMeadOptimiser<B,F>::map(const gsl_vector* x,
+    void* params) {
+  return evaluate<S,IO1,IO2>(x, params, true);
 }
 
 #endif
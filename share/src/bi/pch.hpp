@@ -0,0 +1,52 @@
+/**
+ * @file
+ *
+ * Model-independent headers, precompiled once per build directory and
+ * included first by all client programs. The client programs of a model,
+ * and all builds of that model after it has been changed, then share the
+ * parsing and instantiation of this code, rather than each client program
+ * compiling it from scratch.
+ *
+ * Only headers that do not depend on the model should be included here, as
+ * a change to any header included here requires the precompiled header to
+ * be rebuilt.
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ */
+#ifndef BI_PCH_HPP
+#define BI_PCH_HPP
+
+#include "init.hpp"
+#include "cuda/cuda.hpp"
+#include "mpi/mpi.hpp"
+
+#include "misc/assert.hpp"
+#include "misc/omp.hpp"
+#include "misc/TicToc.hpp"
+
+#include "math/scalar.hpp"
+#include "math/function.hpp"
+#include "math/vector.hpp"
+#include "math/matrix.hpp"
+#include "math/view.hpp"
+#include "math/operation.hpp"
+#include "math/temp_vector.hpp"
+#include "math/temp_matrix.hpp"
+#include "primitive/vector_primitive.hpp"
+#include "primitive/matrix_primitive.hpp"
+
+#include "random/Random.hpp"
+#include "cache/Cache1D.hpp"
+#include "cache/Cache2D.hpp"
+#include "netcdf/netcdf.hpp"
+
+#include "boost/typeof/typeof.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+#endif
@@ -0,0 +1,409 @@
+/**
+ * @file
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ */
+#ifndef BI_PDF_MCMCDIAGNOSTICS_HPP
+#define BI_PDF_MCMCDIAGNOSTICS_HPP
+
+#include <vector>
+
+namespace bi {
+/**
+ * Online convergence diagnostics for a Markov chain.
+ *
+ * @ingroup math_pdf
+ *
+ * Samples are added one at a time, and gathered into batches of equal
+ * size, keeping only the mean and sum of squared deviations of each batch.
+ * When the maximum number of batches is reached, adjacent batches are
+ * merged in pairs and the batch size doubled, so that memory is constant
+ * in the length of the chain, and the batch size grows in proportion to
+ * it, as required for a consistent batch means estimate of the asymptotic
+ * variance (@ref Flegal2010 "Flegal & Jones, 2010").
+ *
+ * From the complete batches, diagnose() computes, for each component:
+ *
+ * @li the effective sample size (ESS), as the ratio of the sample variance
+ * to the batch means estimate of the asymptotic variance, multiplied by the
+ * number of samples, and
+ * @li the split-\f$\hat{R}\f$ statistic of
+ * @ref Gelman2013 "Gelman et al. (2013)", with the first and last halves of
+ * the batches taken as separate chains.
+ *
+ * It also computes the acceptance rate over the window of samples since the
+ * previous call, counting a step as accepted when any component of the
+ * sample changes.
+ *
+ * Under MPI, the chain of each process is an independent chain: diagnose()
+ * is then collective, ESS is summed across processes, the halves of all
+ * chains enter \f$\hat{R}\f$, and the acceptance rate is over all chains.
+ * All processes must have added the same number of samples.
+ */
+class MCMCDiagnostics {
+public:
+  /**
+   * Constructor.
+   *
+   * @param N Number of components of each sample.
+   * @param maxBatches Maximum number of batches. Must be even.
+   */
+  MCMCDiagnostics(const int N = 0, const int maxBatches = 64);
+
+  /**
+   * Add sample.
+   *
+   * @tparam V1 Vector type, on host.
+   *
+   * @param theta Sample.
+   */
+  template<class V1>
+  void add(const V1 theta);
+
+  /**
+   * Compute diagnostics from the samples added so far.
+   */
+  void diagnose();
+
+  /**
+   * Number of samples added.
+   */
+  int size() const;
+
+  /**
+   * Effective sample size of each component, as of the last diagnose().
+   * Zero where there are too few samples, or no variation.
+   */
+  const std::vector<double>& getESS() const;
+
+  /**
+   * Split-\f$\hat{R}\f$ of each component, as of the last diagnose(). NaN
+   * where there are too few samples, or no variation.
+   */
+  const std::vector<double>& getRHat() const;
+
+  /**
+   * Smallest effective sample size of any component, as of the last
+   * diagnose().
+   */
+  double getMinESS() const;
+
+  /**
+   * Largest split-\f$\hat{R}\f$ of any component, as of the last
+   * diagnose(), ignoring NaN.
+   */
+  double getMaxRHat() const;
+
+  /**
+   * Acceptance rate over the window ending at the last diagnose().
+   */
+  double getAcceptanceRate() const;
+
+private:
+  /**
+   * Compute the mean and variance of the samples in a range of complete
+   * batches.
+   *
+   * @param i Component.
+   * @param k1 First batch.
+   * @param k2 One past the last batch.
+   * @param[out] mu Mean.
+   * @param[out] var Variance.
+   * @param[out] ssb Sum of squared deviations of batch means from @p mu.
+   */
+  void moments(const int i, const int k1, const int k2, double& mu,
+      double& var, double& ssb) const;
+
+  /**
+   * Number of components.
+   */
+  int N;
+
+  /**
+   * Maximum number of batches.
+   */
+  int maxBatches;
+
+  /**
+   * Number of samples.
+   */
+  int n;
+
+  /**
+   * Size of each batch.
+   */
+  int b;
+
+  /**
+   * Number of complete batches.
+   */
+  int a;
+
+  /**
+   * Number of samples in the incomplete batch.
+   */
+  int m;
+
+  /**
+   * Means of complete batches, batch-major.
+   */
+  std::vector<double> means;
+
+  /**
+   * Sums of squared deviations of complete batches, batch-major.
+   */
+  std::vector<double> M2s;
+
+  /**
+   * Mean of incomplete batch.
+   */
+  std::vector<double> mean;
+
+  /**
+   * Sum of squared deviations of incomplete batch.
+   */
+  std::vector<double> M2;
+
+  /**
+   * Last sample.
+   */
+  std::vector<double> last;
+
+  /**
+   * Number of accepted steps in the current window.
+   */
+  int accepted;
+
+  /**
+   * Number of steps in the current window.
+   */
+  int total;
+
+  /**
+   * Effective sample sizes.
+   */
+  std::vector<double> ess;
+
+  /**
+   * Split-\f$\hat{R}\f$ statistics.
+   */
+  std::vector<double> rhat;
+
+  /**
+   * Acceptance rate.
+   */
+  double rate;
+};
+}
+
+#include "../misc/assert.hpp"
+#include "../math/function.hpp"
+#ifdef ENABLE_MPI
+#include "../mpi/mpi.hpp"
+#endif
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+inline bi::MCMCDiagnostics::MCMCDiagnostics(const int N,
+    const int maxBatches) :
+    N(N), maxBatches(maxBatches), n(0), b(1), a(0), m(0), means(
+        maxBatches*N), M2s(maxBatches*N), mean(N, 0.0), M2(N, 0.0), last(N,
+        0.0), accepted(0), total(0), ess(N, 0.0), rhat(N,
+        std::numeric_limits<double>::quiet_NaN()), rate(0.0) {
+  /* pre-condition */
+  BI_ASSERT(N >= 0);
+  BI_ASSERT(maxBatches >= 4 && maxBatches % 2 == 0);
+}
+
+template<class V1>
+void bi::MCMCDiagnostics::add(const V1 theta) {
+  /* pre-condition */
+  BI_ASSERT(theta.size() == N);
+  BI_ASSERT(!V1::on_device);
+
+  double x, delta, mu1, mu2, d;
+  bool moved = false;
+  int i, k;
+
+  for (i = 0; i < N; ++i) {
+    x = theta(i);
+    moved = moved || x != last[i];
+    last[i] = x;
+
+    /* Welford update of incomplete batch */
+    delta = x - mean[i];
+    mean[i] += delta/(m + 1);
+    M2[i] += delta*(x - mean[i]);
+  }
+  if (n > 0) {
+    if (moved) {
+      ++accepted;
+    }
+    ++total;
+  }
+  ++n;
+  ++m;
+
+  if (m == b) {
+    /* complete batch */
+    std::copy(mean.begin(), mean.end(), means.begin() + a*N);
+    std::copy(M2.begin(), M2.end(), M2s.begin() + a*N);
+    std::fill(mean.begin(), mean.end(), 0.0);
+    std::fill(M2.begin(), M2.end(), 0.0);
+    m = 0;
+    ++a;
+
+    if (a == maxBatches) {
+      /* merge adjacent batches, which have the same size */
+      for (k = 0; k < a/2; ++k) {
+        for (i = 0; i < N; ++i) {
+          mu1 = means[2*k*N + i];
+          mu2 = means[(2*k + 1)*N + i];
+          d = mu2 - mu1;
+          means[k*N + i] = 0.5*(mu1 + mu2);
+          M2s[k*N + i] = M2s[2*k*N + i] + M2s[(2*k + 1)*N + i] + 0.5*b*d*d;
+        }
+      }
+      a /= 2;
+      b *= 2;
+    }
+  }
+}
+
+inline void bi::MCMCDiagnostics::diagnose() {
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  const int h = a/2;
+  std::vector<double> halves(4*N, nan);
+  double mu, var, ssb, sigma2;
+  int i, j;
+
+  /* ESS from batch means, moments of halves for split-R-hat */
+  for (i = 0; i < N; ++i) {
+    ess[i] = 0.0;
+    if (a >= 4) {
+      moments(i, 0, a, mu, var, ssb);
+      sigma2 = b*ssb/(a - 1);
+      if (sigma2 > 0.0) {
+        ess[i] = a*b*var/sigma2;
+      }
+      moments(i, 0, h, halves[4*i], halves[4*i + 1], ssb);
+      moments(i, a - h, a, halves[4*i + 2], halves[4*i + 3], ssb);
+    }
+  }
+
+  #ifdef ENABLE_MPI
+  boost::mpi::communicator world;
+  const int size = world.size();
+  std::vector<double> ess1(N);
+  std::vector<std::vector<double> > halves1;
+
+  if (N > 0) {
+    boost::mpi::all_reduce(world, &ess[0], N, &ess1[0],
+        std::plus<double>());
+    ess.swap(ess1);
+  }
+  boost::mpi::all_gather(world, halves, halves1);
+  accepted = boost::mpi::all_reduce(world, accepted, std::plus<int>());
+  total = boost::mpi::all_reduce(world, total, std::plus<int>());
+  #else
+  const int size = 1;
+  std::vector<std::vector<double> > halves1(1, halves);
+  #endif
+
+  /* split-R-hat, over two halves of each chain */
+  const int M = 2*size;
+  const double L = h*b;
+  double W, B, grand, mu1, var1;
+
+  for (i = 0; i < N; ++i) {
+    rhat[i] = nan;
+    if (a >= 4) {
+      W = 0.0;
+      grand = 0.0;
+      for (j = 0; j < M; ++j) {
+        W += halves1[j/2][4*i + 2*(j % 2) + 1];
+        grand += halves1[j/2][4*i + 2*(j % 2)];
+      }
+      W /= M;
+      grand /= M;
+      B = 0.0;
+      for (j = 0; j < M; ++j) {
+        mu1 = halves1[j/2][4*i + 2*(j % 2)];
+        B += (mu1 - grand)*(mu1 - grand);
+      }
+      B *= L/(M - 1);
+      if (W > 0.0) {
+        var1 = (L - 1.0)/L*W + B/L;
+        rhat[i] = bi::sqrt(var1/W);
+      }
+    }
+  }
+
+  /* acceptance rate over window */
+  rate = (total > 0) ? static_cast<double>(accepted)/total : 0.0;
+  accepted = 0;
+  total = 0;
+}
+
+inline int bi::MCMCDiagnostics::size() const {
+  return n;
+}
+
+inline const std::vector<double>& bi::MCMCDiagnostics::getESS() const {
+  return ess;
+}
+
+inline const std::vector<double>& bi::MCMCDiagnostics::getRHat() const {
+  return rhat;
+}
+
+inline double bi::MCMCDiagnostics::getMinESS() const {
+  if (N > 0) {
+    return *std::min_element(ess.begin(), ess.end());
+  } else {
+    return 0.0;
+  }
+}
+
+inline double bi::MCMCDiagnostics::getMaxRHat() const {
+  double mx = std::numeric_limits<double>::quiet_NaN();
+  for (int i = 0; i < N; ++i) {
+    if (rhat[i] == rhat[i] && !(rhat[i] <= mx)) {
+      mx = rhat[i];
+    }
+  }
+  return mx;
+}
+
+inline double bi::MCMCDiagnostics::getAcceptanceRate() const {
+  return rate;
+}
+
+inline void bi::MCMCDiagnostics::moments(const int i, const int k1,
+    const int k2, double& mu, double& var, double& ssb) const {
+  /* pre-condition */
+  BI_ASSERT(k1 >= 0 && k1 < k2 && k2 <= a);
+
+  const int nb = k2 - k1;
+  double sumM2 = 0.0, d;
+  int k;
+
+  mu = 0.0;
+  for (k = k1; k < k2; ++k) {
+    mu += means[k*N + i];
+    sumM2 += M2s[k*N + i];
+  }
+  mu /= nb;
+  ssb = 0.0;
+  for (k = k1; k < k2; ++k) {
+    d = means[k*N + i] - mu;
+    ssb += d*d;
+  }
+  var = (sumM2 + b*ssb)/(nb*b - 1);
+}
+
+#endif
@@ -0,0 +1,249 @@
+/**
+ * @file
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ */
+#ifndef BI_PDF_QUANTILESKETCH_HPP
+#define BI_PDF_QUANTILESKETCH_HPP
+
+#include <vector>
+#include <utility>
+
+namespace bi {
+/**
+ * Sketch of a weighted sample set, for approximate quantiles.
+ *
+ * @ingroup math_pdf
+ *
+ * A merging t-digest (@ref Dunning2019 "Dunning \& Ertl, 2019"). Weighted
+ * samples are gathered into centroids, each the weighted mean of samples
+ * adjacent in rank, with the weight of each centroid bounded by a scale
+ * function of its rank, so that centroids are small in the tails and large
+ * in the body of the distribution. The error of a quantile is therefore
+ * bounded in rank rather than in value, and is not affected by outliers,
+ * however far out or lightly weighted. Memory is bounded by the
+ * compression, regardless of the number of samples, and no range need be
+ * known in advance. Sketches may be merged, so that each thread can build a
+ * sketch over a subset of samples, with the results combined afterward.
+ */
+class QuantileSketch {
+public:
+  /**
+   * Constructor.
+   *
+   * @param delta Compression. The number of centroids is at most about
+   * this, and the error in the rank of a quantile about its inverse, less
+   * in the tails.
+   */
+  QuantileSketch(const double delta = 200.0);
+
+  /**
+   * Empty the sketch.
+   */
+  void clear();
+
+  /**
+   * Add sample.
+   *
+   * @param x Sample.
+   * @param w Weight of sample. Need not be normalised.
+   */
+  void add(const double x, const double w);
+
+  /**
+   * Merge another sketch into this one.
+   *
+   * @param o Other sketch.
+   */
+  void merge(const QuantileSketch& o);
+
+  /**
+   * Compute quantile.
+   *
+   * @param q Level, in \f$[0,1]\f$.
+   *
+   * @return Quantile, or NaN if the sketch holds no weight.
+   */
+  double quantile(const double q) const;
+
+private:
+  /**
+   * Centroid type, mean and weight.
+   */
+  typedef std::pair<double,double> centroid_type;
+
+  /**
+   * Merge buffered samples into centroids.
+   */
+  void compress() const;
+
+  /**
+   * Scale function, mapping a level to an index of centroids.
+   */
+  double k(const double q) const;
+
+  /**
+   * Inverse of scale function.
+   */
+  double kinv(const double k) const;
+
+  /**
+   * Compression.
+   */
+  double delta;
+
+  /**
+   * Centroids, sorted by mean.
+   */
+  mutable std::vector<centroid_type> centroids;
+
+  /**
+   * Samples not yet merged into centroids.
+   */
+  mutable std::vector<centroid_type> buffer;
+
+  /**
+   * Smallest sample.
+   */
+  double lower;
+
+  /**
+   * Largest sample.
+   */
+  double upper;
+
+  /**
+   * Total weight.
+   */
+  double W;
+};
+}
+
+#include "../misc/assert.hpp"
+#include "../math/function.hpp"
+#include "../math/constant.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+inline bi::QuantileSketch::QuantileSketch(const double delta) :
+    delta(delta), lower(BI_INF), upper(-BI_INF), W(0.0) {
+  /* pre-condition */
+  BI_ASSERT(delta > 0.0);
+}
+
+inline void bi::QuantileSketch::clear() {
+  centroids.clear();
+  buffer.clear();
+  lower = BI_INF;
+  upper = -BI_INF;
+  W = 0.0;
+}
+
+inline void bi::QuantileSketch::add(const double x, const double w) {
+  if (w > 0.0) {
+    buffer.push_back(std::make_pair(x, w));
+    lower = bi::min(lower, x);
+    upper = bi::max(upper, x);
+    W += w;
+    if (buffer.size() >= 5.0*delta) {
+      compress();
+    }
+  }
+}
+
+inline void bi::QuantileSketch::merge(const QuantileSketch& o) {
+  buffer.insert(buffer.end(), o.centroids.begin(), o.centroids.end());
+  buffer.insert(buffer.end(), o.buffer.begin(), o.buffer.end());
+  lower = bi::min(lower, o.lower);
+  upper = bi::max(upper, o.upper);
+  W += o.W;
+  compress();
+}
+
+inline double bi::QuantileSketch::quantile(const double q) const {
+  /* pre-condition */
+  BI_ASSERT(q >= 0.0 && q <= 1.0);
+
+  if (W <= 0.0) {
+    return std::numeric_limits<double>::quiet_NaN();
+  }
+  compress();
+
+  /* each centroid is taken to sit at the middle of its cumulative weight,
+   * interpolating linearly between them, and to the extreme samples at
+   * either end */
+  const int n = static_cast<int>(centroids.size());
+  double total = 0.0, centre, next;
+  int i;
+
+  for (i = 0; i < n; ++i) {
+    total += centroids[i].second;
+  }
+  const double target = q*total;
+
+  centre = 0.5*centroids[0].second;
+  if (target <= centre) {
+    return lower + (centroids[0].first - lower)*target/centre;
+  }
+  for (i = 0; i < n - 1; ++i) {
+    next = centre + 0.5*(centroids[i].second + centroids[i + 1].second);
+    if (target < next) {
+      return centroids[i].first + (centroids[i + 1].first -
+          centroids[i].first)*(target - centre)/(next - centre);
+    }
+    centre = next;
+  }
+  return centroids[i].first + (upper - centroids[i].first)*
+      bi::min(1.0, (target - centre)/(total - centre));
+}
+
+inline void bi::QuantileSketch::compress() const {
+  if (buffer.empty()) {
+    return;
+  }
+
+  buffer.insert(buffer.end(), centroids.begin(), centroids.end());
+  std::sort(buffer.begin(), buffer.end());
+  centroids.clear();
+
+  /* total weight of buffer, rather than W, as the two may differ by
+   * rounding */
+  double total = 0.0;
+  for (int i = 0; i < static_cast<int>(buffer.size()); ++i) {
+    total += buffer[i].second;
+  }
+
+  /* greedily merge neighbours while the centroid stays within one unit of
+   * the scale function */
+  centroid_type cur = buffer[0];
+  double before = 0.0;
+  double limit = total*kinv(k(0.0) + 1.0);
+  for (int i = 1; i < static_cast<int>(buffer.size()); ++i) {
+    const centroid_type& x = buffer[i];
+    if (before + cur.second + x.second <= limit) {
+      cur.second += x.second;
+      cur.first += (x.first - cur.first)*x.second/cur.second;
+    } else {
+      centroids.push_back(cur);
+      before += cur.second;
+      limit = total*kinv(k(before/total) + 1.0);
+      cur = x;
+    }
+  }
+  centroids.push_back(cur);
+  buffer.clear();
+}
+
+inline double bi::QuantileSketch::k(const double q) const {
+  return delta*std::asin(2.0*bi::min(1.0, q) - 1.0)/BI_TWO_PI;
+}
+
+inline double bi::QuantileSketch::kinv(const double k) const {
+  return k >= 0.25*delta ? 1.0 : 0.5*(std::sin(k*BI_TWO_PI/delta) + 1.0);
+}
+
+#endif
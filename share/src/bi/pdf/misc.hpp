@@ -201,6 +201,38 @@ template<class M1, class M2, class V1, class V2, class V3, class M3>
 void cross(const M1 X, const M2 Y, const V1 w, const V2 muX, const V3 muY,
     M3 SigmaXY);
 
+/**
+ * Compute weighted summary statistics of sample set.
+ *
+ * @ingroup math_pdf
+ *
+ * @tparam M1 Matrix type.
+ * @tparam V1 Vector type.
+ * @tparam V2 Vector type.
+ * @tparam V3 Vector type.
+ * @tparam V4 Vector type.
+ * @tparam M2 Matrix type.
+ *
+ * @param X Sample set. Rows index samples, columns index variables.
+ * @param lws Log-weights.
+ * @param qs Quantile levels.
+ * @param[out] mu Mean.
+ * @param[out] sigma Variance.
+ * @param[out] Q Quantiles. Rows index levels, columns index variables.
+ *
+ * All arguments must be on host. The samples are split between threads,
+ * each of which accumulates the moments of its samples and a QuantileSketch
+ * for each variable, before these are merged. This takes one pass over the
+ * samples, and little memory beyond the outputs, so is suited to large
+ * sample sets where sorting, as for exact quantiles, would not be.
+ * Quantiles are approximate, with error bounded in rank, not value.
+ *
+ * @note Normalises the variance by the sum of weights, as var() does.
+ */
+template<class M1, class V1, class V2, class V3, class V4, class M2>
+void summarise(const M1 X, const V1 lws, const V2 qs, V3 mu, V4 sigma,
+    M2 Q);
+
 /**
  * Exponentiate components of a vector.
  *
@@ -318,9 +350,14 @@ void det_rows(const M2 X, const V2& is, V3 det);
 
 }
 
+#include "QuantileSketch.hpp"
 #include "../math/misc.hpp"
 #include "../math/sim_temp_vector.hpp"
 #include "../math/sim_temp_matrix.hpp"
+#include "../misc/omp.hpp"
+
+#include <vector>
+#include <limits>
 
 template<class V1>
 void bi::renormalise(V1 lws) {
@@ -509,6 +546,94 @@ void bi::cross(const M1 X, const M2 Y, const V1 w, const V2 muX,
   matrix_scal(1.0/(1.0 - W2t/Wt2), SigmaXY);
 }
 
+template<class M1, class V1, class V2, class V3, class V4, class M2>
+void bi::summarise(const M1 X, const V1 lws, const V2 qs, V3 mu, V4 sigma,
+    M2 Q) {
+  /* pre-conditions */
+  BI_ASSERT(X.size1() == lws.size());
+  BI_ASSERT(X.size2() == mu.size());
+  BI_ASSERT(X.size2() == sigma.size());
+  BI_ASSERT(Q.size1() == qs.size() && Q.size2() == X.size2());
+  BI_ASSERT(!M1::on_device);
+  BI_ASSERT(!V1::on_device);
+  BI_ASSERT(!V3::on_device);
+  BI_ASSERT(!V4::on_device);
+  BI_ASSERT(!M2::on_device);
+
+  /* number of variables summarised at once, limiting memory for sketches */
+  static const int C = 64;
+
+  const int P = X.size1();
+  const int N = X.size2();
+  const double mx = (P > 0) ? max_reduce(lws) : 0.0;
+  std::vector<double> ws(P);
+  int p;
+
+  /* weights, with non-finite log-weights as zero */
+  #pragma omp parallel for schedule(static)
+  for (p = 0; p < P; ++p) {
+    ws[p] = bi::is_finite(lws(p)) ? bi::exp(lws(p) - mx) : 0.0;
+  }
+
+  for (int j0 = 0; j0 < N; j0 += C) {
+    const int nc = bi::min(C, N - j0);
+    std::vector<double> W(nc, 0.0), m(nc, 0.0), S(nc, 0.0);
+    std::vector<QuantileSketch> sketches(nc);
+
+    #pragma omp parallel
+    {
+      std::vector<double> W1(nc, 0.0), m1(nc, 0.0), S1(nc, 0.0);
+      std::vector<QuantileSketch> sketches1(nc);
+      double x, w, d, W2;
+      int j, p;
+
+      /* weighted moments by Welford's method, and sketches */
+      for (j = 0; j < nc; ++j) {
+        #pragma omp for schedule(static) nowait
+        for (p = 0; p < P; ++p) {
+          x = X(p, j0 + j);
+          w = ws[p];
+          if (w > 0.0) {
+            W1[j] += w;
+            d = x - m1[j];
+            m1[j] += d*w/W1[j];
+            S1[j] += w*d*(x - m1[j]);
+            sketches1[j].add(x, w);
+          }
+        }
+      }
+
+      /* merge, with the pairwise update of Chan, Golub & LeVeque (1983) */
+      #pragma omp critical
+      {
+        for (j = 0; j < nc; ++j) {
+          if (W1[j] > 0.0) {
+            W2 = W[j] + W1[j];
+            d = m1[j] - m[j];
+            m[j] += d*W1[j]/W2;
+            S[j] += S1[j] + d*d*W[j]*W1[j]/W2;
+            W[j] = W2;
+            sketches[j].merge(sketches1[j]);
+          }
+        }
+      }
+    }
+
+    for (int j = 0; j < nc; ++j) {
+      if (W[j] > 0.0) {
+        mu(j0 + j) = m[j];
+        sigma(j0 + j) = S[j]/W[j];
+      } else {
+        mu(j0 + j) = std::numeric_limits<double>::quiet_NaN();
+        sigma(j0 + j) = std::numeric_limits<double>::quiet_NaN();
+      }
+      for (int i = 0; i < qs.size(); ++i) {
+        Q(i, j0 + j) = sketches[j].quantile(qs(i));
+      }
+    }
+  }
+}
+
 template<class V2, class V3>
 inline void bi::exp_vector(V2 x, const V3& is) {
   BOOST_AUTO(iter, is.begin());
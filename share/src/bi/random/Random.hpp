@@ -18,6 +18,8 @@
 #endif
 
 namespace bi {
+class RandomTape;
+
 /**
  * Manager for pseudorandom number generation (PRNG).
  *
@@ -224,6 +226,39 @@ public:
   void gammas(V1 x, const typename V1::value_type alpha = 1.0,
       const typename V1::value_type beta = 1.0);
 
+  /**
+   * Fill vector with random numbers from Poisson distributions, with a
+   * different rate for each element.
+   *
+   * @tparam V1 Vector type.
+   * @tparam V2 Vector type.
+   *
+   * @param lambdas Rates.
+   * @param[out] x Vector.
+   *
+   * Intended for drawing across particles in one pass; the sampler has no
+   * set up cost, so rates may differ freely between elements.
+   */
+  template<class V1, class V2>
+  void poissons(const V1 lambdas, V2 x);
+
+  /**
+   * Fill vector with random numbers from binomial distributions, with a
+   * different size and probability for each element.
+   *
+   * @tparam V1 Vector type.
+   * @tparam V2 Vector type.
+   * @tparam V3 Vector type.
+   *
+   * @param ns Sizes.
+   * @param ps Probabilities.
+   * @param[out] x Vector.
+   *
+   * @see poissons()
+   */
+  template<class V1, class V2, class V3>
+  void binomials(const V1 ns, const V2 ps, V3 x);
+
   /**
    * Fill vector with random numbers from a beta distribution with given
    * parameters.
@@ -238,6 +273,22 @@ public:
   template<class V1>
   void betas(V1 x, const typename V1::value_type alpha = 1.0,
       const typename V1::value_type beta = 1.0);
+
+  /**
+   * Start replaying variates on host from tapes of auxiliary variables.
+   *
+   * @param[in,out] tape Tapes, one for each host thread.
+   *
+   * Until stopReplay(), each host thread draws all variates from its tape,
+   * extending it as necessary; see RngHost. Variates drawn on device are
+   * not affected.
+   */
+  void startReplay(RandomTape& tape);
+
+  /**
+   * Stop replaying variates on host.
+   */
+  void stopReplay();
   //@}
 
   /**
@@ -281,6 +332,7 @@ public:
 };
 }
 
+#include "RandomTape.hpp"
 #include "../host/random/RandomHost.hpp"
 #ifdef ENABLE_CUDA
 #include "../cuda/random/RandomGPU.hpp"
@@ -348,6 +400,35 @@ void bi::Random::gammas(V1 x, const typename V1::value_type alpha,
   impl::gammas(*this, x, alpha, beta);
 }
 
+template<class V1, class V2>
+void bi::Random::poissons(const V1 lambdas, V2 x) {
+  /* pre-condition */
+  BI_ASSERT(lambdas.size() == x.size());
+  BI_ASSERT(V1::on_device == V2::on_device);
+
+#ifdef ENABLE_CUDA
+  typedef typename boost::mpl::if_c<V2::on_device,RandomGPU,RandomHost>::type impl;
+#else
+  typedef RandomHost impl;
+#endif
+  impl::poissons(*this, lambdas, x);
+}
+
+template<class V1, class V2, class V3>
+void bi::Random::binomials(const V1 ns, const V2 ps, V3 x) {
+  /* pre-condition */
+  BI_ASSERT(ns.size() == x.size() && ps.size() == x.size());
+  BI_ASSERT(V1::on_device == V3::on_device);
+  BI_ASSERT(V2::on_device == V3::on_device);
+
+#ifdef ENABLE_CUDA
+  typedef typename boost::mpl::if_c<V3::on_device,RandomGPU,RandomHost>::type impl;
+#else
+  typedef RandomHost impl;
+#endif
+  impl::binomials(*this, ns, ps, x);
+}
+
 template<class V1>
 void bi::Random::betas(V1 x, const typename V1::value_type alpha,
     const typename V1::value_type beta) {
@@ -369,6 +450,18 @@ void bi::Random::multinomials(const V1 lps, V2 xs) {
   impl::multinomials(*this, lps, xs);
 }
 
+inline void bi::Random::startReplay(RandomTape& tape) {
+  for (int tid = 0; tid < bi_omp_max_threads; ++tid) {
+    hostRngs[tid].startReplay(tape.get(tid));
+  }
+}
+
+inline void bi::Random::stopReplay() {
+  for (int tid = 0; tid < bi_omp_max_threads; ++tid) {
+    hostRngs[tid].stopReplay();
+  }
+}
+
 inline bi::RngHost& bi::Random::getHostRng() {
   return hostRngs[bi_omp_tid];
 }
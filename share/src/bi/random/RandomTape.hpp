@@ -0,0 +1,138 @@
+/**
+ * @file
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ */
+#ifndef BI_RANDOM_RANDOMTAPE_HPP
+#define BI_RANDOM_RANDOMTAPE_HPP
+
+#include "../misc/omp.hpp"
+
+#include <vector>
+
+namespace bi {
+class Random;
+
+/**
+ * Tapes of auxiliary variables from which variates may be replayed, one
+ * for each host thread.
+ *
+ * @ingroup math_rng
+ *
+ * Passed to Random::startReplay(), so that all variates subsequently drawn
+ * on host are a deterministic function of the tapes (see RngHost). The
+ * tapes hold standard Gaussian variables, and are extended as needed, so
+ * begin empty.
+ *
+ * For correlated pseudo-marginal methods
+ * (@ref Deligiannidis2018 "Deligiannidis, Doucet & Pitt, 2018"), perturb()
+ * makes a Crank-Nicolson proposal from the tapes of the current state. This
+ * leaves the standard Gaussian distribution of the tapes invariant, and,
+ * as the variates drawn from either tape are similar, the two estimates of
+ * the likelihood computed with them are strongly correlated.
+ *
+ * Variates are drawn from each tape in the order that the thread requests
+ * them, so that the correspondence between the auxiliary variables and
+ * their use is preserved only with static scheduling of loops, the same
+ * number of threads, and the same number of variates drawn by each
+ * particle. Rejection samplers, in particular, may consume variable numbers
+ * of variates, after which the correlation is reduced, though it remains
+ * valid.
+ */
+class RandomTape {
+public:
+  /**
+   * Constructor.
+   */
+  RandomTape();
+
+  /**
+   * Get the tape of a thread.
+   *
+   * @param tid Thread number.
+   */
+  std::vector<double>& get(const int tid);
+
+  /**
+   * Set to a Crank-Nicolson perturbation of other tapes.
+   *
+   * @param[in,out] rng Random number generator.
+   * @param o Other tapes.
+   * @param rho Correlation.
+   *
+   * Each auxiliary variable is set to
+   * \f$\rho u + \sqrt{1 - \rho^2}\,\epsilon\f$, where \f$u\f$ is the
+   * corresponding variable in @p o and \f$\epsilon\f$ a new standard
+   * Gaussian variate. Those beyond the end of the tapes of @p o are
+   * removed, to be drawn afresh when needed.
+   */
+  void perturb(Random& rng, const RandomTape& o, const double rho);
+
+  /**
+   * Clear all tapes.
+   */
+  void clear();
+
+  /**
+   * Swap with other tapes.
+   */
+  void swap(RandomTape& o);
+
+private:
+  /**
+   * Tapes.
+   */
+  std::vector<std::vector<double> > tapes;
+};
+}
+
+#include "Random.hpp"
+#include "../math/function.hpp"
+
+inline bi::RandomTape::RandomTape() :
+    tapes(bi_omp_max_threads) {
+  //
+}
+
+inline std::vector<double>& bi::RandomTape::get(const int tid) {
+  /* pre-condition */
+  BI_ASSERT(tid >= 0 && tid < static_cast<int>(tapes.size()));
+
+  return tapes[tid];
+}
+
+inline void bi::RandomTape::perturb(Random& rng, const RandomTape& o,
+    const double rho) {
+  /* pre-condition */
+  BI_ASSERT(rho >= 0.0 && rho < 1.0);
+  BI_ASSERT(tapes.size() == o.tapes.size());
+
+  const double sigma = bi::sqrt(1.0 - rho*rho);
+  RngHost& rng1 = rng.getHostRng();
+  int k, i, n;
+
+  for (k = 0; k < static_cast<int>(tapes.size()); ++k) {
+    n = static_cast<int>(o.tapes[k].size());
+    tapes[k].resize(n);
+    if (n > 0) {
+      rng1.gaussians(&tapes[k][0], n);
+    }
+    for (i = 0; i < n; ++i) {
+      tapes[k][i] = rho*o.tapes[k][i] + sigma*tapes[k][i];
+    }
+  }
+}
+
+inline void bi::RandomTape::clear() {
+  for (int k = 0; k < static_cast<int>(tapes.size()); ++k) {
+    tapes[k].clear();
+  }
+}
+
+inline void bi::RandomTape::swap(RandomTape& o) {
+  tapes.swap(o.tapes);
+}
+
+#endif
@@ -7,6 +7,16 @@
  * @author Lawrence Murray <lawrence.murray@csiro.au>
  * $Rev$
  * $Date$
+ *
+ * @section generic_references References
+ *
+ * @anchor Hormann1993a H&ouml;rmann, W. The transformed rejection method
+ * for generating Poisson random variables. <i>Insurance: Mathematics and
+ * Economics</i>, <b>1993</b>, 12, 39-45.
+ *
+ * @anchor Hormann1993b H&ouml;rmann, W. The generation of binomial random
+ * variates. <i>Journal of Statistical Computation and Simulation</i>,
+ * <b>1993</b>, 46, 101-110.
  */
 #ifndef BI_RANDOM_GENERIC_HPP
 #define BI_RANDOM_GENERIC_HPP
@@ -96,6 +106,59 @@ CUDA_FUNC_BOTH T1 betabin(R& rng, const T1 n = 1.0, const T1 alpha = 1.0,
 template<class R, class T1>
 CUDA_FUNC_BOTH T1 exponential(R& rng, const T1 lambda = 1.0);
 
+/**
+ * Generate a random number from a Poisson distribution with given rate.
+ *
+ * @tparam R Random number generator type.
+ * @tparam T1 Scalar type.
+ *
+ * @param[in,out] rng Random number generator.
+ * @param lambda Rate.
+ *
+ * @return The random number.
+ *
+ * Uses inversion for small rates and the transformed rejection method PTRS
+ * of @ref Hormann1993a "H&ouml;rmann (1993a)" otherwise. Neither requires
+ * set up beyond a handful of arithmetic operations, so the rate may differ
+ * from one call to the next at no extra cost.
+ */
+template<class R, class T1>
+CUDA_FUNC_BOTH T1 poisson(R& rng, const T1 lambda = 1.0);
+
+/**
+ * Generate a random number from a binomial distribution with given
+ * parameters.
+ *
+ * @tparam R Random number generator type.
+ * @tparam T1 Scalar type.
+ * @tparam T2 Scalar type.
+ *
+ * @param[in,out] rng Random number generator.
+ * @param n Number of trials.
+ * @param p Probability of success.
+ *
+ * @return The random number.
+ *
+ * Uses inversion when the mean of the smaller tail is small and the
+ * transformed rejection method BTRS of @ref Hormann1993b
+ * "H&ouml;rmann (1993b)" otherwise. As for poisson(), parameters may differ
+ * from one call to the next at no extra cost.
+ */
+template<class R, class T1, class T2>
+CUDA_FUNC_BOTH T1 binomial(R& rng, const T1 n = 1.0, const T2 p = 0.5);
+
+/**
+ * Logarithm of the factorial, for use by the rejection samplers.
+ *
+ * @tparam T1 Scalar type.
+ *
+ * @param k Nonnegative integer value.
+ *
+ * Uses the Stirling series with three terms of correction above 10.
+ */
+template<class T1>
+CUDA_FUNC_BOTH T1 log_factorial(const T1 k);
+
 }
 
 template<class R, class T1>
@@ -198,6 +261,143 @@ inline T1 bi::betabin(R& rng, const T1 n, const T1 alpha, const T1 beta) {
   return u;
 }
 
+template<class R, class T1>
+inline T1 bi::poisson(R& rng, const T1 lambda) {
+  /* pre-condition */
+  BI_ASSERT(lambda >= static_cast<T1>(0.0));
+
+  const T1 zero = static_cast<T1>(0.0);
+  const T1 one = static_cast<T1>(1.0);
+  T1 k;
+
+  if (lambda <= zero) {
+    k = zero;
+  } else if (lambda < static_cast<T1>(10.0)) {
+    /* inversion by multiplication of uniforms */
+    const T1 enlam = bi::exp(-lambda);
+    T1 prod = rng.uniform(zero, one);
+
+    k = zero;
+    while (prod > enlam) {
+      k += one;
+      prod *= rng.uniform(zero, one);
+    }
+  } else {
+    /* PTRS */
+    const T1 slam = bi::sqrt(lambda);
+    const T1 loglam = bi::log(lambda);
+    const T1 b = static_cast<T1>(0.931) + static_cast<T1>(2.53)*slam;
+    const T1 a = static_cast<T1>(-0.059) + static_cast<T1>(0.02483)*b;
+    const T1 invalpha = static_cast<T1>(1.1239)
+        + static_cast<T1>(1.1328)/(b - static_cast<T1>(3.4));
+    const T1 vr = static_cast<T1>(0.9277)
+        - static_cast<T1>(3.6224)/(b - static_cast<T1>(2.0));
+    T1 u, v, us;
+
+    while (true) {
+      u = rng.uniform(zero, one) - static_cast<T1>(0.5);
+      v = rng.uniform(zero, one);
+      us = static_cast<T1>(0.5) - bi::abs(u);
+      k = bi::floor((static_cast<T1>(2.0)*a/us + b)*u + lambda
+          + static_cast<T1>(0.43));
+      if (us >= static_cast<T1>(0.07) && v <= vr) {
+        break;
+      }
+      if (k < zero || (us < static_cast<T1>(0.013) && v > us)) {
+        continue;
+      }
+      if (bi::log(v*invalpha/(a/(us*us) + b))
+          <= -lambda + k*loglam - log_factorial(k)) {
+        break;
+      }
+    }
+  }
+  return k;
+}
+
+template<class R, class T1, class T2>
+inline T1 bi::binomial(R& rng, const T1 n, const T2 p) {
+  /* pre-condition */
+  BI_ASSERT(n >= static_cast<T1>(0.0));
+  BI_ASSERT(p >= static_cast<T2>(0.0));
+  BI_ASSERT(p <= static_cast<T2>(1.0));
+
+  const T1 zero = static_cast<T1>(0.0);
+  const T1 one = static_cast<T1>(1.0);
+  const T1 n1 = bi::floor(n);
+  const bool flip = p > static_cast<T2>(0.5);
+  const T1 p1 = flip ? one - p : p;
+  const T1 q1 = one - p1;
+  T1 k;
+
+  if (n1 <= zero || p1 <= zero) {
+    k = zero;
+  } else if (n1*p1 < static_cast<T1>(10.0)) {
+    /* inversion, restarting in the rare case that rounding error carries
+     * the search beyond n */
+    const T1 s = p1/q1;
+    const T1 a = (n1 + one)*s;
+    const T1 r0 = bi::pow(q1, n1);
+    T1 r, u;
+
+    do {
+      r = r0;
+      u = rng.uniform(zero, one);
+      k = zero;
+      while (u > r && k <= n1) {
+        u -= r;
+        k += one;
+        r *= a/k - s;
+      }
+    } while (k > n1);
+  } else {
+    /* BTRS */
+    const T1 spq = bi::sqrt(n1*p1*q1);
+    const T1 b = static_cast<T1>(1.15) + static_cast<T1>(2.53)*spq;
+    const T1 a = static_cast<T1>(-0.0873) + static_cast<T1>(0.0248)*b
+        + static_cast<T1>(0.01)*p1;
+    const T1 c = n1*p1 + static_cast<T1>(0.5);
+    const T1 vr = static_cast<T1>(0.92) - static_cast<T1>(4.2)/b;
+    const T1 alpha = (static_cast<T1>(2.83) + static_cast<T1>(5.1)/b)*spq;
+    const T1 lpq = bi::log(p1/q1);
+    const T1 m = bi::floor((n1 + one)*p1);
+    const T1 h = log_factorial(m) + log_factorial(n1 - m);
+    T1 u, v, us;
+
+    while (true) {
+      u = rng.uniform(zero, one) - static_cast<T1>(0.5);
+      v = rng.uniform(zero, one);
+      us = static_cast<T1>(0.5) - bi::abs(u);
+      k = bi::floor((static_cast<T1>(2.0)*a/us + b)*u + c);
+      if (k < zero || k > n1) {
+        continue;
+      }
+      if (us >= static_cast<T1>(0.07) && v <= vr) {
+        break;
+      }
+      v = bi::log(v*alpha/(a/(us*us) + b));
+      if (v <= h - log_factorial(k) - log_factorial(n1 - k) + (k - m)*lpq) {
+        break;
+      }
+    }
+  }
+  return flip ? n1 - k : k;
+}
+
+template<class T1>
+inline T1 bi::log_factorial(const T1 k) {
+  if (k < static_cast<T1>(10.0)) {
+    return bi::lgamma(k + static_cast<T1>(1.0));
+  } else {
+    const T1 r = static_cast<T1>(1.0)/k;
+    const T1 r2 = r*r;
+    return (k + static_cast<T1>(0.5))*bi::log(k) - k
+        + static_cast<T1>(0.91893853320467274)
+        + r*(static_cast<T1>(1.0/12.0) - r2*(static_cast<T1>(1.0/360.0)
+        - r2*static_cast<T1>(1.0/1260.0)));
+  }
+}
+
 template<class R, class T1>
 inline T1 bi::exponential(R& rng, const T1 lambda) {
   /* pre-condition */
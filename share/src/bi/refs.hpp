@@ -22,15 +22,43 @@
  * Bentley, J. L. & Saxe, J. B. Generating sorted lists of random numbers.
  * <i>Carnegie Mellon University</i>, <b>1979</b>.
  *
+ * @anchor Chen2000
+ * Chen, R. & Liu, J. S. Mixture Kalman filters. <i>Journal of the Royal
+ * Statistical Society B</i>, <b>2000</b>, 62, 493-508.
+ *
  * @anchor Chopin2013
  * Chopin, N.; Jacob, P. & Papaspiliopoulos, O. SMC\f$^2\f$: An Efficient
  * Algorithm for Sequential Analysis of State Space Models. <i>Journal of the
  * Royal Statistical Society B</b>, <b>2013</b>, 75, 397-426.
  *
+ * @anchor Deligiannidis2018
+ * Deligiannidis, G.; Doucet, A. & Pitt, M. K. The correlated
+ * pseudo-marginal method. <i>Journal of the Royal Statistical Society
+ * B</i>, <b>2018</b>, 80, 839-870.
+ *
  * @anchor DelMoral2014
  * Del Moral, P. & Murray L. M. Sequential Monte Carlo with highly informative
  * observations. <b>2014</b>. http://arxiv.org/abs/1405.4081.
  *
+ * @anchor Doucet2015
+ * Doucet, A.; Pitt, M. K.; Deligiannidis, G. & Kohn, R. Efficient
+ * implementation of Markov chain Monte Carlo when using an unbiased
+ * likelihood estimator. <i>Biometrika</i>, <b>2015</b>, 102, 295-313.
+ *
+ * @anchor Dunning2019
+ * Dunning, T. & Ertl, O. Computing extremely accurate quantiles using
+ * t-digests. <b>2019</b>. http://arxiv.org/abs/1902.04023.
+ *
+ * @anchor Flegal2010
+ * Flegal, J. M. & Jones, G. L. Batch means and spectral variance estimators
+ * in Markov chain Monte Carlo. <i>The Annals of Statistics</i>,
+ * <b>2010</b>, 38, 1034-1070.
+ *
+ * @anchor Gelman2013
+ * Gelman, A.; Carlin, J. B.; Stern, H. S.; Dunson, D. B.; Vehtari, A. &
+ * Rubin, D. B. <i>Bayesian Data Analysis</i>. Chapman & Hall/CRC,
+ * <b>2013</b>, third edition.
+ *
  * @anchor Gray2001
  * Gray, A. G. & Moore, A. W. `N-Body' Problems in Statistical
  * Learning. <i>Advances in Neural Information Processing Systems</i>,
@@ -59,6 +87,11 @@
  * Nonlinear %State Space Models. <i>Journal of Computational and
  * Graphical Statistics</i>, <b>1996</b>, 5, 1-25.
  *
+ * @anchor Lindsten2014
+ * Lindsten, F.; Jordan, M. I. & Schön, T. B. Particle Gibbs with ancestor
+ * sampling. <i>Journal of Machine Learning Research</i>, <b>2014</b>, 15,
+ * 2145-2184.
+ *
  * @anchor Marsaglia2000
  * Marsaglia, G. & Tsang, W. W. A Simple Method for Generating Gamma
  * Variables. <i>ACM Transactions on Mathematical Software</i>, <b>2000</b>,
@@ -107,6 +140,11 @@
  * Särkkä, S. Unscented Rauch-Tung-Striebel Smoother. <i>IEEE Transactions on
  * Automated Control</i>, <b>2008</b>, 53, 845-849.
  *
+ * @anchor Schon2005
+ * Schön, T.; Gustafsson, F. & Nordlund, P.-J. Marginalized particle filters
+ * for mixed linear/nonlinear state-space models. <i>IEEE Transactions on
+ * Signal Processing</i>, <b>2005</b>, 53, 2279-2289.
+ *
  * @anchor Silverman1986
  * Silverman, B.W. <i>Density Estimation for Statistics and Data
  * Analysis</i>. Chapman and Hall, <b>1986</b>.
@@ -13,6 +13,16 @@
 #include "../misc/exception.hpp"
 
 namespace bi {
+/**
+ * Precomputed results for MetropolisResampler.
+ */
+struct MetropolisResamplerPrecompute {
+  /**
+   * Number of Metropolis steps to take.
+   */
+  int B;
+};
+
 /**
  * Metropolis resampler for particle filter.
  *
@@ -20,17 +30,25 @@ namespace bi {
  *
  * Implements the Metropolis resampler as described in @ref Murray2011a
  * "Murray (2011)" and @ref Murray2014 "Murray, Lee & Jacob (2014)".
+ *
+ * If the number of steps is zero, it is chosen anew each time that
+ * resampling is performed, from the spread of the log-weights, as the
+ * smallest number for which the bound of @ref Murray2014 "Murray, Lee &
+ * Jacob (2014)" on the bias is within a given tolerance. With
+ * \f$\beta\f$ the ratio of the mean to the maximum weight, this is
+ * \f$B = \lceil\log\epsilon/\log(1 - \beta)\rceil\f$.
  */
 class MetropolisResampler {
 public:
   /**
    * Constructor.
    *
-   * @param B Number of Metropolis steps to take.
-   * @param essRel Minimum ESS, as proportion of total number of particles,
-   * to trigger resampling.
+   * @param B Number of Metropolis steps to take, zero to choose
+   * automatically.
+   * @param bias Tolerance on bias when choosing the number of steps
+   * automatically.
    */
-  MetropolisResampler(const int B = 0);
+  MetropolisResampler(const int B = 0, const double bias = 0.01);
 
   /**
    * Get number of steps.
@@ -42,32 +60,53 @@ public:
    */
   void setSteps(const int B);
 
+  /**
+   * Get bias tolerance.
+   */
+  double getBias() const;
+
+  /**
+   * Set bias tolerance.
+   */
+  void setBias(const double bias);
+
   /**
    * @copydoc MultinomialResampler::ancestors
    */
-  template<class V1, class V2, Location L>
+  template<class V1, class V2>
   void ancestors(Random& rng, const V1 lws, V2 as,
-      ResamplerPrecompute<L>& pre) throw (ParticleFilterDegeneratedException);
+      MetropolisResamplerPrecompute& pre) throw (ParticleFilterDegeneratedException);
 
   /**
    * @copydoc MultinomialResampler::ancestorsPermute
    */
-  template<class V1, class V2, Location L>
+  template<class V1, class V2>
   void ancestorsPermute(Random& rng, const V1 lws, V2 as,
-      ResamplerPrecompute<L>& pre) throw (ParticleFilterDegeneratedException);
+      MetropolisResamplerPrecompute& pre) throw (ParticleFilterDegeneratedException);
 
   /**
    * @copydoc MultinomialResampler::offspring
    */
-  template<class V1, class V2, Location L>
+  template<class V1, class V2>
   void offspring(Random& rng, const V1 lws, const int P, V2 os,
-      ResamplerPrecompute<L>& pre) throw (ParticleFilterDegeneratedException);
+      MetropolisResamplerPrecompute& pre) throw (ParticleFilterDegeneratedException);
+
+  /**
+   * @copydoc Resampler::precompute
+   */
+  template<class V1>
+  void precompute(const V1 lws, MetropolisResamplerPrecompute& pre);
 
 private:
   /**
-   * Number of Metropolis steps to take.
+   * Number of Metropolis steps to take, zero to choose automatically.
    */
   int B;
+
+  /**
+   * Tolerance on bias when choosing the number of steps automatically.
+   */
+  double bias;
 };
 
 /**
@@ -75,7 +114,7 @@ private:
  */
 template<Location L>
 struct precompute_type<MetropolisResampler,L> {
-  typedef ResamplerPrecompute<L> type;
+  typedef MetropolisResamplerPrecompute type;
 };
 }
 
@@ -84,10 +123,13 @@ struct precompute_type<MetropolisResampler,L> {
 #include "../cuda/resampler/MetropolisResamplerGPU.cuh"
 #endif
 #include "../math/sim_temp_vector.hpp"
+#include "../primitive/vector_primitive.hpp"
 
-inline bi::MetropolisResampler::MetropolisResampler(const int B) :
-    B(B) {
-  //
+inline bi::MetropolisResampler::MetropolisResampler(const int B,
+    const double bias) :
+    B(B), bias(bias) {
+  /* pre-condition */
+  BI_ASSERT(bias > 0.0 && bias < 1.0);
 }
 
 inline int bi::MetropolisResampler::getSteps() const {
@@ -98,21 +140,32 @@ inline void bi::MetropolisResampler::setSteps(const int B) {
   this->B = B;
 }
 
-template<class V1, class V2, bi::Location L>
+inline double bi::MetropolisResampler::getBias() const {
+  return bias;
+}
+
+inline void bi::MetropolisResampler::setBias(const double bias) {
+  /* pre-condition */
+  BI_ASSERT(bias > 0.0 && bias < 1.0);
+
+  this->bias = bias;
+}
+
+template<class V1, class V2>
 void bi::MetropolisResampler::ancestors(Random& rng, const V1 lws, V2 as,
-    ResamplerPrecompute<L>& pre) throw (ParticleFilterDegeneratedException) {
+    MetropolisResamplerPrecompute& pre) throw (ParticleFilterDegeneratedException) {
 #ifdef __CUDACC__
   typedef typename boost::mpl::if_c<V1::on_device,MetropolisResamplerGPU,
   MetropolisResamplerHost>::type impl;
 #else
   typedef MetropolisResamplerHost impl;
 #endif
-  impl::ancestors(rng, lws, as, B);
+  impl::ancestors(rng, lws, as, pre.B);
 }
 
-template<class V1, class V2, bi::Location L>
+template<class V1, class V2>
 void bi::MetropolisResampler::ancestorsPermute(Random& rng, const V1 lws,
-    V2 as, ResamplerPrecompute<L>& pre)
+    V2 as, MetropolisResamplerPrecompute& pre)
         throw (ParticleFilterDegeneratedException) {
 #ifdef __CUDACC__
   typedef typename boost::mpl::if_c<V1::on_device,MetropolisResamplerGPU,
@@ -120,15 +173,37 @@ void bi::MetropolisResampler::ancestorsPermute(Random& rng, const V1 lws,
 #else
   typedef MetropolisResamplerHost impl;
 #endif
-  impl::ancestorsPermute(rng, lws, as, B);
+  impl::ancestorsPermute(rng, lws, as, pre.B);
 }
 
-template<class V1, class V2, bi::Location L>
+template<class V1, class V2>
 void bi::MetropolisResampler::offspring(Random& rng, const V1 lws, const int P, V2 os,
-    ResamplerPrecompute<L>& pre) throw (ParticleFilterDegeneratedException) {
+    MetropolisResamplerPrecompute& pre) throw (ParticleFilterDegeneratedException) {
   typename sim_temp_vector<V1>::type as(P);
-  ancestors(rng, lws, as);
+  ancestors(rng, lws, as, pre);
   ancestorsToOffspring(as, os);
 }
 
+template<class V1>
+void bi::MetropolisResampler::precompute(const V1 lws,
+    MetropolisResamplerPrecompute& pre) {
+  if (B > 0) {
+    pre.B = B;
+  } else {
+    /* ratio of mean to maximum weight */
+    const int P = lws.size();
+    const double beta = bi::exp(logsumexp_reduce(lws) - max_reduce(lws))/P;
+    double B1;
+    if (!(beta > 0.0)) {
+      /* includes NaN */
+      B1 = P;
+    } else if (beta >= 1.0) {
+      B1 = 1.0;
+    } else {
+      B1 = bi::ceil(bi::log(bias)/bi::log(1.0 - beta));
+    }
+    pre.B = static_cast<int>(bi::max(1.0, bi::min(B1, static_cast<double>(P))));
+  }
+}
+
 #endif
@@ -9,6 +9,7 @@
 #define BI_RESAMPLER_RESAMPLER_HPP
 
 #include "misc.hpp"
+#include "hilbert.hpp"
 #include "../state/State.hpp"
 #include "../state/ScheduleElement.hpp"
 #include "../random/Random.hpp"
@@ -16,6 +17,8 @@
 #include "../misc/location.hpp"
 #include "../traits/resampler_traits.hpp"
 
+#include "boost/mpl/bool.hpp"
+
 namespace bi {
 /**
  * Precomputed results for Resampler.
@@ -69,6 +72,27 @@ public:
    */
   void setMaxLogWeight(const double maxLogWeight);
 
+  /**
+   * Get columns of the dynamic state along which particles are sorted
+   * before resampling.
+   */
+  const std::vector<int>& getSortColumns() const;
+
+  /**
+   * Set columns of the dynamic state along which particles are sorted before
+   * resampling.
+   *
+   * @param cols Columns of State::getDyn(). If empty, particles are not
+   * sorted.
+   *
+   * Particles are sorted along a Hilbert curve in the space of the given
+   * columns before ancestors are drawn, so that, after resampling, particles
+   * that are close in that space are close in memory. With the systematic
+   * and stratified resamplers, ancestors are then also close in that space,
+   * which reduces resampling variance.
+   */
+  void setSortColumns(const std::vector<int>& cols);
+
   /**
    * Compute ESS and incremental log-likelihood.
    */
@@ -103,6 +127,31 @@ public:
   //@}
 
 protected:
+  /**
+   * Draw ancestors in the order of particles along a Hilbert curve, for
+   * states that support sorting.
+   *
+   * @tparam S1 State type.
+   * @tparam V1 Integral vector type.
+   * @tparam P1 Precompute type.
+   *
+   * @param[in,out] rng Random number generator.
+   * @param s State.
+   * @param[out] as Ancestors.
+   * @param[out] pre Precomputed results.
+   * @param sortable Tag dispatched on resampler_can_sort.
+   */
+  template<class S1, class V1, class P1>
+  void sortedAncestors(Random& rng, S1& s, V1 as, P1& pre,
+      const boost::mpl::true_ sortable);
+
+  /**
+   * Draw ancestors without sorting, for states that do not support it.
+   */
+  template<class S1, class V1, class P1>
+  void sortedAncestors(Random& rng, S1& s, V1 as, P1& pre,
+      const boost::mpl::false_ sortable);
+
   /**
    * Relative ESS threshold.
    */
@@ -117,6 +166,22 @@ protected:
    * Use anytime mode?
    */
   bool anytime;
+
+  /**
+   * Columns along which to sort particles.
+   */
+  std::vector<int> sortColumns;
+};
+
+/**
+ * Precomputed results of the base resampler, for callers that precompute
+ * through the wrapper.
+ *
+ * @ingroup method_resampler
+ */
+template<class R, Location L>
+struct precompute_type<Resampler<R>,L> {
+  typedef typename precompute_type<R,L>::type type;
 };
 }
 
@@ -154,6 +219,16 @@ void bi::Resampler<R>::setMaxLogWeight(const double maxLogWeight) {
   this->maxLogWeight = maxLogWeight;
 }
 
+template<class R>
+inline const std::vector<int>& bi::Resampler<R>::getSortColumns() const {
+  return sortColumns;
+}
+
+template<class R>
+inline void bi::Resampler<R>::setSortColumns(const std::vector<int>& cols) {
+  this->sortColumns = cols;
+}
+
 template<class R>
 template<class V1>
 double bi::Resampler<R>::reduce(const V1 lws, double* lW) {
@@ -174,8 +249,13 @@ bool bi::Resampler<R>::resample(Random& rng, const ScheduleElement now, S1& s)
     typename precompute_type<R,S1::temp_int_vector_type::location>::type pre;
     typename S1::temp_int_vector_type as1(s.size());
 
-    R::precompute(s.logWeights(), pre);
-    R::ancestorsPermute(rng, s.logWeights(), as1, pre);
+    if (sortColumns.empty()) {
+      R::precompute(s.logWeights(), pre);
+      R::ancestorsPermute(rng, s.logWeights(), as1, pre);
+    } else {
+      sortedAncestors(rng, s, as1, pre,
+          boost::mpl::bool_<resampler_can_sort<S1>::value>());
+    }
 
     s.gather(now, as1);
     set_elements(s.logWeights(), s.logLikelihood);
@@ -185,6 +265,29 @@ bool bi::Resampler<R>::resample(Random& rng, const ScheduleElement now, S1& s)
   return r;
 }
 
+template<class R>
+template<class S1, class V1, class P1>
+void bi::Resampler<R>::sortedAncestors(Random& rng, S1& s, V1 as, P1& pre,
+    const boost::mpl::true_ sortable) {
+  /* draw ancestors in sorted order, then map back */
+  typename S1::temp_int_vector_type ps(s.size()), as1(s.size());
+  typename S1::temp_weight_vector_type lws(s.size());
+
+  hilbertPermute(s.getDyn(), sortColumns, ps);
+  bi::gather(ps, s.logWeights(), lws);
+  R::precompute(lws, pre);
+  R::ancestors(rng, lws, as1, pre);
+  bi::gather(as1, ps, as);
+}
+
+template<class R>
+template<class S1, class V1, class P1>
+void bi::Resampler<R>::sortedAncestors(Random& rng, S1& s, V1 as, P1& pre,
+    const boost::mpl::false_ sortable) {
+  R::precompute(s.logWeights(), pre);
+  R::ancestorsPermute(rng, s.logWeights(), as, pre);
+}
+
 template<class R>
 template<class S1>
 void bi::Resampler<R>::shuffle(Random& rng, S1& s) {
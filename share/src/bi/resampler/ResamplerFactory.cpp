@@ -24,11 +24,12 @@ boost::shared_ptr<bi::Resampler<bi::SystematicResampler> > bi::ResamplerFactory:
 }
 
 boost::shared_ptr<bi::Resampler<bi::MetropolisResampler> > bi::ResamplerFactory::createMetropolisResampler(
-    const int B, const double essRel, const bool anytime) {
+    const int B, const double essRel, const bool anytime, const double bias) {
   BOOST_AUTO(resam,
       boost::make_shared < Resampler<MetropolisResampler>
           > (essRel, anytime));
   resam->setSteps(B);
+  resam->setBias(bias);
   return resam;
 }
 
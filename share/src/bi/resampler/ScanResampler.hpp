@@ -14,8 +14,8 @@ namespace bi {
  */
 template<Location L>
 struct ScanResamplerPrecompute {
-  typename loc_temp_vector<L,real>::type Ws;
-  real W;
+  typename loc_temp_vector<L,wreal>::type Ws;
+  wreal W;
 };
 
 /**
@@ -0,0 +1,168 @@
+/**
+ * @file
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ */
+#ifndef BI_RESAMPLER_HILBERT_HPP
+#define BI_RESAMPLER_HILBERT_HPP
+
+#include <vector>
+
+namespace bi {
+/**
+ * Compute the permutation that sorts particles along a Hilbert curve.
+ *
+ * @ingroup method_resampler
+ *
+ * @tparam M1 Matrix type.
+ * @tparam V1 Integral vector type.
+ *
+ * @param X Particles, one per row.
+ * @param cols Columns of @p X spanning the space of the curve.
+ * @param[out] ps Permutation. Particle <tt>ps(i)</tt> is the @c i th along
+ * the curve.
+ *
+ * Each column is scaled to the range of its values among the particles,
+ * and quantised to a grid fine enough that keys fit in 64 bits. Columns
+ * after the 64th are ignored.
+ */
+template<class M1, class V1>
+void hilbertPermute(const M1 X, const std::vector<int>& cols, V1 ps);
+
+/**
+ * Hilbert key of a point.
+ *
+ * @ingroup method_resampler
+ *
+ * @param[in,out] x Coordinates of the point, quantised to @p bits bits.
+ * Overwritten.
+ * @param D Number of dimensions.
+ * @param bits Number of bits per dimension. <tt>D*bits</tt> must be no more
+ * than 64.
+ *
+ * @return Key, the distance of the point along the curve.
+ *
+ * Uses the transpose algorithm of Skilling (2004), <i>Programming the
+ * Hilbert curve</i>.
+ */
+unsigned long long hilbertKey(unsigned* x, const int D, const int bits);
+}
+
+#include "../math/temp_matrix.hpp"
+#include "../math/temp_vector.hpp"
+#include "../math/view.hpp"
+#include "../cuda/cuda.hpp"
+
+#include <algorithm>
+#include <utility>
+
+template<class M1, class V1>
+void bi::hilbertPermute(const M1 X, const std::vector<int>& cols, V1 ps) {
+  /* pre-condition */
+  BI_ASSERT(ps.size() == X.size1());
+
+  typedef std::pair<unsigned long long,int> key_type;
+
+  const int P = X.size1();
+  const int D = std::min(static_cast<int>(cols.size()), 64);
+  const int bits = std::min(64 / std::max(D, 1), 32);
+  const double scale = static_cast<double>((1ull << bits) - 1ull);
+
+  /* copy columns to host */
+  typename temp_host_matrix<real>::type Z(P, D);
+  for (int j = 0; j < D; ++j) {
+    column(Z, j) = column(X, cols[j]);
+  }
+  synchronize();
+
+  /* bounds */
+  std::vector<real> lo(D), hi(D);
+  for (int j = 0; j < D; ++j) {
+    lo[j] = *std::min_element(column(Z, j).begin(), column(Z, j).end());
+    hi[j] = *std::max_element(column(Z, j).begin(), column(Z, j).end());
+  }
+
+  /* keys */
+  std::vector<key_type> keys(P);
+  #pragma omp parallel
+  {
+    std::vector<unsigned> x(D);
+    int p, j;
+
+    #pragma omp for
+    for (p = 0; p < P; ++p) {
+      for (j = 0; j < D; ++j) {
+        double z = (hi[j] > lo[j]) ? (Z(p, j) - lo[j])/(hi[j] - lo[j]) : 0.0;
+        if (!(z >= 0.0)) {
+          /* includes NaN */
+          z = 0.0;
+        } else if (z > 1.0) {
+          z = 1.0;
+        }
+        x[j] = static_cast<unsigned>(z*scale);
+      }
+      keys[p].first = (D > 0) ? hilbertKey(&x[0], D, bits) : 0ull;
+      keys[p].second = p;
+    }
+  }
+  std::sort(keys.begin(), keys.end());
+
+  /* permutation */
+  typename temp_host_vector<int>::type ps1(P);
+  for (int p = 0; p < P; ++p) {
+    ps1(p) = keys[p].second;
+  }
+  ps = ps1;
+  synchronize();
+}
+
+inline unsigned long long bi::hilbertKey(unsigned* x, const int D,
+    const int bits) {
+  /* pre-condition */
+  BI_ASSERT(D > 0 && bits > 0 && D*bits <= 64);
+
+  const unsigned M = 1u << (bits - 1);
+  unsigned P, Q, t;
+  unsigned long long key = 0ull;
+  int i, b;
+
+  /* inverse undo excess work */
+  for (Q = M; Q > 1u; Q >>= 1) {
+    P = Q - 1u;
+    for (i = 0; i < D; ++i) {
+      if (x[i] & Q) {
+        x[0] ^= P;
+      } else {
+        t = (x[0] ^ x[i]) & P;
+        x[0] ^= t;
+        x[i] ^= t;
+      }
+    }
+  }
+
+  /* Gray encode */
+  for (i = 1; i < D; ++i) {
+    x[i] ^= x[i - 1];
+  }
+  t = 0u;
+  for (Q = M; Q > 1u; Q >>= 1) {
+    if (x[D - 1] & Q) {
+      t ^= Q - 1u;
+    }
+  }
+  for (i = 0; i < D; ++i) {
+    x[i] ^= t;
+  }
+
+  /* interleave bits of transpose, most significant first */
+  for (b = bits - 1; b >= 0; --b) {
+    for (i = 0; i < D; ++i) {
+      key = (key << 1) | ((x[i] >> b) & 1u);
+    }
+  }
+  return key;
+}
+
+#endif
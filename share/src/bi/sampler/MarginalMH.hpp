@@ -24,6 +24,33 @@ namespace bi {
  * with a particle filter, gives the particle marginal Metropolis--Hastings
  * sampler described in @ref Andrieu2010 "Andrieu, Doucet \& Holenstein (2010)".
  *
+ * With a positive correlation, becomes the correlated pseudo-marginal
+ * sampler of @ref Deligiannidis2018 "Deligiannidis, Doucet & Pitt (2018)":
+ * the initial values and all randomness of the filter are replayed from
+ * tapes of auxiliary variables kept with each state (see RandomTape), and
+ * each proposal perturbs those of the current state. The estimates of the
+ * likelihood for the current and proposed states are then strongly
+ * correlated, and far fewer particles are needed for the same acceptance
+ * rate. The parameter proposal and the accept/reject decision do not use
+ * the tapes. Host only.
+ *
+ * With a positive target variance, the number of particles is tuned
+ * before sampling, by pilot runs of the filter at the initial parameters:
+ * as the variance of the log-likelihood estimate is roughly inversely
+ * proportional to the number of particles, the number is scaled by the
+ * ratio of the estimated variance to the target, and the pilot repeated
+ * until the number settles. A variance of about one is usually a good
+ * compromise between the cost of each step and the mixing of the chain
+ * (@ref Doucet2015 "Doucet et al., 2015").
+ *
+ * With a positive diagnostics interval, convergence diagnostics are
+ * computed from the samples output so far at that interval (see
+ * MCMCDiagnostics), reported on stderr, and written to the output buffer.
+ * With a positive target effective sample size (ESS) also, sampling stops
+ * early, once the smallest ESS of any parameter reaches the target. Under
+ * MPI, the process of each chain is an independent chain, and ESS is over
+ * all chains.
+ *
  * @todo Add proposal adaptation using adapter classes.
  */
 template<class B, class F>
@@ -34,8 +61,19 @@ public:
    *
    * @param m Model.
    * @param filter Filter.
+   * @param rho Correlation of auxiliary variables between the current and
+   * proposed states, zero for independent auxiliary variables.
+   * @param targetVariance Target variance of the log-likelihood estimate
+   * when tuning the number of particles, zero to not tune.
+   * @param npilots Number of pilot runs for each estimate of the variance.
+   * @param stopESS Target effective sample size, zero to always draw the
+   * given number of samples.
+   * @param diagnosticsInterval Number of samples between diagnostics, zero
+   * for none.
    */
-  MarginalMH(B& m, F& filter);
+  MarginalMH(B& m, F& filter, const double rho = 0.0,
+      const double targetVariance = 0.0, const int npilots = 20,
+      const double stopESS = 0.0, const int diagnosticsInterval = 0);
 
   /**
    * @name High-level interface
@@ -54,7 +92,7 @@ public:
    * @param first Start of time schedule.
    * @param last End of time schedule.
    * @param s State.
-   * @param C Number of samples to draw.
+   * @param C Maximum number of samples to draw.
    * @param out Output buffer.
    * @param inInit Initialisation file.
    */
@@ -88,6 +126,25 @@ public:
   void init(Random& rng, const ScheduleIterator first,
       const ScheduleIterator last, S1& s1, IO1& out, IO2& inInit);
 
+  /**
+   * Tune number of particles.
+   *
+   * @tparam S1 State type.
+   * @tparam S2 State type.
+   * @tparam IO1 Output type.
+   *
+   * @param[in,out] rng Random number generator.
+   * @param first Start of time schedule.
+   * @param last End of time schedule.
+   * @param[in,out] s1 Current state, as from init(). Resized to the tuned
+   * number of particles, and filtered again at the same parameters.
+   * @param[out] s2 Scratch state, resized likewise.
+   * @param[in,out] out Output buffer.
+   */
+  template<class S1, class S2, class IO1>
+  void tune(Random& rng, const ScheduleIterator first,
+      const ScheduleIterator last, S1& s1, S2& s2, IO1& out);
+
   /**
    * Propose new state.
    *
@@ -115,11 +172,13 @@ public:
    * @param[in,out] rng Random number generator.
    * @param s1 Current state.
    * @param s2 Proposed state.
+   * @param beta Inverse temperature of the target, 1 for the posterior.
    *
    * @return Was proposal accepted?
    */
   template<class S1, class S2, class IO1>
-  bool acceptReject(Random& rng, S1& s1, S2& s2, IO1& out);
+  bool acceptReject(Random& rng, S1& s1, S2& s2, IO1& out,
+      const double beta = 1.0);
 
   /**
    * Output.
@@ -153,6 +212,18 @@ public:
   template<class S1, class S2>
   void report(const int c, const S1& s1, const S2& s2);
 
+  /**
+   * Compute, report and output convergence diagnostics.
+   *
+   * @tparam IO1 Output type.
+   *
+   * @param[in,out] out Output buffer.
+   *
+   * @return Has the target effective sample size been reached?
+   */
+  template<class IO1>
+  bool diagnose(IO1& out);
+
   /**
    * Terminate.
    */
@@ -160,6 +231,23 @@ public:
   //@}
 
 private:
+  /**
+   * Filter, replaying variates from the auxiliary variables of the state
+   * if correlated.
+   *
+   * @tparam S1 State type.
+   * @tparam IO1 Output type.
+   *
+   * @param[in,out] rng Random number generator.
+   * @param first Start of time schedule.
+   * @param last End of time schedule.
+   * @param[in,out] s State.
+   * @param[in,out] out Output buffer.
+   */
+  template<class S1, class IO1>
+  void run(Random& rng, const ScheduleIterator first,
+      const ScheduleIterator last, S1& s, IO1& out);
+
   /**
    * Model.
    */
@@ -170,6 +258,31 @@ private:
    */
   F& filter;
 
+  /**
+   * Correlation of auxiliary variables.
+   */
+  double rho;
+
+  /**
+   * Target variance of log-likelihood estimate.
+   */
+  double targetVariance;
+
+  /**
+   * Number of pilot runs.
+   */
+  int npilots;
+
+  /**
+   * Target effective sample size.
+   */
+  double stopESS;
+
+  /**
+   * Number of samples between diagnostics.
+   */
+  int diagnosticsInterval;
+
   /**
    * Was the last proposal accepted?
    */
@@ -188,11 +301,30 @@ private:
 }
 
 #include "../misc/TicToc.hpp"
+#include "../pdf/MCMCDiagnostics.hpp"
+
+#include <vector>
 
 template<class B, class F>
-bi::MarginalMH<B,F>::MarginalMH(B& m, F& filter) :
-    m(m), filter(filter), lastAccepted(false), accepted(0), total(0) {
-  //
+bi::MarginalMH<B,F>::MarginalMH(B& m, F& filter, const double rho,
+    const double targetVariance, const int npilots, const double stopESS,
+    const int diagnosticsInterval) :
+    m(m), filter(filter), rho(rho), targetVariance(targetVariance), npilots(
+        npilots), stopESS(stopESS), diagnosticsInterval(diagnosticsInterval), lastAccepted(
+        false), accepted(0), total(0) {
+  /* pre-condition */
+  BI_ERROR_MSG(rho >= 0.0 && rho < 1.0, "--correlation must be in [0,1)");
+  BI_ERROR_MSG(targetVariance >= 0.0, "--tune-variance must be positive");
+  BI_ERROR_MSG(targetVariance == 0.0 || npilots > 1,
+      "--tune-npilots must be greater than one");
+  BI_ERROR_MSG(stopESS >= 0.0, "--stop-ess must be positive");
+  BI_ERROR_MSG(diagnosticsInterval >= 0,
+      "--diagnostics-interval must be positive");
+  BI_ERROR_MSG(stopESS == 0.0 || diagnosticsInterval > 0,
+      "--stop-ess requires a positive --diagnostics-interval");
+#ifdef ENABLE_CUDA
+  BI_ERROR_MSG(rho == 0.0, "--correlation is not supported on device");
+#endif
 }
 
 template<class B, class F>
@@ -204,12 +336,19 @@ void bi::MarginalMH<B,F>::sample(Random& rng, const ScheduleIterator first,
 
   TicToc clock;
   init(rng, first, last, s.s1, s.out, inInit);
+  if (targetVariance > 0.0) {
+    tune(rng, first, last, s.s1, s.s2, s.out);
+  }
   output(0, s.s1, out);
   for (int c = 1; c < C; ++c) {
     propose(rng, first, last, s.s1, s.s2, s.out);
     acceptReject(rng, s.s1, s.s2, s.out);
     report(c, s.s1, s.s2);
     output(c, s.s1, out);
+    if (diagnosticsInterval > 0 && (c + 1) % diagnosticsInterval == 0
+        && diagnose(out)) {
+      break;
+    }
   }
   s.clock = clock.toc();
   outputT(s, out);
@@ -221,13 +360,83 @@ template<class S1, class IO1, class IO2>
 void bi::MarginalMH<B,F>::init(Random& rng, const ScheduleIterator first,
     const ScheduleIterator last, S1& s1, IO1& out, IO2& inInit) {
   filter.init(rng, *first, s1, out, inInit);
-  filter.filter(rng, first, last, s1, out);
+  s1.aux.clear();
+  run(rng, first, last, s1, out);
   filter.samplePath(rng, s1, out);
   lastAccepted = true;
   accepted = 1;
   total = 1;
 }
 
+template<class B, class F>
+template<class S1, class S2, class IO1>
+void bi::MarginalMH<B,F>::tune(Random& rng, const ScheduleIterator first,
+    const ScheduleIterator last, S1& s1, S2& s2, IO1& out) {
+  /* pre-condition */
+  BI_ASSERT(targetVariance > 0.0 && npilots > 1);
+
+  /* limits on the number of rounds and the change in each */
+  const int maxRounds = 8;
+  const double maxFactor = 16.0;
+
+  std::vector<double> lls(npilots);
+  double mu, var, factor;
+  int P = s1.size(), P1, round, i;
+  bool converged;
+
+  for (round = 0; round < maxRounds; ++round) {
+    s2.resizeMax(P, false);
+    s2.setRange(0, P);
+    for (i = 0; i < npilots; ++i) {
+      try {
+        filter.restart(rng, *first, s1, s2, out);
+        filter.filter(rng, first, last, s2, out);
+        lls[i] = s2.logLikelihood;
+      } catch (ParticleFilterDegeneratedException e) {
+        lls[i] = -BI_INF;
+      }
+    }
+    mu = 0.0;
+    for (i = 0; i < npilots; ++i) {
+      mu += lls[i];
+    }
+    mu /= npilots;
+    var = 0.0;
+    for (i = 0; i < npilots; ++i) {
+      var += (lls[i] - mu)*(lls[i] - mu);
+    }
+    var /= npilots - 1;
+
+    /* variance is roughly inversely proportional to number of particles */
+    if (bi::is_finite(var)) {
+      factor = bi::max(1.0/maxFactor, bi::min(maxFactor, var/targetVariance));
+    } else {
+      factor = maxFactor;
+    }
+    P1 = bi::roundup(bi::max(1, static_cast<int>(bi::ceil(factor*P))));
+    std::cerr << "tune:\tparticles " << P << "\tvariance " << var
+        << "\tnext " << P1 << std::endl;
+
+    converged = bi::abs(P1 - P) <= P/10;
+    P = P1;
+    if (converged) {
+      break;
+    }
+  }
+
+  /* filter current state again with the tuned number of particles; the
+   * swap exchanges storage but not active ranges, so set both first */
+  s2.resizeMax(P, false);
+  s2.setRange(0, P);
+  filter.restart(rng, *first, s1, s2, out);
+  s2.aux.clear();
+  run(rng, first, last, s2, out);
+  s1.resizeMax(P, false);
+  s1.setRange(0, P);
+  s1.swap(s2);
+  filter.samplePath(rng, s1, out);
+}
+
 template<class B, class F>
 template<class S1, class S2, class IO1>
 void bi::MarginalMH<B,F>::propose(Random& rng, const ScheduleIterator first,
@@ -235,7 +444,10 @@ void bi::MarginalMH<B,F>::propose(Random& rng, const ScheduleIterator first,
   try {
     filter.propose(rng, *first, s1, s2, out);
     if (bi::is_finite(s2.logPrior)) {
-      filter.filter(rng, first, last, s2, out);
+      if (rho > 0.0) {
+        s2.aux.perturb(rng, s1.aux, rho);
+      }
+      run(rng, first, last, s2, out);
     } else {
       s2.logLikelihood = -BI_INF;
     }
@@ -248,13 +460,14 @@ void bi::MarginalMH<B,F>::propose(Random& rng, const ScheduleIterator first,
 
 template<class B, class F>
 template<class S1, class S2, class IO1>
-bool bi::MarginalMH<B,F>::acceptReject(Random& rng, S1& s1, S2& s2, IO1& out) {
+bool bi::MarginalMH<B,F>::acceptReject(Random& rng, S1& s1, S2& s2, IO1& out,
+    const double beta) {
   if (!bi::is_finite(s2.logLikelihood)) {
     lastAccepted = false;
   } else if (!bi::is_finite(s1.logLikelihood)) {
     lastAccepted = true;
   } else {
-    double loglr = s2.logLikelihood - s1.logLikelihood;
+    double loglr = beta*(s2.logLikelihood - s1.logLikelihood);
     double logpr = s2.logPrior - s1.logPrior;
     double logqr = s1.logProposal - s2.logProposal;
     double logratio = loglr + logpr + logqr;
@@ -318,9 +531,41 @@ void bi::MarginalMH<B,F>::report(const int c, const S1& s1, const S2& s2) {
   std::cerr << std::endl;
 }
 
+template<class B, class F>
+template<class IO1>
+bool bi::MarginalMH<B,F>::diagnose(IO1& out) {
+  const MCMCDiagnostics& diag = out.diagnose();
+
+  std::cerr << "diagnose:\tsamples " << diag.size() << "\tess "
+      << diag.getMinESS() << "\trhat " << diag.getMaxRHat() << "\taccept "
+      << diag.getAcceptanceRate() << std::endl;
+
+  return stopESS > 0.0 && diag.getMinESS() >= stopESS;
+}
+
 template<class B, class F>
 void bi::MarginalMH<B,F>::term() {
   //
 }
 
+template<class B, class F>
+template<class S1, class IO1>
+void bi::MarginalMH<B,F>::run(Random& rng, const ScheduleIterator first,
+    const ScheduleIterator last, S1& s, IO1& out) {
+  if (rho > 0.0) {
+    /* redraw initial values from the auxiliary variables, with the rest */
+    rng.startReplay(s.aux);
+    try {
+      m.initialSamples(rng, s);
+      filter.filter(rng, first, last, s, out);
+    } catch (...) {
+      rng.stopReplay();
+      throw;
+    }
+    rng.stopReplay();
+  } else {
+    filter.filter(rng, first, last, s, out);
+  }
+}
+
 #endif
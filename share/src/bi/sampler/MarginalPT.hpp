@@ -0,0 +1,412 @@
+/**
+ * @file
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ */
+#ifndef BI_SAMPLER_MARGINALPT_HPP
+#define BI_SAMPLER_MARGINALPT_HPP
+
+#include "MarginalMH.hpp"
+#include "../state/Schedule.hpp"
+
+#include <vector>
+
+namespace bi {
+/**
+ * Marginal parallel tempering.
+ *
+ * @ingroup method_sampler
+ *
+ * @tparam B Model type
+ * @tparam F Filter type.
+ *
+ * Runs a population of marginal Metropolis--Hastings chains, each targeting
+ * the posterior with the likelihood raised to an inverse temperature
+ * \f$\beta_i\f$, and periodically proposes to swap the states of chains
+ * adjacent in temperature. The ladder is geometric, with \f$\beta_0 = 1\f$
+ * for the first chain, which targets the posterior, and \f$\beta_{N-1} =
+ * 1/T_{\max}\f$ for the last.
+ *
+ * With MPI, chains are distributed across processes, each process holding
+ * a contiguous block of the ladder, and states are exchanged between
+ * processes where a swap crosses their boundary. The first chain of each
+ * process is output, so that the first process outputs the posterior
+ * samples. Within a process, chains are advanced in turn, each making full
+ * use of the available threads for its particle filter.
+ */
+template<class B, class F>
+class MarginalPT {
+public:
+  /**
+   * Constructor.
+   *
+   * @param m Model.
+   * @param filter Filter.
+   * @param maxTemp Temperature of the hottest chain.
+   * @param swapInterval Number of steps between swap moves.
+   */
+  MarginalPT(B& m, F& filter, const double maxTemp = 10.0,
+      const int swapInterval = 1);
+
+  /**
+   * @name High-level interface
+   *
+   * An easier interface for common usage.
+   */
+  //@{
+  /**
+   * @copydoc MarginalMH::sample()
+   */
+  template<class S1, class IO1, class IO2>
+  void sample(Random& rng, const ScheduleIterator first,
+      const ScheduleIterator last, S1& s, const int C, IO1& out, IO2& inInit);
+  //@}
+
+  /**
+   * @name Low-level interface
+   *
+   * Largely used by other features of the library or for finer control over
+   * performance and behaviour.
+   */
+  //@{
+  /**
+   * Initialise all chains.
+   *
+   * @tparam S1 State type.
+   * @tparam IO2 Input type.
+   *
+   * @param[in,out] rng Random number generator.
+   * @param first Start of time schedule.
+   * @param last End of time schedule.
+   * @param[out] s State.
+   * @param inInit Initialisation file.
+   */
+  template<class S1, class IO2>
+  void init(Random& rng, const ScheduleIterator first,
+      const ScheduleIterator last, S1& s, IO2& inInit);
+
+  /**
+   * Take a Metropolis--Hastings step in all chains.
+   *
+   * @tparam S1 State type.
+   *
+   * @param[in,out] rng Random number generator.
+   * @param first Start of time schedule.
+   * @param last End of time schedule.
+   * @param[in,out] s State.
+   */
+  template<class S1>
+  void step(Random& rng, const ScheduleIterator first,
+      const ScheduleIterator last, S1& s);
+
+  /**
+   * Propose and accept or reject swaps between chains adjacent in
+   * temperature.
+   *
+   * @tparam S1 State type.
+   *
+   * @param[in,out] rng Random number generator.
+   * @param n Swap round. Even rounds consider pairs starting at chains of
+   * even index, odd rounds those starting at odd index.
+   * @param[in,out] s State.
+   */
+  template<class S1>
+  void exchange(Random& rng, const int n, S1& s);
+
+  /**
+   * Inverse temperature of chain.
+   *
+   * @param i Global index of chain.
+   */
+  double getBeta(const int i) const;
+
+  /**
+   * Output.
+   *
+   * @tparam S1 State type.
+   * @tparam IO1 Output type.
+   *
+   * @param c Index in output file.
+   * @param s State.
+   * @param[in,out] out Output buffer.
+   */
+  template<class S1, class IO1>
+  void output(const int c, const S1& s, IO1& out);
+
+  /**
+   * @copydoc Simulator::outputT()
+   */
+  template<class S1, class IO1>
+  void outputT(const S1& s, IO1& out);
+
+  /**
+   * Report progress on stderr.
+   *
+   * @tparam S1 State type.
+   *
+   * @param c Number of steps taken.
+   * @param s State.
+   */
+  template<class S1>
+  void report(const int c, const S1& s);
+
+  /**
+   * Terminate.
+   */
+  void term();
+  //@}
+
+private:
+  /**
+   * Model.
+   */
+  B& m;
+
+  /**
+   * Sampler for individual chains.
+   */
+  MarginalMH<B,F> mh;
+
+  /**
+   * Temperature of the hottest chain.
+   */
+  double maxTemp;
+
+  /**
+   * Number of steps between swap moves.
+   */
+  int swapInterval;
+
+  /**
+   * Total number of chains across all processes.
+   */
+  int N;
+
+  /**
+   * Global index of the first chain of this process.
+   */
+  int offset;
+
+  /**
+   * Number of accepted moves, per chain of this process.
+   */
+  std::vector<int> accepted;
+
+  /**
+   * Number of accepted swaps, for the whole population.
+   */
+  int swapsAccepted;
+
+  /**
+   * Total number of swaps proposed, for the whole population.
+   */
+  int swapsTotal;
+
+  /**
+   * Total number of moves proposed, per chain.
+   */
+  int total;
+};
+}
+
+#include "../mpi/mpi.hpp"
+#include "../misc/TicToc.hpp"
+
+template<class B, class F>
+bi::MarginalPT<B,F>::MarginalPT(B& m, F& filter, const double maxTemp,
+    const int swapInterval) :
+    m(m), mh(m, filter), maxTemp(maxTemp), swapInterval(swapInterval), N(
+        1), offset(0), swapsAccepted(0), swapsTotal(0), total(0) {
+  /* pre-condition */
+  BI_ERROR_MSG(maxTemp >= 1.0, "--max-temperature must be at least 1");
+  BI_ERROR_MSG(swapInterval > 0, "--swap-interval must be positive");
+}
+
+template<class B, class F>
+template<class S1, class IO1, class IO2>
+void bi::MarginalPT<B,F>::sample(Random& rng, const ScheduleIterator first,
+    const ScheduleIterator last, S1& s, const int C, IO1& out, IO2& inInit) {
+  /* pre-condition */
+  BI_ERROR(C > 0);
+
+  TicToc clock;
+  init(rng, first, last, s, inInit);
+  output(0, s, out);
+  for (int c = 1; c < C; ++c) {
+    step(rng, first, last, s);
+    if (c % swapInterval == 0) {
+      exchange(rng, c/swapInterval, s);
+    }
+    report(c, s);
+    output(c, s, out);
+  }
+  s.clock = clock.toc();
+  outputT(s, out);
+  term();
+}
+
+template<class B, class F>
+template<class S1, class IO2>
+void bi::MarginalPT<B,F>::init(Random& rng, const ScheduleIterator first,
+    const ScheduleIterator last, S1& s, IO2& inInit) {
+  const int K = s.size();
+
+  /* pre-condition */
+  BI_ERROR_MSG(K > 0, "--nchains must be positive");
+
+  #ifdef ENABLE_MPI
+  boost::mpi::communicator world;
+  N = world.size()*K;
+  offset = world.rank()*K;
+  #else
+  N = K;
+  offset = 0;
+  #endif
+
+  for (int k = 0; k < K; ++k) {
+    mh.init(rng, first, last, s.chain(k).s1, s.chain(k).out, inInit);
+  }
+  accepted.assign(K, 1);
+  total = 1;
+  swapsAccepted = 0;
+  swapsTotal = 0;
+}
+
+template<class B, class F>
+template<class S1>
+void bi::MarginalPT<B,F>::step(Random& rng, const ScheduleIterator first,
+    const ScheduleIterator last, S1& s) {
+  for (int k = 0; k < s.size(); ++k) {
+    mh.propose(rng, first, last, s.chain(k).s1, s.chain(k).s2,
+        s.chain(k).out);
+    if (mh.acceptReject(rng, s.chain(k).s1, s.chain(k).s2, s.chain(k).out,
+        getBeta(offset + k))) {
+      ++accepted[k];
+    }
+  }
+  ++total;
+}
+
+template<class B, class F>
+template<class S1>
+void bi::MarginalPT<B,F>::exchange(Random& rng, const int n, S1& s) {
+  const int K = s.size();
+  std::vector<double> lls(K), allLls(N);
+  std::vector<int> swaps(N, 0);
+  double logratio;
+  int i, j, k;
+
+  for (k = 0; k < K; ++k) {
+    lls[k] = s.chain(k).s1.logLikelihood;
+  }
+  #ifdef ENABLE_MPI
+  boost::mpi::communicator world;
+  const int rank = world.rank();
+  std::vector<std::vector<double> > lls1;
+  boost::mpi::all_gather(world, lls, lls1);
+  for (j = 0; j < (int)lls1.size(); ++j) {
+    std::copy(lls1[j].begin(), lls1[j].end(), allLls.begin() + j*K);
+  }
+  #else
+  const int rank = 0;
+  allLls = lls;
+  #endif
+
+  /* decide swaps on the first process, so that all agree */
+  if (rank == 0) {
+    for (i = n % 2; i + 1 < N; i += 2) {
+      logratio = (getBeta(i) - getBeta(i + 1))*(allLls[i + 1] - allLls[i]);
+      if (bi::is_finite(logratio)) {
+        swaps[i] = bi::log(rng.uniform<double>()) < logratio;
+      } else {
+        swaps[i] = logratio > 0.0;
+      }
+      swapsAccepted += swaps[i];
+      ++swapsTotal;
+    }
+  }
+  #ifdef ENABLE_MPI
+  boost::mpi::broadcast(world, swaps, 0);
+  #endif
+
+  /* swaps within this process */
+  for (i = offset; i + 1 < offset + K; ++i) {
+    if (swaps[i]) {
+      s.chain(i - offset).s1.swap(s.chain(i + 1 - offset).s1);
+    }
+  }
+
+  /* swaps across processes, for the chains at the ends of this block; the
+   * state is serialized when the send is posted, so may be overwritten by
+   * the receive before the send completes */
+  #ifdef ENABLE_MPI
+  std::vector<boost::mpi::request> reqs;
+  std::vector<int> ks, peers;
+  if (offset > 0 && swaps[offset - 1]) {
+    ks.push_back(0);
+    peers.push_back(rank - 1);
+  }
+  if (offset + K < N && swaps[offset + K - 1]) {
+    ks.push_back(K - 1);
+    peers.push_back(rank + 1);
+  }
+  for (j = 0; j < (int)ks.size(); ++j) {
+    reqs.push_back(world.isend(peers[j], MPI_TAG_SAMPLER_SWAP,
+        s.chain(ks[j]).s1));
+  }
+  for (j = 0; j < (int)ks.size(); ++j) {
+    world.recv(peers[j], MPI_TAG_SAMPLER_SWAP, s.chain(ks[j]).s1);
+  }
+  boost::mpi::wait_all(reqs.begin(), reqs.end());
+
+  boost::mpi::broadcast(world, swapsAccepted, 0);
+  boost::mpi::broadcast(world, swapsTotal, 0);
+  #endif
+}
+
+template<class B, class F>
+inline double bi::MarginalPT<B,F>::getBeta(const int i) const {
+  /* pre-condition */
+  BI_ASSERT(i >= 0 && i < N);
+
+  return (N > 1) ? bi::pow(maxTemp, -static_cast<double>(i)/(N - 1)) : 1.0;
+}
+
+template<class B, class F>
+template<class S1, class IO1>
+void bi::MarginalPT<B,F>::output(const int c, const S1& s, IO1& out) {
+  if (s.size() > 0) {
+    mh.output(c, s.chain(0).s1, out);
+  }
+}
+
+template<class B, class F>
+template<class S1, class IO1>
+void bi::MarginalPT<B,F>::outputT(const S1& s, IO1& out) {
+  out.writeClock(s.clock);
+}
+
+template<class B, class F>
+template<class S1>
+void bi::MarginalPT<B,F>::report(const int c, const S1& s) {
+  std::cerr << c << ":\t";
+  for (int k = 0; k < s.size(); ++k) {
+    std::cerr.width(10);
+    std::cerr << s.chain(k).s1.logLikelihood;
+    std::cerr << '\t';
+  }
+  std::cerr << "accept=" << (double)accepted[0] / total;
+  if (swapsTotal > 0) {
+    std::cerr << "\tswap=" << (double)swapsAccepted / swapsTotal;
+  }
+  std::cerr << std::endl;
+}
+
+template<class B, class F>
+void bi::MarginalPT<B,F>::term() {
+  mh.term();
+}
+
+#endif
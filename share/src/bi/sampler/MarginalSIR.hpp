@@ -10,6 +10,7 @@
 #define BI_SAMPLER_MARGINALSIR_HPP
 
 #include "../state/Schedule.hpp"
+#include "../filter/Filter.hpp"
 #include "../misc/exception.hpp"
 #include "../misc/TicToc.hpp"
 #include "../primitive/vector_primitive.hpp"
@@ -31,6 +32,12 @@ namespace bi {
  * Implements sequential importance resampling over parameters, which, when
  * combined with a particle filter, gives the SMC^2 method described in
  * @ref Chopin2013 "Chopin, Jacob \& Papaspiliopoulos (2013)".
+ *
+ * If the acceptance rate of move steps falls below a given threshold, the
+ * number of \f$x\f$-particles is doubled with the exchange step of the same
+ * paper: the filter of each \f$\theta\f$-particle is run again from the
+ * start with the new number, and its weight multiplied by the ratio of the
+ * new to the old estimate of the likelihood.
  */
 template<class B, class F, class A, class R>
 class MarginalSIR {
@@ -45,9 +52,11 @@ public:
    * @param nmoves Number of move steps per \f$\theta\f$-particle after each
    * resample.
    * @param tmoves Total real time allocated to move steps, in seconds.
+   * @param minRate Acceptance rate of move steps below which the number of
+   * \f$x\f$-particles is doubled, zero to never double.
    */
   MarginalSIR(B& m, F& filter, A& adapter, R& resam, const int nmoves = 1,
-      const long tmoves = 0.0);
+      const long tmoves = 0.0, const double minRate = 0.0);
 
   /**
    * @name High-level interface
@@ -125,6 +134,21 @@ public:
   void move(Random& rng, const ScheduleIterator first,
       const ScheduleIterator iter, const ScheduleIterator last, S1& s);
 
+  /**
+   * Exchange step, doubling the number of \f$x\f$-particles if the
+   * acceptance rate of the last move step was too low.
+   *
+   * @tparam S1 State type.
+   *
+   * @param[in,out] rng Random number generator.
+   * @param first Start of time schedule.
+   * @param iter Current position in time schedule.
+   * @param[in,out] s State.
+   */
+  template<class S1>
+  void exchange(Random& rng, const ScheduleIterator first,
+      const ScheduleIterator iter, S1& s);
+
   /**
    * @copydoc Simulator::outputT()
    */
@@ -220,6 +244,11 @@ private:
    */
   long tmoves;
 
+  /**
+   * Acceptance rate below which to double the number of x-particles.
+   */
+  double minRate;
+
   /**
    * Start time for current step.
    */
@@ -249,15 +278,21 @@ private:
    * Last total number of moves.
    */
   int lastTotal;
+
+  /**
+   * Was an exchange performed on the last step?
+   */
+  bool lastExchange;
 };
 }
 
 template<class B, class F, class A, class R>
 bi::MarginalSIR<B,F,A,R>::MarginalSIR(B& m, F& filter, A& adapter, R& resam,
-    const int nmoves, const long tmoves) :
+    const int nmoves, const long tmoves, const double minRate) :
     m(m), filter(filter), adapter(adapter), resam(resam), nmoves(nmoves), tmoves(
-        1e6 * tmoves), tstart(0), tmilestone(0), lastResample(false), adapterReady(
-        false), lastAccept(0), lastTotal(0) {
+        1e6 * tmoves), minRate(minRate), tstart(0), tmilestone(0), lastResample(
+        false), adapterReady(false), lastAccept(0), lastTotal(0), lastExchange(
+        false) {
 #if ENABLE_DIAGNOSTICS == 4
 #ifdef ENABLE_MPI
   boost::mpi::communicator world;
@@ -295,6 +330,7 @@ void bi::MarginalSIR<B,F,A,R>::sample(Random& rng,
   while (iter + 1 != last) {
     profile(MOVE);
     move(rng, first, iter, last, s);
+    exchange(rng, first, iter, s);
     profile(STEP);
     step(rng, first, iter, last, s);
     profile(READY);
@@ -343,6 +379,7 @@ void bi::MarginalSIR<B,F,A,R>::init(Random& rng, const ScheduleIterator first,
   adapterReady = false;
   lastAccept = 0;
   lastTotal = 0;
+  lastExchange = false;
 }
 
 template<class B, class F, class A, class R>
@@ -352,17 +389,11 @@ void bi::MarginalSIR<B,F,A,R>::step(Random& rng, const ScheduleIterator first,
   /* pre-condition */
   BI_ASSERT(s.size() > 0);
 
-  ScheduleIterator iter1;
   do {
+    step_batch(filter, rng, iter, last, s.s1s, s.out1s);
     for (int p = 0; p < s.size(); ++p) {
-      BOOST_AUTO(&s1, *s.s1s[p]);
-      BOOST_AUTO(&out1, *s.out1s[p]);
-
-      iter1 = iter;
-      filter.step(rng, iter1, last, s1, out1);
-      s.logWeights()(p) += s1.logIncrements(iter1->indexObs());
+      s.logWeights()(p) += s.s1s[p]->logIncrements(iter->indexObs());
     }
-    iter = iter1;
   } while (iter + 1 != last && !iter->isObserved());
 #if ENABLE_DIAGNOSTICS == 3
   filter.samplePath(rng, s1, out1);
@@ -489,6 +520,53 @@ void bi::MarginalSIR<B,F,A,R>::move(Random& rng, const ScheduleIterator first,
   }
 }
 
+template<class B, class F, class A, class R>
+template<class S1>
+void bi::MarginalSIR<B,F,A,R>::exchange(Random& rng,
+    const ScheduleIterator first, const ScheduleIterator iter, S1& s) {
+  /* all processes must agree, so decide on the rate over all */
+  int naccept = lastAccept, ntotal = lastTotal;
+#ifdef ENABLE_MPI
+  boost::mpi::communicator world;
+  naccept = boost::mpi::all_reduce(world, lastAccept, std::plus<int>());
+  ntotal = boost::mpi::all_reduce(world, lastTotal, std::plus<int>());
+#endif
+
+  lastExchange = minRate > 0.0 && ntotal > 0 && naccept < minRate*ntotal;
+  if (lastExchange) {
+    BOOST_AUTO(&s2, s.s2);
+    BOOST_AUTO(&out2, s.out2);
+    const int P = 2*s2.size();
+
+    for (int p = 0; p < s.size(); ++p) {
+      BOOST_AUTO(&s1, *s.s1s[p]);
+      BOOST_AUTO(&out1, *s.out1s[p]);
+
+      /* run filter again from the start, with the new number of
+       * x-particles, at the same parameters */
+      s2.resizeMax(P, false);
+      s2.setRange(0, P);
+      try {
+        filter.restart(rng, *first, s1, s2, out2);
+        filter.filter(rng, first, iter + 1, s2, out2);
+      } catch (ParticleFilterDegeneratedException e) {
+        s2.logLikelihood = -BI_INF;
+      }
+
+      /* replace old likelihood estimate with new in weight */
+      if (bi::is_finite(s.logWeights()(p))) {
+        s.logWeights()(p) += s2.logLikelihood - s1.logLikelihood;
+      }
+
+      /* the swap exchanges storage but not active ranges, so set first */
+      s1.resizeMax(P, false);
+      s1.setRange(0, P);
+      s1.swap(s2);
+      out1.swap(out2);
+    }
+  }
+}
+
 template<class B, class F, class A, class R>
 template<class S1, class IO1>
 void bi::MarginalSIR<B,F,A,R>::outputT(const S1& s, IO1& out) {
@@ -526,6 +604,9 @@ void bi::MarginalSIR<B,F,A,R>::reportT(const ScheduleElement now, S1& s) {
       std::cerr << "\taccepts " << lastAccept;
       std::cerr << "\trate " << (double(lastAccept) / lastTotal);
     }
+    if (lastExchange) {
+      std::cerr << "\tparticles " << s.s2.size();
+    }
     std::cerr << std::endl;
   }
 }
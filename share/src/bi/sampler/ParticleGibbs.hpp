@@ -0,0 +1,432 @@
+/**
+ * @file
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ */
+#ifndef BI_SAMPLER_PARTICLEGIBBS_HPP
+#define BI_SAMPLER_PARTICLEGIBBS_HPP
+
+#include "../state/Schedule.hpp"
+#include "../misc/exception.hpp"
+
+namespace bi {
+/**
+ * Particle Gibbs.
+ *
+ * @ingroup method_sampler
+ *
+ * @tparam B Model type
+ * @tparam F Filter type, a ConditionalPF.
+ *
+ * Implements the particle Gibbs sampler of
+ * @ref Andrieu2010 "Andrieu, Doucet \& Holenstein (2010)", with ancestor
+ * sampling (@ref Lindsten2014 "Lindsten, Jordan \& Schön, 2014") where the
+ * filter uses it. Each step alternates two updates:
+ *
+ * @li a Metropolis--Hastings update of the parameters given the current
+ * path, proposing from the @c proposal_parameter block of the model, and
+ * accepting with the joint density of the path and observations in place
+ * of the likelihood, then
+ * @li a sweep of the conditional particle filter, with the current path as
+ * reference, from which a new path is sampled.
+ *
+ * The chain is over both parameters and paths, and the number of particles
+ * needed for good mixing is small, and does not grow with the length of the
+ * data as it does for MarginalMH. The likelihood estimate of each sweep is
+ * output, but not used.
+ *
+ * Every time in the schedule must be an output time, so that the path is
+ * known at each, and the joint density of the path can be computed. The
+ * caveats of ConditionalPF as to variables updated with <tt><-</tt> apply
+ * equally to the parameter update: the joint density omits them, so that
+ * models should update state variables with <tt>~</tt> where possible.
+ *
+ * Convergence diagnostics and the target effective sample size (ESS) are as
+ * for MarginalMH, so that the two may be compared by the time taken to
+ * reach the same ESS.
+ */
+template<class B, class F>
+class ParticleGibbs {
+public:
+  /**
+   * Constructor.
+   *
+   * @param m Model.
+   * @param filter Filter.
+   * @param stopESS Target effective sample size, zero to always draw the
+   * given number of samples.
+   * @param diagnosticsInterval Number of samples between diagnostics, zero
+   * for none.
+   */
+  ParticleGibbs(B& m, F& filter, const double stopESS = 0.0,
+      const int diagnosticsInterval = 0);
+
+  /**
+   * @name High-level interface
+   *
+   * An easier interface for common usage.
+   */
+  //@{
+  /**
+   * Sample.
+   *
+   * @tparam S1 State type.
+   * @tparam IO1 Output type.
+   * @tparam IO2 Input type.
+   *
+   * @param[in,out] rng Random number generator.
+   * @param first Start of time schedule.
+   * @param last End of time schedule.
+   * @param s State.
+   * @param C Maximum number of samples to draw.
+   * @param out Output buffer.
+   * @param inInit Initialisation file.
+   */
+  template<class S1, class IO1, class IO2>
+  void sample(Random& rng, const ScheduleIterator first,
+      const ScheduleIterator last, S1& s, const int C, IO1& out, IO2& inInit);
+  //@}
+
+  /**
+   * @name Low-level interface
+   *
+   * Largely used by other features of the library or for finer control over
+   * performance and behaviour.
+   */
+  //@{
+  /**
+   * Initialise starting state, with a path from an unconditional run of
+   * the filter.
+   *
+   * @tparam S1 State type.
+   * @tparam IO1 Output type.
+   * @tparam IO2 Input type.
+   *
+   * @param[in,out] rng Random number generator.
+   * @param first Start of time schedule.
+   * @param last End of time schedule.
+   * @param[out] s1 State.
+   * @param[in,out] out Output buffer;
+   * @param inInit Initialisation file.
+   */
+  template<class S1, class IO1, class IO2>
+  void init(Random& rng, const ScheduleIterator first,
+      const ScheduleIterator last, S1& s1, IO1& out, IO2& inInit);
+
+  /**
+   * Propose new parameters, keeping the path.
+   *
+   * @tparam S1 State type.
+   * @tparam S2 State type.
+   * @tparam IO1 Output type.
+   *
+   * @param[in,out] rng Random number generator.
+   * @param first Start of time schedule.
+   * @param last End of time schedule.
+   * @param[in,out] s1 Current state.
+   * @param[out] s2 Proposed state.
+   * @param[in,out] out Output buffer.
+   */
+  template<class S1, class S2, class IO1>
+  void propose(Random& rng, const ScheduleIterator first,
+      const ScheduleIterator last, S1& s1, S2& s2, IO1& out);
+
+  /**
+   * Accept or reject proposed parameters.
+   *
+   * @tparam S1 State type.
+   * @tparam S2 State type.
+   *
+   * @param[in,out] rng Random number generator.
+   * @param s1 Current state.
+   * @param s2 Proposed state.
+   *
+   * @return Was proposal accepted?
+   */
+  template<class S1, class S2>
+  bool acceptReject(Random& rng, S1& s1, S2& s2);
+
+  /**
+   * Draw new path by conditional particle filter.
+   *
+   * @tparam S1 State type.
+   * @tparam S2 State type.
+   * @tparam IO1 Output type.
+   *
+   * @param[in,out] rng Random number generator.
+   * @param first Start of time schedule.
+   * @param last End of time schedule.
+   * @param[in,out] s1 Current state. Its path is the reference, and is
+   * replaced.
+   * @param[out] s2 Scratch state.
+   * @param[in,out] out Output buffer.
+   */
+  template<class S1, class S2, class IO1>
+  void sweep(Random& rng, const ScheduleIterator first,
+      const ScheduleIterator last, S1& s1, S2& s2, IO1& out);
+
+  /**
+   * @copydoc MarginalMH::output()
+   */
+  template<class S1, class IO1>
+  void output(const int c, const S1& s1, IO1& out);
+
+  /**
+   * @copydoc Simulator::outputT()
+   */
+  template<class S1, class IO1>
+  void outputT(const S1& s, IO1& out);
+
+  /**
+   * Report progress on stderr.
+   *
+   * @tparam S1 State type.
+   *
+   * @param c Number of steps taken.
+   * @param s1 Current state.
+   */
+  template<class S1>
+  void report(const int c, const S1& s1);
+
+  /**
+   * @copydoc MarginalMH::diagnose()
+   */
+  template<class IO1>
+  bool diagnose(IO1& out);
+
+  /**
+   * Terminate.
+   */
+  void term();
+  //@}
+
+private:
+  /**
+   * Model.
+   */
+  B& m;
+
+  /**
+   * Filter.
+   */
+  F& filter;
+
+  /**
+   * Target effective sample size.
+   */
+  double stopESS;
+
+  /**
+   * Number of samples between diagnostics.
+   */
+  int diagnosticsInterval;
+
+  /**
+   * Joint log-densities of path and observations for the current and
+   * proposed parameters.
+   */
+  double lp1, lp2;
+
+  /**
+   * Was the last proposal accepted?
+   */
+  bool lastAccepted;
+
+  /**
+   * Number of accepted proposals.
+   */
+  int accepted;
+
+  /**
+   * Total number of proposals.
+   */
+  int total;
+};
+}
+
+#include "../misc/TicToc.hpp"
+#include "../pdf/MCMCDiagnostics.hpp"
+
+#include <algorithm>
+
+template<class B, class F>
+bi::ParticleGibbs<B,F>::ParticleGibbs(B& m, F& filter, const double stopESS,
+    const int diagnosticsInterval) :
+    m(m), filter(filter), stopESS(stopESS), diagnosticsInterval(
+        diagnosticsInterval), lp1(0.0), lp2(0.0), lastAccepted(false), accepted(
+        0), total(0) {
+  /* pre-condition */
+  BI_ERROR_MSG(stopESS >= 0.0, "--stop-ess must be positive");
+  BI_ERROR_MSG(diagnosticsInterval >= 0,
+      "--diagnostics-interval must be positive");
+  BI_ERROR_MSG(stopESS == 0.0 || diagnosticsInterval > 0,
+      "--stop-ess requires a positive --diagnostics-interval");
+#ifdef ENABLE_CUDA
+  BI_ERROR_MSG(false, "--sampler pg is not supported on device");
+#endif
+}
+
+template<class B, class F>
+template<class S1, class IO1, class IO2>
+void bi::ParticleGibbs<B,F>::sample(Random& rng, const ScheduleIterator first,
+    const ScheduleIterator last, S1& s, const int C, IO1& out, IO2& inInit) {
+  /* pre-condition */
+  BI_ERROR(C > 0);
+
+  TicToc clock;
+  init(rng, first, last, s.s1, s.out, inInit);
+  output(0, s.s1, out);
+  for (int c = 1; c < C; ++c) {
+    propose(rng, first, last, s.s1, s.s2, s.out);
+    acceptReject(rng, s.s1, s.s2);
+    sweep(rng, first, last, s.s1, s.s2, s.out);
+    report(c, s.s1);
+    output(c, s.s1, out);
+    if (diagnosticsInterval > 0 && (c + 1) % diagnosticsInterval == 0
+        && diagnose(out)) {
+      break;
+    }
+  }
+  s.clock = clock.toc();
+  outputT(s, out);
+  term();
+}
+
+template<class B, class F>
+template<class S1, class IO1, class IO2>
+void bi::ParticleGibbs<B,F>::init(Random& rng, const ScheduleIterator first,
+    const ScheduleIterator last, S1& s1, IO1& out, IO2& inInit) {
+  for (ScheduleIterator iter = first; iter != last; ++iter) {
+    BI_ERROR_MSG(iter->hasOutput(), "--sampler pg requires an output at every time in the schedule, set --noutputs to the number of time steps, and --with-output-at-obs");
+  }
+
+  filter.setConditional(false);
+  filter.init(rng, *first, s1, out, inInit);
+  filter.filter(rng, first, last, s1, out);
+  filter.samplePath(rng, s1, out);
+  filter.setConditional(true);
+
+  lastAccepted = true;
+  accepted = 1;
+  total = 1;
+}
+
+template<class B, class F>
+template<class S1, class S2, class IO1>
+void bi::ParticleGibbs<B,F>::propose(Random& rng,
+    const ScheduleIterator first, const ScheduleIterator last, S1& s1,
+    S2& s2, IO1& out) {
+  try {
+    lp1 = filter.pathLogDensity(first, last, s1);
+    filter.propose(rng, *first, s1, s2, out);
+    s2.path = s1.path;
+    s2.times = s1.times;
+    if (bi::is_finite(s2.logPrior)) {
+      lp2 = filter.pathLogDensity(first, last, s2);
+    } else {
+      lp2 = -BI_INF;
+    }
+  } catch (CholeskyException e) {
+    lp2 = -BI_INF;
+  }
+}
+
+template<class B, class F>
+template<class S1, class S2>
+bool bi::ParticleGibbs<B,F>::acceptReject(Random& rng, S1& s1, S2& s2) {
+  if (!bi::is_finite(lp2)) {
+    lastAccepted = false;
+  } else if (!bi::is_finite(lp1)) {
+    lastAccepted = true;
+  } else {
+    double loglr = lp2 - lp1;
+    double logpr = s2.logPrior - s1.logPrior;
+    double logqr = s1.logProposal - s2.logProposal;
+    double logratio = loglr + logpr + logqr;
+    double u = rng.uniform<double>();
+
+    lastAccepted = bi::log(u) < logratio;
+  }
+
+  if (lastAccepted) {
+    s2.swap(s1);
+    std::swap(lp1, lp2);
+    ++accepted;
+  }
+  ++total;
+
+  return lastAccepted;
+}
+
+template<class B, class F>
+template<class S1, class S2, class IO1>
+void bi::ParticleGibbs<B,F>::sweep(Random& rng, const ScheduleIterator first,
+    const ScheduleIterator last, S1& s1, S2& s2, IO1& out) {
+  try {
+    filter.restart(rng, *first, s1, s2, out);
+    s2.path = s1.path;
+    s2.times = s1.times;
+    filter.filter(rng, first, last, s2, out);
+    filter.samplePath(rng, s2, out);
+    s1.swap(s2);
+  } catch (ParticleFilterDegeneratedException e) {
+    /* keep current path */
+  }
+}
+
+template<class B, class F>
+template<class S1, class IO1>
+void bi::ParticleGibbs<B,F>::output(const int c, const S1& s1, IO1& out) {
+  out.write(c, s1);
+  if (out.isFull()) {
+    out.flush();
+    out.clear();
+  }
+}
+
+template<class B, class F>
+template<class S1, class IO1>
+void bi::ParticleGibbs<B,F>::outputT(const S1& s, IO1& out) {
+  out.writeClock(s.clock);
+}
+
+template<class B, class F>
+template<class S1>
+void bi::ParticleGibbs<B,F>::report(const int c, const S1& s1) {
+  std::cerr << c << ":\t";
+  std::cerr.width(10);
+  std::cerr << s1.logLikelihood;
+  std::cerr << '\t';
+  std::cerr.width(10);
+  std::cerr << s1.logPrior;
+  std::cerr << '\t';
+  std::cerr.width(10);
+  std::cerr << s1.logProposal;
+  std::cerr << '\t';
+  if (lastAccepted) {
+    std::cerr << "accept";
+  }
+  std::cerr << "\taccept=" << (double)accepted / total;
+  std::cerr << std::endl;
+}
+
+template<class B, class F>
+template<class IO1>
+bool bi::ParticleGibbs<B,F>::diagnose(IO1& out) {
+  const MCMCDiagnostics& diag = out.diagnose();
+
+  std::cerr << "diagnose:\tsamples " << diag.size() << "\tess "
+      << diag.getMinESS() << "\trhat " << diag.getMaxRHat() << "\taccept "
+      << diag.getAcceptanceRate() << std::endl;
+
+  return stopESS > 0.0 && diag.getMinESS() >= stopESS;
+}
+
+template<class B, class F>
+void bi::ParticleGibbs<B,F>::term() {
+  //
+}
+
+#endif
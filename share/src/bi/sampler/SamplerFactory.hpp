@@ -9,8 +9,10 @@
 #define BI_SAMPLER_SAMPLERFACTORY_HPP
 
 #include "MarginalMH.hpp"
+#include "MarginalPT.hpp"
 #include "MarginalSIR.hpp"
 #include "MarginalSIS.hpp"
+#include "ParticleGibbs.hpp"
 
 #include "boost/shared_ptr.hpp"
 
@@ -27,7 +29,16 @@ public:
    */
   template<class B, class F>
   static boost::shared_ptr<MarginalMH<B,F> > createMarginalMH(B& m,
-      F& filter);
+      F& filter, const double rho = 0.0, const double targetVariance = 0.0,
+      const int npilots = 20, const double stopESS = 0.0,
+      const int diagnosticsInterval = 0);
+
+  /**
+   * Create marginal parallel tempering sampler.
+   */
+  template<class B, class F>
+  static boost::shared_ptr<MarginalPT<B,F> > createMarginalPT(B& m,
+      F& filter, const double maxTemp = 10.0, const int swapInterval = 1);
 
   /**
    * Create marginal sequential importance resampling sampler.
@@ -35,7 +46,7 @@ public:
   template<class B, class F, class A, class R>
   static boost::shared_ptr<MarginalSIR<B,F,A,R> > createMarginalSIR(B& m,
       F& mmh, A& adapter, R& resam, const int nmoves = 1,
-      const double tmoves = 0.0);
+      const double tmoves = 0.0, const double minRate = 0.0);
 
   /**
    * Create marginal sequential rejection sampler.
@@ -43,22 +54,40 @@ public:
   template<class B, class F, class A, class S>
   static boost::shared_ptr<MarginalSIS<B,F,A,S> > createMarginalSIS(B& m,
       F& filter, A& adapter, S& stopper);
+
+  /**
+   * Create particle Gibbs sampler.
+   */
+  template<class B, class F>
+  static boost::shared_ptr<ParticleGibbs<B,F> > createParticleGibbs(B& m,
+      F& filter, const double stopESS = 0.0,
+      const int diagnosticsInterval = 0);
 };
 }
 
 template<class B, class F>
 boost::shared_ptr<bi::MarginalMH<B,F> > bi::SamplerFactory::createMarginalMH(
-    B& m, F& filter) {
+    B& m, F& filter, const double rho, const double targetVariance,
+    const int npilots, const double stopESS, const int diagnosticsInterval) {
   return boost::shared_ptr < MarginalMH<B,F>
-      > (new MarginalMH<B,F>(m, filter));
+      > (new MarginalMH<B,F>(m, filter, rho, targetVariance, npilots,
+          stopESS, diagnosticsInterval));
+}
+
+template<class B, class F>
+boost::shared_ptr<bi::MarginalPT<B,F> > bi::SamplerFactory::createMarginalPT(
+    B& m, F& filter, const double maxTemp, const int swapInterval) {
+  return boost::shared_ptr < MarginalPT<B,F>
+      > (new MarginalPT<B,F>(m, filter, maxTemp, swapInterval));
 }
 
 template<class B, class F, class A, class R>
 boost::shared_ptr<bi::MarginalSIR<B,F,A,R> > bi::SamplerFactory::createMarginalSIR(
     B& m, F& mmh, A& adapter, R& resam, const int nmoves,
-    const double tmoves) {
+    const double tmoves, const double minRate) {
   return boost::shared_ptr < MarginalSIR<B,F,A,R>
-      > (new MarginalSIR<B,F,A,R>(m, mmh, adapter, resam, nmoves, tmoves));
+      > (new MarginalSIR<B,F,A,R>(m, mmh, adapter, resam, nmoves, tmoves,
+          minRate));
 }
 
 template<class B, class F, class A, class S>
@@ -68,4 +97,11 @@ boost::shared_ptr<bi::MarginalSIS<B,F,A,S> > bi::SamplerFactory::createMarginalS
       > (new MarginalSIS<B,F,A,S>(m, filter, adapter, stopper));
 }
 
+template<class B, class F>
+boost::shared_ptr<bi::ParticleGibbs<B,F> > bi::SamplerFactory::createParticleGibbs(
+    B& m, F& filter, const double stopESS, const int diagnosticsInterval) {
+  return boost::shared_ptr < ParticleGibbs<B,F>
+      > (new ParticleGibbs<B,F>(m, filter, stopESS, diagnosticsInterval));
+}
+
 #endif
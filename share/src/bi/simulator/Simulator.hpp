@@ -118,6 +118,27 @@ public:
   void propose(Random& rng, const ScheduleElement now, S1& s1, S2& s2,
       IO1& out, A& adapter);
 
+  /**
+   * Initialise new state with the parameters of an existing state, drawing
+   * new initial values.
+   *
+   * @tparam S1 State type.
+   * @tparam S2 State type.
+   * @tparam IO1 Output type.
+   *
+   * @param[in,out] rng Random number generator.
+   * @param now Current step in time schedule.
+   * @param s1 Existing state.
+   * @param[out] s2 New state.
+   * @param out Output file.
+   *
+   * Used to repeat a run at fixed parameters, e.g. with a different number
+   * of particles.
+   */
+  template<class S1, class S2, class IO1>
+  void restart(Random& rng, const ScheduleElement now, const S1& s1, S2& s2,
+      IO1& out);
+
   /**
    * Advance model forward to time of next output, and output.
    *
@@ -394,6 +415,38 @@ void bi::Simulator<B,F,O>::propose(Random& rng, const ScheduleElement now,
   out.clear();
 }
 
+template<class B, class F, class O>
+template<class S1, class S2, class IO1>
+void bi::Simulator<B,F,O>::restart(Random& rng, const ScheduleElement now,
+    const S1& s1, S2& s2, IO1& out) {
+  s2.clear();
+  s2.setTime(now.getTime());
+
+  /* static inputs */
+  in.update0(s2);
+
+  /* parameters */
+  s2.get(P_VAR) = s1.get(P_VAR);
+  s2.get(PY_VAR) = s1.get(P_VAR);
+  s2.logPrior = s1.logPrior;
+  s2.logProposal = s1.logProposal;
+
+  /* dynamic inputs */
+  if (now.hasInput()) {
+    in.update(now.indexInput(), s2);
+  }
+
+  /* observations */
+  if (now.hasObs()) {
+    obs.update(now.indexObs(), s2);
+  }
+
+  /* initial values */
+  m.initialSamples(rng, s2);
+
+  out.clear();
+}
+
 template<class B, class F, class O>
 template<class S1, class IO1>
 void bi::Simulator<B,F,O>::step(Random& rng, ScheduleIterator& iter,
@@ -65,6 +65,8 @@ namespace bi {
  * 256-bit SIMD vector of doubles.
  */
 union avx_double {
+  typedef double value_type;
+
   struct {
     sse_double a, b;
   } unpacked;
@@ -72,6 +74,7 @@ union avx_double {
 
   avx_double& operator=(const double& o) {
     packed = _mm256_set1_pd(o);
+    return *this;
   }
 };
 
@@ -193,7 +196,7 @@ BI_FORCE_INLINE inline avx_double operator==(const avx_double& o1,
 BI_FORCE_INLINE inline avx_double operator!=(const avx_double& o1,
     const avx_double& o2) {
   avx_double res;
-  res.packed = _mm256_cmp_pd(o1.packed, o2.packed, _CMP_NEQ_OQ);
+  res.packed = _mm256_cmp_pd(o1.packed, o2.packed, _CMP_NEQ_UQ);
   return res;
 }
 
@@ -241,20 +244,94 @@ BI_FORCE_INLINE inline avx_double abs(const avx_double x) {
   return res;
 }
 
+BI_FORCE_INLINE inline avx_double simd_select(const avx_double mask,
+    const avx_double x, const avx_double y) {
+  avx_double res;
+  res.packed = _mm256_blendv_pd(y.packed, x.packed, mask.packed);
+  return res;
+}
+
+BI_FORCE_INLINE inline bool simd_any(const avx_double mask) {
+  return _mm256_movemask_pd(mask.packed) != 0;
+}
+
+BI_FORCE_INLINE inline avx_double simd_round(const avx_double x) {
+  avx_double res;
+  res.packed = _mm256_round_pd(x.packed,
+      _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  return res;
+}
+
+BI_FORCE_INLINE inline avx_double simd_pow2(const avx_double n) {
+  /* AVX lacks 256-bit integer operations, so use the SSE versions on each
+   * half, kept in registers */
+  sse_double a, b;
+  avx_double res;
+  a.packed = _mm256_castpd256_pd128(n.packed);
+  b.packed = _mm256_extractf128_pd(n.packed, 1);
+  a = simd_pow2(a);
+  b = simd_pow2(b);
+  res.packed = _mm256_insertf128_pd(
+      _mm256_castpd128_pd256(a.packed), b.packed, 1);
+  return res;
+}
+
+BI_FORCE_INLINE inline avx_double simd_frexp(const avx_double x,
+    avx_double& e) {
+  sse_double a, b, ea, eb;
+  avx_double res;
+  a.packed = _mm256_castpd256_pd128(x.packed);
+  b.packed = _mm256_extractf128_pd(x.packed, 1);
+  a = simd_frexp(a, ea);
+  b = simd_frexp(b, eb);
+  e.packed = _mm256_insertf128_pd(
+      _mm256_castpd128_pd256(ea.packed), eb.packed, 1);
+  res.packed = _mm256_insertf128_pd(
+      _mm256_castpd128_pd256(a.packed), b.packed, 1);
+  return res;
+}
+
+/*
+ * log(), expm1() and lgamma() use libm unless fast math is enabled, as for
+ * sse_double.
+ */
 BI_FORCE_INLINE inline avx_double log(const avx_double x) {
+  #ifdef ENABLE_SSE_FAST_MATH
+  return simd_log(x);
+  #else
   BI_AVXDOUBLE_UNIVARIATE(log, x)
+  #endif
 }
 
 BI_FORCE_INLINE inline avx_double nanlog(const avx_double x) {
+  #ifdef ENABLE_SSE_FAST_MATH
+  const avx_double y = simd_log(x);
+  return simd_select(x != x,
+      -simd_constant<avx_double>(std::numeric_limits<double>::infinity()), y);
+  #else
   BI_AVXDOUBLE_UNIVARIATE(nanlog, x)
+  #endif
 }
 
 BI_FORCE_INLINE inline avx_double exp(const avx_double x) {
-  BI_AVXDOUBLE_UNIVARIATE(exp, x)
+  return simd_exp(x);
 }
 
 BI_FORCE_INLINE inline avx_double nanexp(const avx_double x) {
-  BI_AVXDOUBLE_UNIVARIATE(nanexp, x)
+  const avx_double y = simd_exp(x);
+  return simd_select(x != x, simd_constant<avx_double>(0.0), y);
+}
+
+BI_FORCE_INLINE inline avx_double log1p(const avx_double x) {
+  return simd_log1p(x);
+}
+
+BI_FORCE_INLINE inline avx_double expm1(const avx_double x) {
+  #ifdef ENABLE_SSE_FAST_MATH
+  return simd_expm1(x);
+  #else
+  BI_AVXDOUBLE_UNIVARIATE(expm1, x)
+  #endif
 }
 
 BI_FORCE_INLINE inline avx_double max(const avx_double x,
@@ -308,7 +385,16 @@ BI_FORCE_INLINE inline avx_double gamma(const avx_double x) {
 }
 
 BI_FORCE_INLINE inline avx_double lgamma(const avx_double x) {
+  #ifdef ENABLE_SSE_FAST_MATH
+  if (simd_any(x <= simd_constant<avx_double>(0.0))) {
+    /* outside domain of vectorised version */
+    BI_AVXDOUBLE_UNIVARIATE(lgamma, x)
+  } else {
+    return simd_lgamma(x);
+  }
+  #else
   BI_AVXDOUBLE_UNIVARIATE(lgamma, x)
+  #endif
 }
 
 BI_FORCE_INLINE inline avx_double sin(const avx_double x) {
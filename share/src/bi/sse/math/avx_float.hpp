@@ -65,6 +65,8 @@ namespace bi {
  * 256-bit SIMD vector of floats.
  */
 union avx_float {
+  typedef float value_type;
+
   struct {
     sse_float a, b;
   } unpacked;
@@ -72,6 +74,7 @@ union avx_float {
 
   avx_float& operator=(const float& o) {
     packed = _mm256_set1_ps(o);
+    return *this;
   }
 };
 
@@ -193,7 +196,7 @@ BI_FORCE_INLINE inline avx_float operator==(const avx_float& o1,
 BI_FORCE_INLINE inline avx_float operator!=(const avx_float& o1,
     const avx_float& o2) {
   avx_float res;
-  res.packed = _mm256_cmp_ps(o1.packed, o2.packed, _CMP_NEQ_OQ);
+  res.packed = _mm256_cmp_ps(o1.packed, o2.packed, _CMP_NEQ_UQ);
   return res;
 }
 
@@ -241,20 +244,78 @@ BI_FORCE_INLINE inline avx_float abs(const avx_float x) {
   return res;
 }
 
+BI_FORCE_INLINE inline avx_float simd_select(const avx_float mask,
+    const avx_float x, const avx_float y) {
+  avx_float res;
+  res.packed = _mm256_blendv_ps(y.packed, x.packed, mask.packed);
+  return res;
+}
+
+BI_FORCE_INLINE inline bool simd_any(const avx_float mask) {
+  return _mm256_movemask_ps(mask.packed) != 0;
+}
+
+BI_FORCE_INLINE inline avx_float simd_round(const avx_float x) {
+  avx_float res;
+  res.packed = _mm256_round_ps(x.packed,
+      _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  return res;
+}
+
+BI_FORCE_INLINE inline avx_float simd_pow2(const avx_float n) {
+  /* AVX lacks 256-bit integer operations, so use the SSE versions on each
+   * half, kept in registers */
+  sse_float a, b;
+  avx_float res;
+  a.packed = _mm256_castps256_ps128(n.packed);
+  b.packed = _mm256_extractf128_ps(n.packed, 1);
+  a = simd_pow2(a);
+  b = simd_pow2(b);
+  res.packed = _mm256_insertf128_ps(
+      _mm256_castps128_ps256(a.packed), b.packed, 1);
+  return res;
+}
+
+BI_FORCE_INLINE inline avx_float simd_frexp(const avx_float x,
+    avx_float& e) {
+  sse_float a, b, ea, eb;
+  avx_float res;
+  a.packed = _mm256_castps256_ps128(x.packed);
+  b.packed = _mm256_extractf128_ps(x.packed, 1);
+  a = simd_frexp(a, ea);
+  b = simd_frexp(b, eb);
+  e.packed = _mm256_insertf128_ps(
+      _mm256_castps128_ps256(ea.packed), eb.packed, 1);
+  res.packed = _mm256_insertf128_ps(
+      _mm256_castps128_ps256(a.packed), b.packed, 1);
+  return res;
+}
+
 BI_FORCE_INLINE inline avx_float log(const avx_float x) {
-  BI_AVXFLOAT_UNIVARIATE(log, x)
+  return simd_log(x);
 }
 
 BI_FORCE_INLINE inline avx_float nanlog(const avx_float x) {
-  BI_AVXFLOAT_UNIVARIATE(nanlog, x)
+  const avx_float y = simd_log(x);
+  return simd_select(x != x,
+      -simd_constant<avx_float>(std::numeric_limits<float>::infinity()), y);
 }
 
 BI_FORCE_INLINE inline avx_float exp(const avx_float x) {
-  BI_AVXFLOAT_UNIVARIATE(exp, x)
+  return simd_exp(x);
 }
 
 BI_FORCE_INLINE inline avx_float nanexp(const avx_float x) {
-  BI_AVXFLOAT_UNIVARIATE(nanexp, x)
+  const avx_float y = simd_exp(x);
+  return simd_select(x != x, simd_constant<avx_float>(0.0f), y);
+}
+
+BI_FORCE_INLINE inline avx_float log1p(const avx_float x) {
+  return simd_log1p(x);
+}
+
+BI_FORCE_INLINE inline avx_float expm1(const avx_float x) {
+  return simd_expm1(x);
 }
 
 BI_FORCE_INLINE inline avx_float max(const avx_float x, const avx_float y) {
@@ -304,7 +365,12 @@ BI_FORCE_INLINE inline avx_float gamma(const avx_float x) {
 }
 
 BI_FORCE_INLINE inline avx_float lgamma(const avx_float x) {
-  BI_AVXFLOAT_UNIVARIATE(lgamma, x)
+  if (simd_any(x <= simd_constant<avx_float>(0.0f))) {
+    /* outside domain of vectorised version */
+    BI_AVXFLOAT_UNIVARIATE(lgamma, x)
+  } else {
+    return simd_lgamma(x);
+  }
 }
 
 BI_FORCE_INLINE inline avx_float sin(const avx_float x) {
@@ -9,6 +9,7 @@
 #define BI_SSE_MATH_SSEDOUBLE_HPP
 
 #include "../../math/scalar.hpp"
+#include "transcendental.hpp"
 #include "../../misc/compile.hpp"
 
 #include <pmmintrin.h>
@@ -66,6 +67,8 @@ namespace bi {
  * 128-bit SIMD vector of doubles.
  */
 union sse_double {
+  typedef double value_type;
+
   struct {
     double a, b;
   } unpacked;
@@ -243,20 +246,94 @@ BI_FORCE_INLINE inline sse_double abs(const sse_double x) {
   return res;
 }
 
+BI_FORCE_INLINE inline sse_double simd_select(const sse_double mask,
+    const sse_double x, const sse_double y) {
+  sse_double res;
+  res.packed = _mm_or_pd(_mm_and_pd(mask.packed, x.packed),
+      _mm_andnot_pd(mask.packed, y.packed));
+  return res;
+}
+
+BI_FORCE_INLINE inline bool simd_any(const sse_double mask) {
+  return _mm_movemask_pd(mask.packed) != 0;
+}
+
+BI_FORCE_INLINE inline sse_double simd_round(const sse_double x) {
+  /* adding 1.5*2^52 leaves no bits for the fraction; valid for |x| < 2^51 */
+  const __m128d magic = _mm_set1_pd(6755399441055744.0);
+  sse_double res;
+  res.packed = _mm_sub_pd(_mm_add_pd(x.packed, magic), magic);
+  return res;
+}
+
+BI_FORCE_INLINE inline sse_double simd_pow2(const sse_double n) {
+  /* as for simd_round(), with the exponent bias added, the biased exponent
+   * is in the low bits, from where it is shifted into place */
+  const __m128d magic = _mm_set1_pd(6755399441055744.0 + 1023.0);
+  sse_double res;
+  res.packed = _mm_castsi128_pd(_mm_slli_epi64(_mm_castpd_si128(
+      _mm_add_pd(n.packed, magic)), 52));
+  return res;
+}
+
+BI_FORCE_INLINE inline sse_double simd_frexp(const sse_double x,
+    sse_double& e) {
+  const __m128i bits = _mm_castpd_si128(x.packed);
+  const __m128i mant = _mm_set1_epi64x(0x800FFFFFFFFFFFFFLL);
+  const __m128i half = _mm_set1_epi64x(0x3FE0000000000000LL);
+  const __m128i two52 = _mm_set1_epi64x(0x4330000000000000LL);
+  sse_double res;
+
+  /* biased exponent, converted by placing in the mantissa of 2^52 */
+  e.packed = _mm_sub_pd(_mm_castsi128_pd(_mm_or_si128(_mm_srli_epi64(bits,
+      52), two52)), _mm_set1_pd(4503599627370496.0 + 1022.0));
+  res.packed = _mm_castsi128_pd(_mm_or_si128(_mm_and_si128(bits, mant),
+      half));
+  return res;
+}
+
+/*
+ * In double precision, the vectorised log() is no faster than libm, and
+ * expm1(), which costs an exp() and a log(), and lgamma() are slower, so
+ * these use libm unless fast math is enabled.
+ */
 BI_FORCE_INLINE inline sse_double log(const sse_double x) {
+  #ifdef ENABLE_SSE_FAST_MATH
+  return simd_log(x);
+  #else
   BI_SSEDOUBLE_UNIVARIATE(log, x)
+  #endif
 }
 
 BI_FORCE_INLINE inline sse_double nanlog(const sse_double x) {
+  #ifdef ENABLE_SSE_FAST_MATH
+  const sse_double y = simd_log(x);
+  return simd_select(x != x,
+      -simd_constant<sse_double>(std::numeric_limits<double>::infinity()), y);
+  #else
   BI_SSEDOUBLE_UNIVARIATE(nanlog, x)
+  #endif
 }
 
 BI_FORCE_INLINE inline sse_double exp(const sse_double x) {
-  BI_SSEDOUBLE_UNIVARIATE(exp, x)
+  return simd_exp(x);
 }
 
 BI_FORCE_INLINE inline sse_double nanexp(const sse_double x) {
-  BI_SSEDOUBLE_UNIVARIATE(nanexp, x)
+  const sse_double y = simd_exp(x);
+  return simd_select(x != x, simd_constant<sse_double>(0.0), y);
+}
+
+BI_FORCE_INLINE inline sse_double log1p(const sse_double x) {
+  return simd_log1p(x);
+}
+
+BI_FORCE_INLINE inline sse_double expm1(const sse_double x) {
+  #ifdef ENABLE_SSE_FAST_MATH
+  return simd_expm1(x);
+  #else
+  BI_SSEDOUBLE_UNIVARIATE(expm1, x)
+  #endif
 }
 
 BI_FORCE_INLINE inline sse_double max(const sse_double x,
@@ -310,7 +387,16 @@ BI_FORCE_INLINE inline sse_double gamma(const sse_double x) {
 }
 
 BI_FORCE_INLINE inline sse_double lgamma(const sse_double x) {
+  #ifdef ENABLE_SSE_FAST_MATH
+  if (simd_any(x <= simd_constant<sse_double>(0.0))) {
+    /* outside domain of vectorised version */
+    BI_SSEDOUBLE_UNIVARIATE(lgamma, x)
+  } else {
+    return simd_lgamma(x);
+  }
+  #else
   BI_SSEDOUBLE_UNIVARIATE(lgamma, x)
+  #endif
 }
 
 BI_FORCE_INLINE inline sse_double sin(const sse_double x) {
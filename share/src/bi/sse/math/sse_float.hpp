@@ -9,6 +9,7 @@
 #define BI_SSE_MATH_SSEFLOAT_HPP
 
 #include "../../math/scalar.hpp"
+#include "transcendental.hpp"
 #include "../../misc/compile.hpp"
 
 #include <pmmintrin.h>
@@ -74,6 +75,8 @@ namespace bi {
  * 128-bit SIMD vector of floats.
  */
 union sse_float {
+  typedef float value_type;
+
   struct {
     float a, b, c, d;
   } unpacked;
@@ -251,20 +254,75 @@ BI_FORCE_INLINE inline sse_float abs(const sse_float x) {
   return res;
 }
 
+BI_FORCE_INLINE inline sse_float simd_select(const sse_float mask,
+    const sse_float x, const sse_float y) {
+  sse_float res;
+  res.packed = _mm_or_ps(_mm_and_ps(mask.packed, x.packed),
+      _mm_andnot_ps(mask.packed, y.packed));
+  return res;
+}
+
+BI_FORCE_INLINE inline bool simd_any(const sse_float mask) {
+  return _mm_movemask_ps(mask.packed) != 0;
+}
+
+BI_FORCE_INLINE inline sse_float simd_round(const sse_float x) {
+  /* adding 1.5*2^23 leaves no bits for the fraction; valid for |x| < 2^22 */
+  const __m128 magic = _mm_set1_ps(12582912.0f);
+  sse_float res;
+  res.packed = _mm_sub_ps(_mm_add_ps(x.packed, magic), magic);
+  return res;
+}
+
+BI_FORCE_INLINE inline sse_float simd_pow2(const sse_float n) {
+  /* as for simd_round(), with the exponent bias added, the biased exponent
+   * is in the low bits, from where it is shifted into place */
+  const __m128 magic = _mm_set1_ps(12582912.0f + 127.0f);
+  sse_float res;
+  res.packed = _mm_castsi128_ps(_mm_slli_epi32(_mm_castps_si128(
+      _mm_add_ps(n.packed, magic)), 23));
+  return res;
+}
+
+BI_FORCE_INLINE inline sse_float simd_frexp(const sse_float x,
+    sse_float& e) {
+  const __m128i bits = _mm_castps_si128(x.packed);
+  const __m128i mant = _mm_set1_epi32(0x807FFFFF);
+  const __m128i half = _mm_set1_epi32(0x3F000000);
+  sse_float res;
+
+  e.packed = _mm_sub_ps(_mm_cvtepi32_ps(_mm_srli_epi32(bits, 23)),
+      _mm_set1_ps(126.0f));
+  res.packed = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, mant),
+      half));
+  return res;
+}
+
 BI_FORCE_INLINE inline sse_float log(const sse_float x) {
-  BI_SSEFLOAT_UNIVARIATE(log, x)
+  return simd_log(x);
 }
 
 BI_FORCE_INLINE inline sse_float nanlog(const sse_float x) {
-  BI_SSEFLOAT_UNIVARIATE(nanlog, x)
+  const sse_float y = simd_log(x);
+  return simd_select(x != x,
+      -simd_constant<sse_float>(std::numeric_limits<float>::infinity()), y);
 }
 
 BI_FORCE_INLINE inline sse_float exp(const sse_float x) {
-  BI_SSEFLOAT_UNIVARIATE(exp, x)
+  return simd_exp(x);
 }
 
 BI_FORCE_INLINE inline sse_float nanexp(const sse_float x) {
-  BI_SSEFLOAT_UNIVARIATE(nanexp, x)
+  const sse_float y = simd_exp(x);
+  return simd_select(x != x, simd_constant<sse_float>(0.0f), y);
+}
+
+BI_FORCE_INLINE inline sse_float log1p(const sse_float x) {
+  return simd_log1p(x);
+}
+
+BI_FORCE_INLINE inline sse_float expm1(const sse_float x) {
+  return simd_expm1(x);
 }
 
 BI_FORCE_INLINE inline sse_float max(const sse_float x, const sse_float y) {
@@ -314,7 +372,12 @@ BI_FORCE_INLINE inline sse_float gamma(const sse_float x) {
 }
 
 BI_FORCE_INLINE inline sse_float lgamma(const sse_float x) {
-  BI_SSEFLOAT_UNIVARIATE(lgamma, x)
+  if (simd_any(x <= simd_constant<sse_float>(0.0f))) {
+    /* outside domain of vectorised version */
+    BI_SSEFLOAT_UNIVARIATE(lgamma, x)
+  } else {
+    return simd_lgamma(x);
+  }
 }
 
 BI_FORCE_INLINE inline sse_float sin(const sse_float x) {
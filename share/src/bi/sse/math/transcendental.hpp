@@ -0,0 +1,451 @@
+/**
+ * @file
+ *
+ * Vectorised transcendental functions for SIMD types.
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ *
+ * The functions here are generic over the SIMD types sse_float,
+ * sse_double, avx_float and avx_double, so that a single implementation of
+ * each is shared. They require of a SIMD type @c T the arithmetic and
+ * comparison operators, along with:
+ *
+ * @li a @c value_type typedef for the element type,
+ * @li <tt>simd_select(mask, x, y)</tt>, elementwise <tt>mask ? x : y</tt>,
+ * @li <tt>simd_any(mask)</tt>, true if any element of a mask is set,
+ * @li <tt>simd_round(x)</tt>, round to nearest integer,
+ * @li <tt>simd_pow2(n)</tt>, \f$2^n\f$ for integral @c n in the range of
+ * normal exponents, and
+ * @li <tt>simd_frexp(x, e)</tt>, mantissa in \f$[1/2,1)\f$ and exponent of
+ * positive normal @c x.
+ *
+ * Each is accurate to a few units in the last place for the element type.
+ * When compiled with @c ENABLE_SSE_FAST_MATH, the double precision versions
+ * of exp() and log(), and so of all others, use polynomials of lower degree,
+ * accurate to single precision only.
+ */
+#ifndef BI_SSE_MATH_TRANSCENDENTAL_HPP
+#define BI_SSE_MATH_TRANSCENDENTAL_HPP
+
+#include "../../misc/compile.hpp"
+
+#include <limits>
+
+namespace bi {
+/**
+ * SIMD vector with all elements set to the same value.
+ *
+ * @tparam T SIMD type.
+ *
+ * @param x Value.
+ */
+template<class T>
+T simd_constant(const typename T::value_type x);
+
+/**
+ * Multiply SIMD vector by integral power of two.
+ *
+ * @tparam T SIMD type.
+ *
+ * @param x Vector.
+ * @param n Integral exponents.
+ *
+ * @return \f$x2^n\f$, correctly underflowing to subnormal numbers.
+ */
+template<class T>
+T simd_ldexp(const T x, const T n);
+
+/**
+ * Vectorised exponential.
+ *
+ * @tparam T SIMD type.
+ */
+template<class T>
+T simd_exp(const T x);
+
+/**
+ * Vectorised logarithm.
+ *
+ * @tparam T SIMD type.
+ */
+template<class T>
+T simd_log(const T x);
+
+/**
+ * Vectorised \f$\exp(x) - 1\f$, accurate for small @p x.
+ *
+ * @tparam T SIMD type.
+ */
+template<class T>
+T simd_expm1(const T x);
+
+/**
+ * Vectorised \f$\log(1 + x)\f$, accurate for small @p x.
+ *
+ * @tparam T SIMD type.
+ */
+template<class T>
+T simd_log1p(const T x);
+
+/**
+ * Vectorised logarithm of the gamma function.
+ *
+ * @tparam T SIMD type.
+ *
+ * @param x Arguments. All must be positive.
+ *
+ * Arguments are shifted upward by the recurrence \f$\Gamma(x + 1) =
+ * x\Gamma(x)\f$ until the Stirling series converges, so that absolute,
+ * rather than relative, error is small near the zeros at one and two.
+ */
+template<class T>
+T simd_lgamma(const T x);
+
+/**
+ * Constants and polynomial kernels for vectorised transcendental
+ * functions.
+ *
+ * @tparam V Element type.
+ */
+template<class V>
+struct simd_kernel {
+  //
+};
+
+/**
+ * @internal
+ *
+ * Double precision kernels.
+ */
+template<>
+struct simd_kernel<double> {
+  static double log2e() {
+    return 1.4426950408889634;
+  }
+  static double ln2Hi() {
+    return 0.693359375;
+  }
+  static double ln2Lo() {
+    return -2.121944400546905827679e-4;
+  }
+  static double expLower() {
+    return -745.13321910194122;
+  }
+  static double expUpper() {
+    return 709.78271289338397;
+  }
+  static double minNormal() {
+    return 2.2250738585072014e-308;
+  }
+  static double subnormalScale() {
+    return 18014398509481984.0;
+  }
+  static double subnormalExp() {
+    return 54.0;
+  }
+  static double lgammaShift() {
+    return 10.0;
+  }
+
+  /**
+   * Exponential on \f$[-\ln(2)/2, \ln(2)/2]\f$.
+   */
+  template<class T>
+  static T exp(const T r);
+
+  /**
+   * Logarithm of \f$1 + f\f$, \f$f \in [\sqrt{1/2} - 1, \sqrt{2} - 1]\f$,
+   * without the \f$f\f$ and \f$-f^2/2\f$ terms.
+   */
+  template<class T>
+  static T log(const T f);
+
+  /**
+   * Stirling series for logarithm of gamma function, less the leading
+   * terms, as polynomial in \f$1/z^2\f$.
+   */
+  template<class T>
+  static T stirling(const T r2);
+};
+
+/**
+ * @internal
+ *
+ * Single precision kernels.
+ */
+template<>
+struct simd_kernel<float> {
+  static float log2e() {
+    return 1.44269504f;
+  }
+  static float ln2Hi() {
+    return 0.693359375f;
+  }
+  static float ln2Lo() {
+    return -2.12194440e-4f;
+  }
+  static float expLower() {
+    return -103.972077f;
+  }
+  static float expUpper() {
+    return 88.7228391f;
+  }
+  static float minNormal() {
+    return 1.17549435e-38f;
+  }
+  static float subnormalScale() {
+    return 33554432.0f;
+  }
+  static float subnormalExp() {
+    return 25.0f;
+  }
+  static float lgammaShift() {
+    return 6.0f;
+  }
+
+  template<class T>
+  static T exp(const T r);
+
+  template<class T>
+  static T log(const T f);
+
+  template<class T>
+  static T stirling(const T r2);
+};
+}
+
+template<class T>
+BI_FORCE_INLINE inline T bi::simd_constant(const typename T::value_type x) {
+  T res;
+  res = x;
+  return res;
+}
+
+template<class T>
+BI_FORCE_INLINE inline T bi::simd_ldexp(const T x, const T n) {
+  typedef typename T::value_type V;
+
+  /* split exponent in two, as the product may be subnormal, or 2^n not
+   * representable while x*2^n is */
+  const T h = simd_round(n*static_cast<V>(0.5) - static_cast<V>(0.25));
+  return x*simd_pow2(h)*simd_pow2(n - h);
+}
+
+template<class T>
+BI_FORCE_INLINE inline T bi::simd_exp(const T x) {
+  typedef typename T::value_type V;
+  typedef simd_kernel<V> K;
+
+  const T lower = simd_constant<T>(K::expLower());
+  const T upper = simd_constant<T>(K::expUpper());
+  const T inf = simd_constant<T>(std::numeric_limits<V>::infinity());
+  T y, n, r;
+
+  /* range reduction, x = n*ln(2) + r, |r| <= ln(2)/2 */
+  y = min(max(x, lower), upper);
+  n = simd_round(y*K::log2e());
+  r = y - n*K::ln2Hi() - n*K::ln2Lo();
+  y = simd_ldexp(K::exp(r), n);
+
+  /* special cases */
+  y = simd_select(x > upper, inf, y);
+  y = simd_select(x < lower, simd_constant<T>(0.0), y);
+  y = simd_select(x != x, x, y);
+
+  return y;
+}
+
+template<class T>
+BI_FORCE_INLINE inline T bi::simd_log(const T x) {
+  typedef typename T::value_type V;
+  typedef simd_kernel<V> K;
+
+  const T zero = simd_constant<T>(0.0);
+  const T one = simd_constant<T>(1.0);
+  const T inf = simd_constant<T>(std::numeric_limits<V>::infinity());
+  T y, e, f, mask;
+
+  /* bring subnormals into normal range */
+  mask = x < simd_constant<T>(K::minNormal());
+  y = simd_select(mask, x*K::subnormalScale(), x);
+
+  /* range reduction, x = (1 + f)*2^e, sqrt(1/2) <= 1 + f < sqrt(2) */
+  f = simd_frexp(y, e);
+  e = e - simd_select(mask, simd_constant<T>(K::subnormalExp()), zero);
+  mask = f < simd_constant<T>(static_cast<V>(0.70710678118654752440));
+  e = e - simd_select(mask, one, zero);
+  f = f + simd_select(mask, f, zero) - one;
+
+  y = K::log(f) + e*K::ln2Lo() - static_cast<V>(0.5)*f*f;
+  y = f + y + e*K::ln2Hi();
+
+  /* special cases */
+  y = simd_select(x == inf, x, y);
+  y = simd_select(x == zero, -inf, y);
+  y = simd_select(x < zero,
+      simd_constant<T>(std::numeric_limits<V>::quiet_NaN()), y);
+  y = simd_select(x != x, x, y);
+
+  return y;
+}
+
+template<class T>
+BI_FORCE_INLINE inline T bi::simd_expm1(const T x) {
+  typedef typename T::value_type V;
+
+  const T one = simd_constant<T>(1.0);
+  const T inf = simd_constant<T>(std::numeric_limits<V>::infinity());
+  T u, d, y;
+
+  /* Kahan's method, division by the logarithm cancels the rounding error
+   * in u */
+  u = simd_exp(x);
+  d = u - one;
+  y = d*x/simd_log(u);
+  y = simd_select(u == one, x, y);
+  y = simd_select(d == -one, -one, y);
+  y = simd_select(u == inf, u, y);
+
+  return y;
+}
+
+template<class T>
+BI_FORCE_INLINE inline T bi::simd_log1p(const T x) {
+  typedef typename T::value_type V;
+
+  const T one = simd_constant<T>(1.0);
+  const T inf = simd_constant<T>(std::numeric_limits<V>::infinity());
+  T u, d, y;
+
+  /* Kahan's method, as for expm1 */
+  u = one + x;
+  d = u - one;
+  y = simd_log(u)*(x/d);
+  y = simd_select(d == simd_constant<T>(0.0), x, y);
+  y = simd_select(x == inf, x, y);
+
+  return y;
+}
+
+template<class T>
+BI_FORCE_INLINE inline T bi::simd_lgamma(const T x) {
+  typedef typename T::value_type V;
+  typedef simd_kernel<V> K;
+
+  const T one = simd_constant<T>(1.0);
+  const T shift = simd_constant<T>(K::lgammaShift());
+  const T inf = simd_constant<T>(std::numeric_limits<V>::infinity());
+  T z = x, prod = one, mask, r, y;
+
+  /* shift up, accumulating the product of the shifts */
+  mask = z < shift;
+  while (simd_any(mask)) {
+    prod = simd_select(mask, prod*z, prod);
+    z = simd_select(mask, z + one, z);
+    mask = z < shift;
+  }
+
+  /* Stirling series */
+  r = one/z;
+  y = (z - static_cast<V>(0.5))*simd_log(z) - z
+      + static_cast<V>(0.91893853320467274178)
+      + r*K::stirling(r*r) - simd_log(prod);
+
+  /* special cases */
+  y = simd_select(x == inf, x, y);
+
+  return y;
+}
+
+template<class T>
+BI_FORCE_INLINE inline T bi::simd_kernel<double>::exp(const T r) {
+  #ifdef ENABLE_SSE_FAST_MATH
+  return simd_kernel<float>::exp(r);
+  #else
+  /* Pade approximation of Cephes */
+  const T r2 = r*r;
+  T p, q;
+
+  p = r*((1.26177193074810590878e-4*r2 + 3.02994407707441961300e-2)*r2
+      + 9.99999999999999999910e-1);
+  q = ((3.00198505138664455042e-6*r2 + 2.52448340349684104192e-3)*r2
+      + 2.27265548208155028766e-1)*r2 + 2.00000000000000000009e0;
+
+  return 1.0 + 2.0*p/(q - p);
+  #endif
+}
+
+template<class T>
+BI_FORCE_INLINE inline T bi::simd_kernel<double>::log(const T f) {
+  #ifdef ENABLE_SSE_FAST_MATH
+  return simd_kernel<float>::log(f);
+  #else
+  /* rational approximation of Cephes */
+  T p, q;
+
+  p = ((((1.01875663804580931796e-4*f + 4.97494994976747001425e-1)*f
+      + 4.70579119878881725854e0)*f + 1.44989225341610930846e1)*f
+      + 1.79368678507819816313e1)*f + 7.70838733755885391666e0;
+  q = ((((f + 1.12873587189167450590e1)*f + 4.52279145837532221105e1)*f
+      + 8.29875266912776603211e1)*f + 7.11544750618563894466e1)*f
+      + 2.31251620126765340583e1;
+
+  return f*f*f*p/q;
+  #endif
+}
+
+template<class T>
+BI_FORCE_INLINE inline T bi::simd_kernel<double>::stirling(const T r2) {
+  return (((((-691.0/360360.0)*r2 + 1.0/1188.0)*r2 - 1.0/1680.0)*r2
+      + 1.0/1260.0)*r2 - 1.0/360.0)*r2 + 1.0/12.0;
+}
+
+template<class T>
+BI_FORCE_INLINE inline T bi::simd_kernel<float>::exp(const T r) {
+  typedef typename T::value_type V;
+
+  /* polynomial of Cephes */
+  const T r2 = r*r;
+  T p;
+
+  p = ((((static_cast<V>(1.9875691500e-4)*r
+      + static_cast<V>(1.3981999507e-3))*r
+      + static_cast<V>(8.3334519073e-3))*r
+      + static_cast<V>(4.1665795894e-2))*r
+      + static_cast<V>(1.6666665459e-1))*r
+      + static_cast<V>(5.0000001201e-1);
+
+  return p*r2 + r + static_cast<V>(1.0);
+}
+
+template<class T>
+BI_FORCE_INLINE inline T bi::simd_kernel<float>::log(const T f) {
+  typedef typename T::value_type V;
+
+  /* polynomial of Cephes */
+  T p;
+
+  p = (((((((static_cast<V>(7.0376836292e-2)*f
+      - static_cast<V>(1.1514610310e-1))*f
+      + static_cast<V>(1.1676998740e-1))*f
+      - static_cast<V>(1.2420140846e-1))*f
+      + static_cast<V>(1.4249322787e-1))*f
+      - static_cast<V>(1.6668057665e-1))*f
+      + static_cast<V>(2.0000714765e-1))*f
+      - static_cast<V>(2.4999993993e-1))*f
+      + static_cast<V>(3.3333331174e-1);
+
+  return f*f*f*p;
+}
+
+template<class T>
+BI_FORCE_INLINE inline T bi::simd_kernel<float>::stirling(const T r2) {
+  typedef typename T::value_type V;
+
+  return (static_cast<V>(1.0/1260.0)*r2 - static_cast<V>(1.0/360.0))*r2
+      + static_cast<V>(1.0/12.0);
+}
+
+#endif
@@ -51,12 +51,12 @@ public:
   /**
    * Auxiliary log-weights vector.
    */
-  typename State<B,L>::vector_reference_type logAuxWeights();
+  typename State<B,L>::weight_vector_reference_type logAuxWeights();
 
   /**
    * Auxiliary log-weights vector.
    */
-  const typename State<B,L>::vector_reference_type logAuxWeights() const;
+  const typename State<B,L>::weight_vector_reference_type logAuxWeights() const;
 
   /**
    * @copydoc BootstrapPFState::trim()
@@ -78,7 +78,7 @@ private:
   /**
    * Proposal log-weights.
    */
-  typename State<B,L>::vector_type qlws;
+  typename State<B,L>::weight_vector_type qlws;
 
   /**
    * Serialize.
@@ -98,6 +98,14 @@ private:
   BOOST_SERIALIZATION_SPLIT_MEMBER()
   friend class boost::serialization::access;
 };
+
+/**
+ * @internal
+ */
+template<class B, Location L>
+struct resampler_can_sort<AuxiliaryPFState<B,L> > {
+  static const bool value = true;
+};
 }
 
 template<class B, bi::Location L>
@@ -134,12 +142,12 @@ void bi::AuxiliaryPFState<B,L>::swap(AuxiliaryPFState<B,L>& o) {
 }
 
 template<class B, bi::Location L>
-typename bi::State<B,L>::vector_reference_type bi::AuxiliaryPFState<B,L>::logAuxWeights() {
+typename bi::State<B,L>::weight_vector_reference_type bi::AuxiliaryPFState<B,L>::logAuxWeights() {
   return subrange(qlws, this->p, this->P);
 }
 
 template<class B, bi::Location L>
-const typename bi::State<B,L>::vector_reference_type bi::AuxiliaryPFState<B,L>::logAuxWeights() const {
+const typename bi::State<B,L>::weight_vector_reference_type bi::AuxiliaryPFState<B,L>::logAuxWeights() const {
   return subrange(qlws, this->p, this->P);
 }
 
@@ -9,6 +9,7 @@
 #define BI_STATE_BOOTSTRAPPFSTATE_HPP
 
 #include "FilterState.hpp"
+#include "../traits/resampler_traits.hpp"
 
 namespace bi {
 /**
@@ -51,12 +52,12 @@ public:
   /**
    * Log-weights vector.
    */
-  typename State<B,L>::vector_reference_type logWeights();
+  typename State<B,L>::weight_vector_reference_type logWeights();
 
   /**
    * Log-weights vector.
    */
-  const typename State<B,L>::vector_reference_type logWeights() const;
+  const typename State<B,L>::weight_vector_reference_type logWeights() const;
 
   /**
    * Ancestors vector.
@@ -98,7 +99,7 @@ private:
   /**
    * Log-weights.
    */
-  typename State<B,L>::vector_type lws;
+  typename State<B,L>::weight_vector_type lws;
 
   /**
    * Ancestors.
@@ -123,6 +124,14 @@ private:
   BOOST_SERIALIZATION_SPLIT_MEMBER()
   friend class boost::serialization::access;
 };
+
+/**
+ * @internal
+ */
+template<class B, Location L>
+struct resampler_can_sort<BootstrapPFState<B,L> > {
+  static const bool value = true;
+};
 }
 
 template<class B, bi::Location L>
@@ -166,12 +175,12 @@ void bi::BootstrapPFState<B,L>::swap(BootstrapPFState<B,L>& o) {
 }
 
 template<class B, bi::Location L>
-typename bi::State<B,L>::vector_reference_type bi::BootstrapPFState<B,L>::logWeights() {
+typename bi::State<B,L>::weight_vector_reference_type bi::BootstrapPFState<B,L>::logWeights() {
   return subrange(lws, this->p, this->P);
 }
 
 template<class B, bi::Location L>
-const typename bi::State<B,L>::vector_reference_type bi::BootstrapPFState<B,L>::logWeights() const {
+const typename bi::State<B,L>::weight_vector_reference_type bi::BootstrapPFState<B,L>::logWeights() const {
   return subrange(lws, this->p, this->P);
 }
 
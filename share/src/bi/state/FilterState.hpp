@@ -9,6 +9,7 @@
 #define BI_STATE_FILTERSTATE_HPP
 
 #include "State.hpp"
+#include "../random/RandomTape.hpp"
 
 namespace bi {
 /**
@@ -68,6 +69,13 @@ public:
    */
   double logLikelihood;
 
+  /**
+   * Auxiliary variables from which the marginal log-likelihood was
+   * computed, when replayed for correlated pseudo-marginal methods. Not
+   * serialized, as the tapes are specific to the number of threads.
+   */
+  RandomTape aux;
+
 private:
   /**
    * Serialize.
@@ -99,7 +107,7 @@ bi::FilterState<B,L>::FilterState(const int P, const int Y, const int T) :
 template<class B, bi::Location L>
 bi::FilterState<B,L>::FilterState(const FilterState<B,L>& o) :
     State<B,L>(o), path(o.path), times(o.times), logIncrements(
-        o.logIncrements), logLikelihood(o.logLikelihood) {
+        o.logIncrements), logLikelihood(o.logLikelihood), aux(o.aux) {
   //
 }
 
@@ -111,6 +119,7 @@ bi::FilterState<B,L>& bi::FilterState<B,L>::operator=(
   times = o.times;
   logIncrements = o.logIncrements;
   logLikelihood = o.logLikelihood;
+  aux = o.aux;
 
   return *this;
 }
@@ -122,6 +131,7 @@ void bi::FilterState<B,L>::clear() {
   times.clear();
   logIncrements.clear();
   logLikelihood = 0.0;
+  aux.clear();
 }
 
 template<class B, bi::Location L>
@@ -131,6 +141,7 @@ void bi::FilterState<B,L>::swap(FilterState<B,L>& o) {
   times.swap(o.times);
   logIncrements.swap(o.logIncrements);
   std::swap(logLikelihood, o.logLikelihood);
+  aux.swap(o.aux);
 }
 
 template<class B, bi::Location L>
@@ -0,0 +1,204 @@
+/**
+ * @file
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ */
+#ifndef BI_STATE_MARGINALPTSTATE_HPP
+#define BI_STATE_MARGINALPTSTATE_HPP
+
+#include "MarginalMHState.hpp"
+
+#include "boost/shared_ptr.hpp"
+
+#include <vector>
+
+namespace bi {
+/**
+ * State for MarginalPT.
+ *
+ * @ingroup state
+ *
+ * @tparam B Model type.
+ * @tparam L Location.
+ * @tparam S1 Filter state type.
+ * @tparam IO1 Filter cache type.
+ *
+ * Holds the chains of this process, each with its own filter state and
+ * cache, so that allocations are reused from one step to the next.
+ */
+template<class B, Location L, class S1, class IO1>
+class MarginalPTState {
+public:
+  typedef MarginalMHState<B,L,S1,IO1> chain_type;
+
+  /**
+   * Constructor.
+   *
+   * @param m Model.
+   * @param K Number of chains.
+   * @param P Number of \f$x\f$-particles.
+   * @param Y Number of observation times.
+   * @param T Number of output times.
+   */
+  MarginalPTState(B& m, const int K = 1, const int P = 0, const int Y = 0,
+      const int T = 0);
+
+  /**
+   * Shallow copy constructor.
+   */
+  MarginalPTState(const MarginalPTState<B,L,S1,IO1>& o);
+
+  /**
+   * Assignment operator.
+   */
+  MarginalPTState& operator=(const MarginalPTState<B,L,S1,IO1>& o);
+
+  /**
+   * Number of chains.
+   */
+  int size() const;
+
+  /**
+   * Chain.
+   *
+   * @param k Index of chain.
+   */
+  chain_type& chain(const int k);
+
+  /**
+   * Chain.
+   *
+   * @param k Index of chain.
+   */
+  const chain_type& chain(const int k) const;
+
+  /**
+   * Clear.
+   */
+  void clear();
+
+  /**
+   * Swap.
+   */
+  void swap(MarginalPTState<B,L,S1,IO1>& o);
+
+  /**
+   * Execution time.
+   */
+  long clock;
+
+private:
+  /**
+   * Chains.
+   */
+  std::vector<boost::shared_ptr<chain_type> > chains;
+
+  /**
+   * Serialize.
+   */
+  template<class Archive>
+  void save(Archive& ar, const unsigned version) const;
+
+  /**
+   * Restore from serialization.
+   */
+  template<class Archive>
+  void load(Archive& ar, const unsigned version);
+
+  /*
+   * Boost.Serialization requirements.
+   */
+  BOOST_SERIALIZATION_SPLIT_MEMBER()
+  friend class boost::serialization::access;
+};
+}
+
+template<class B, bi::Location L, class S1, class IO1>
+bi::MarginalPTState<B,L,S1,IO1>::MarginalPTState(B& m, const int K,
+    const int P, const int Y, const int T) :
+    clock(0), chains(K) {
+  for (int k = 0; k < K; ++k) {
+    chains[k] = boost::shared_ptr<chain_type>(new chain_type(m, P, Y, T));
+  }
+}
+
+template<class B, bi::Location L, class S1, class IO1>
+bi::MarginalPTState<B,L,S1,IO1>::MarginalPTState(
+    const MarginalPTState<B,L,S1,IO1>& o) :
+    clock(o.clock), chains(o.chains.size()) {
+  for (int k = 0; k < size(); ++k) {
+    chains[k] = boost::shared_ptr<chain_type>(new chain_type(o.chain(k)));
+  }
+}
+
+template<class B, bi::Location L, class S1, class IO1>
+bi::MarginalPTState<B,L,S1,IO1>& bi::MarginalPTState<B,L,S1,IO1>::operator=(
+    const MarginalPTState<B,L,S1,IO1>& o) {
+  /* pre-condition */
+  BI_ASSERT(size() == o.size());
+
+  for (int k = 0; k < size(); ++k) {
+    chain(k) = o.chain(k);
+  }
+  clock = o.clock;
+
+  return *this;
+}
+
+template<class B, bi::Location L, class S1, class IO1>
+inline int bi::MarginalPTState<B,L,S1,IO1>::size() const {
+  return chains.size();
+}
+
+template<class B, bi::Location L, class S1, class IO1>
+inline typename bi::MarginalPTState<B,L,S1,IO1>::chain_type& bi::MarginalPTState<
+    B,L,S1,IO1>::chain(const int k) {
+  /* pre-condition */
+  BI_ASSERT(k >= 0 && k < size());
+
+  return *chains[k];
+}
+
+template<class B, bi::Location L, class S1, class IO1>
+inline const typename bi::MarginalPTState<B,L,S1,IO1>::chain_type& bi::MarginalPTState<
+    B,L,S1,IO1>::chain(const int k) const {
+  /* pre-condition */
+  BI_ASSERT(k >= 0 && k < size());
+
+  return *chains[k];
+}
+
+template<class B, bi::Location L, class S1, class IO1>
+void bi::MarginalPTState<B,L,S1,IO1>::clear() {
+  for (int k = 0; k < size(); ++k) {
+    chain(k).clear();
+  }
+}
+
+template<class B, bi::Location L, class S1, class IO1>
+void bi::MarginalPTState<B,L,S1,IO1>::swap(MarginalPTState<B,L,S1,IO1>& o) {
+  chains.swap(o.chains);
+  std::swap(clock, o.clock);
+}
+
+template<class B, bi::Location L, class S1, class IO1>
+template<class Archive>
+void bi::MarginalPTState<B,L,S1,IO1>::save(Archive& ar,
+    const unsigned version) const {
+  for (int k = 0; k < size(); ++k) {
+    ar & chain(k);
+  }
+}
+
+template<class B, bi::Location L, class S1, class IO1>
+template<class Archive>
+void bi::MarginalPTState<B,L,S1,IO1>::load(Archive& ar,
+    const unsigned version) {
+  for (int k = 0; k < size(); ++k) {
+    ar & chain(k);
+  }
+}
+
+#endif
@@ -0,0 +1,230 @@
+/**
+ * @file
+ *
+ * @author Lawrence Murray <lawrence.murray@csiro.au>
+ * $Rev$
+ * $Date$
+ */
+#ifndef BI_STATE_RAOBLACKWELLPFSTATE_HPP
+#define BI_STATE_RAOBLACKWELLPFSTATE_HPP
+
+#include "BootstrapPFState.hpp"
+
+namespace bi {
+/**
+ * State for RaoBlackwellPF.
+ *
+ * @ingroup state
+ *
+ * Besides the particles, holds for each the upper-triangular Cholesky
+ * factor of the covariance of the marginalised variables, one factor per
+ * row, each in column-major order over all dynamic variables. Rows and
+ * columns of sampled variables are zero.
+ */
+template<class B, Location L>
+class RaoBlackwellPFState: public BootstrapPFState<B,L> {
+public:
+  /**
+   * Constructor.
+   *
+   * @param P Number of \f$x\f$-particles.
+   * @param Y Number of observation times.
+   * @param T Number of output times.
+   */
+  RaoBlackwellPFState(const int P = 0, const int Y = 0, const int T = 0);
+
+  /**
+   * Shallow copy constructor.
+   */
+  RaoBlackwellPFState(const RaoBlackwellPFState<B,L>& o);
+
+  /**
+   * Assignment operator.
+   */
+  RaoBlackwellPFState& operator=(const RaoBlackwellPFState<B,L>& o);
+
+  /**
+   * Clear.
+   */
+  void clear();
+
+  /**
+   * Swap.
+   */
+  void swap(RaoBlackwellPFState<B,L>& o);
+
+  /**
+   * Cholesky factors of covariance matrices, one row per particle.
+   */
+  typename State<B,L>::matrix_reference_type factors();
+
+  /**
+   * Cholesky factors of covariance matrices, one row per particle.
+   */
+  const typename State<B,L>::matrix_reference_type factors() const;
+
+  /*
+   * Views of Jacobian matrices etc., one row per particle.
+   */
+  typename State<B,L>::matrix_reference_type F();
+  typename State<B,L>::matrix_reference_type Q();
+  typename State<B,L>::matrix_reference_type G();
+  typename State<B,L>::matrix_reference_type R();
+
+  /**
+   * @copydoc BootstrapPFState::trim()
+   */
+  void trim();
+
+  /**
+   * @copydoc BootstrapPFState::resizeMax()
+   */
+  void resizeMax(const int maxP, const bool preserve = true);
+
+  /**
+   * @copydoc BootstrapPFState::gather()
+   */
+  template<class V1>
+  void gather(const ScheduleElement now, const V1 as);
+
+private:
+  /**
+   * Number of dynamic variables.
+   */
+  static const int M = B::NR + B::ND;
+
+  /**
+   * Cholesky factors.
+   */
+  typename State<B,L>::matrix_type Us;
+
+  /**
+   * Serialize.
+   */
+  template<class Archive>
+  void save(Archive& ar, const unsigned version) const;
+
+  /**
+   * Restore from serialization.
+   */
+  template<class Archive>
+  void load(Archive& ar, const unsigned version);
+
+  /*
+   * Boost.Serialization requirements.
+   */
+  BOOST_SERIALIZATION_SPLIT_MEMBER()
+  friend class boost::serialization::access;
+};
+}
+
+template<class B, bi::Location L>
+bi::RaoBlackwellPFState<B,L>::RaoBlackwellPFState(const int P, const int Y,
+    const int T) :
+    BootstrapPFState<B,L>(P, Y, T), Us(P, M*M) {
+  //
+}
+
+template<class B, bi::Location L>
+bi::RaoBlackwellPFState<B,L>::RaoBlackwellPFState(
+    const RaoBlackwellPFState<B,L>& o) :
+    BootstrapPFState<B,L>(o), Us(o.Us) {
+  //
+}
+
+template<class B, bi::Location L>
+bi::RaoBlackwellPFState<B,L>& bi::RaoBlackwellPFState<B,L>::operator=(
+    const RaoBlackwellPFState<B,L>& o) {
+  BootstrapPFState<B,L>::operator=(o);
+  factors() = o.factors();
+
+  return *this;
+}
+
+template<class B, bi::Location L>
+void bi::RaoBlackwellPFState<B,L>::clear() {
+  BootstrapPFState<B,L>::clear();
+  factors().clear();
+
+  /* reset Jacobian, so that the initial value block multiplies into it */
+  F().clear();
+  for (int i = 0; i < M; ++i) {
+    set_elements(column(F(), i*M + i), 1.0);
+  }
+  Q().clear();
+}
+
+template<class B, bi::Location L>
+void bi::RaoBlackwellPFState<B,L>::swap(RaoBlackwellPFState<B,L>& o) {
+  BootstrapPFState<B,L>::swap(o);
+  Us.swap(o.Us);
+}
+
+template<class B, bi::Location L>
+typename bi::State<B,L>::matrix_reference_type bi::RaoBlackwellPFState<B,L>::factors() {
+  return rows(Us, this->p, this->P);
+}
+
+template<class B, bi::Location L>
+const typename bi::State<B,L>::matrix_reference_type bi::RaoBlackwellPFState<
+    B,L>::factors() const {
+  return rows(Us, this->p, this->P);
+}
+
+template<class B, bi::Location L>
+typename bi::State<B,L>::matrix_reference_type bi::RaoBlackwellPFState<B,L>::F() {
+  return this->template getVar<VarGroupF>();
+}
+
+template<class B, bi::Location L>
+typename bi::State<B,L>::matrix_reference_type bi::RaoBlackwellPFState<B,L>::Q() {
+  return this->template getVar<VarGroupQ>();
+}
+
+template<class B, bi::Location L>
+typename bi::State<B,L>::matrix_reference_type bi::RaoBlackwellPFState<B,L>::G() {
+  return this->template getVar<VarGroupG>();
+}
+
+template<class B, bi::Location L>
+typename bi::State<B,L>::matrix_reference_type bi::RaoBlackwellPFState<B,L>::R() {
+  return this->template getVar<VarGroupR>();
+}
+
+template<class B, bi::Location L>
+inline void bi::RaoBlackwellPFState<B,L>::trim() {
+  Us.trim(this->p, this->P, 0, Us.size2());
+  BootstrapPFState<B,L>::trim();
+}
+
+template<class B, bi::Location L>
+inline void bi::RaoBlackwellPFState<B,L>::resizeMax(const int maxP,
+    const bool preserve) {
+  Us.resize(maxP, Us.size2(), preserve);
+  BootstrapPFState<B,L>::resizeMax(maxP, preserve);
+}
+
+template<class B, bi::Location L>
+template<class V1>
+void bi::RaoBlackwellPFState<B,L>::gather(const ScheduleElement now,
+    const V1 as) {
+  BootstrapPFState<B,L>::gather(now, as);
+  bi::gather_rows(as, factors(), factors());
+}
+
+template<class B, bi::Location L>
+template<class Archive>
+void bi::RaoBlackwellPFState<B,L>::save(Archive& ar,
+    const unsigned version) const {
+  ar & boost::serialization::base_object < BootstrapPFState<B,L> > (*this);
+  save_resizable_matrix(ar, version, Us);
+}
+
+template<class B, bi::Location L>
+template<class Archive>
+void bi::RaoBlackwellPFState<B,L>::load(Archive& ar, const unsigned version) {
+  ar & boost::serialization::base_object < BootstrapPFState<B,L> > (*this);
+  load_resizable_matrix(ar, version, Us);
+}
+
+#endif
@@ -96,6 +96,12 @@ public:
   typedef typename loc_temp_vector<L,int_value_type>::type temp_int_vector_type;
   typedef typename loc_temp_matrix<L,int_value_type>::type temp_int_matrix_type;
 
+  typedef wreal weight_value_type;
+  typedef typename loc_vector<L,weight_value_type>::type weight_vector_type;
+  typedef typename weight_vector_type::vector_reference_type weight_vector_reference_type;
+
+  typedef typename loc_temp_vector<L,weight_value_type>::type temp_weight_vector_type;
+
   /**
    * Constructor.
    *
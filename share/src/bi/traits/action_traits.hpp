@@ -21,6 +21,30 @@ struct action_size {
   static const int value = A::SIZE;
 };
 
+/**
+ * Number of standard Gaussian variates drawn when sampling action.
+ *
+ * @ingroup model_low
+ *
+ * @tparam A Action type.
+ */
+template<class A>
+struct action_num_gaussians {
+  static const int value = A::NUM_GAUSSIANS;
+};
+
+/**
+ * Number of standard uniform variates drawn when sampling action.
+ *
+ * @ingroup model_low
+ *
+ * @tparam A Action type.
+ */
+template<class A>
+struct action_num_uniforms {
+  static const int value = A::NUM_UNIFORMS;
+};
+
 /**
  * Is action a matrix action?
  *
@@ -58,6 +58,64 @@ struct block_size<empty_typelist> {
   static const int value = 0;
 };
 
+/**
+ * Number of standard Gaussian variates drawn when sampling block, excluding
+ * those drawn by rejection.
+ *
+ * @ingroup model_low
+ *
+ * @tparam S Action type list.
+ */
+template<class S>
+struct block_num_gaussians {
+  typedef typename front<S>::type front;
+  typedef typename pop_front<S>::type pop_front;
+
+  static const int value = action_num_gaussians<front>::value +
+      block_num_gaussians<pop_front>::value;
+};
+
+/**
+ * @internal
+ *
+ * Base case of block_num_gaussians.
+ *
+ * @ingroup model_low
+ */
+template<>
+struct block_num_gaussians<empty_typelist> {
+  static const int value = 0;
+};
+
+/**
+ * Number of standard uniform variates drawn when sampling block, excluding
+ * those drawn by rejection.
+ *
+ * @ingroup model_low
+ *
+ * @tparam S Action type list.
+ */
+template<class S>
+struct block_num_uniforms {
+  typedef typename front<S>::type front;
+  typedef typename pop_front<S>::type pop_front;
+
+  static const int value = action_num_uniforms<front>::value +
+      block_num_uniforms<pop_front>::value;
+};
+
+/**
+ * @internal
+ *
+ * Base case of block_num_uniforms.
+ *
+ * @ingroup model_low
+ */
+template<>
+struct block_num_uniforms<empty_typelist> {
+  static const int value = 0;
+};
+
 /**
  * Does block contain a particular action?
  *
@@ -31,6 +31,18 @@ template<class R>
 struct resampler_needs_max {
   static const bool value = false;
 };
+
+/**
+ * Can particles of the state be sorted before resampling?
+ *
+ * @ingroup method_resampler
+ *
+ * @tparam S1 State type.
+ */
+template<class S1>
+struct resampler_can_sort {
+  static const bool value = false;
+};
 }
 
 #endif